@@ -0,0 +1,804 @@
+/**
+ * @file bench_kernels.c
+ * @brief Microbenchmarks for the DSP and publishing kernels of the core.
+ *
+ * Each kernel runs over a range of input sizes. A case is calibrated until
+ * one batch lasts at least --min-time / BENCH_REPETITIONS, then timed over
+ * BENCH_REPETITIONS batches; the median batch is reported as:
+ *
+ * - ns per call and ns per sample (element) of input
+ * - GB/s over the bytes the kernel reads and writes
+ * - heap allocations and bytes allocated per call (malloc interposition,
+ *   glibc only; -1 elsewhere)
+ *
+ * Usage:
+ *   bench_kernels [--format table|csv|json] [--filter substring] [--min-time s] [--verbose]
+ *
+ * CSV and JSON carry the build (precision, conversion ISA, build type) on every
+ * record so runs of different builds can be concatenated and compared.
+ * Kernel logging on stdout is discarded unless --verbose is given.
+ *
+ * The run also checks the PSD of the build's precision against the double
+ * reference (welch_precision) and exits with failure when a bin deviates by
+ * more than DSP_SINGLE_TOLERANCE_DB, so a single-precision build can be
+ * validated with `bench_kernels --filter welch_precision`.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <complex.h>
+#include <math.h>
+
+#include "Modules/dsp_precision.h"
+#include "Modules/CS8toIQ.h"
+#include "Modules/welch.h"
+#include "Modules/parameter.h"
+#include "Modules/parameter_internal.h"
+#include "Modules/find_closest_index.h"
+#include "Modules/band_plan.h"
+#include "Modules/spectrum_frame.h"
+#include "Modules/spectrum_ring.h"
+#include "Modules/spectrum_json.h"
+#include "Drivers/bacn_RF.h"
+
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE "unknown"
+#endif
+
+/** @brief Timed batches per case; the median is reported */
+#define BENCH_REPETITIONS 7
+
+/** @brief Upper bound on result rows */
+#define BENCH_MAX_RESULTS 128
+
+/* ---------------------------------------------------------------------------
+ * Allocation counting
+ * ------------------------------------------------------------------------- */
+
+static atomic_ulong alloc_calls;
+static atomic_ulong alloc_bytes;
+
+#if defined(__GLIBC__)
+#define BENCH_COUNTS_ALLOCATIONS 1
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+static inline void count_allocation(size_t size) {
+    atomic_fetch_add_explicit(&alloc_calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&alloc_bytes, size, memory_order_relaxed);
+}
+
+void* malloc(size_t size) {
+    count_allocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    count_allocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    count_allocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    count_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    count_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    count_allocation(size);
+    void* p = __libc_memalign(alignment, size);
+    if (p == NULL) {
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+#else
+#define BENCH_COUNTS_ALLOCATIONS 0
+#endif
+
+/* ---------------------------------------------------------------------------
+ * Measurement
+ * ------------------------------------------------------------------------- */
+
+typedef void (*BenchFn)(void* ctx);
+
+typedef struct {
+    const char* kernel;
+    char        params[48];
+    size_t      samples;            /**< Elements processed per call */
+    double      bytes;              /**< Bytes read + written per call */
+    double      ns_per_call;        /**< Median batch */
+    double      ns_per_call_min;    /**< Fastest batch */
+    double      allocs_per_call;
+    double      alloc_bytes_per_call;
+    long        iterations;         /**< Calls per batch */
+} BenchResult;
+
+static BenchResult results[BENCH_MAX_RESULTS];
+static int result_count = 0;
+static double min_time = 0.5;
+static const char* filter = NULL;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double run_batch(BenchFn fn, void* ctx, long iterations) {
+    double start = now_ns();
+    for (long i = 0; i < iterations; i++) {
+        fn(ctx);
+    }
+    return now_ns() - start;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static bool bench_selected(const char* kernel) {
+    return filter == NULL || strstr(kernel, filter) != NULL;
+}
+
+static void bench_case(const char* kernel, const char* params, size_t samples, double bytes,
+                       BenchFn fn, void* ctx) {
+    if (result_count == BENCH_MAX_RESULTS) {
+        return;
+    }
+
+    /* Warm caches, plans and lazily allocated state first */
+    fn(ctx);
+
+    long iterations = 1;
+    double batch_target = min_time * 1e9 / BENCH_REPETITIONS;
+    while (run_batch(fn, ctx, iterations) < batch_target && iterations < (1L << 30)) {
+        iterations *= 2;
+    }
+
+    double times[BENCH_REPETITIONS];
+    atomic_store(&alloc_calls, 0);
+    atomic_store(&alloc_bytes, 0);
+    for (int r = 0; r < BENCH_REPETITIONS; r++) {
+        times[r] = run_batch(fn, ctx, iterations) / iterations;
+    }
+    double calls = (double)iterations * BENCH_REPETITIONS;
+    qsort(times, BENCH_REPETITIONS, sizeof(double), compare_doubles);
+
+    BenchResult* r = &results[result_count++];
+    r->kernel = kernel;
+    snprintf(r->params, sizeof(r->params), "%s", params);
+    r->samples = samples;
+    r->bytes = bytes;
+    r->ns_per_call = times[BENCH_REPETITIONS / 2];
+    r->ns_per_call_min = times[0];
+    r->allocs_per_call = BENCH_COUNTS_ALLOCATIONS ? atomic_load(&alloc_calls) / calls : -1.0;
+    r->alloc_bytes_per_call = BENCH_COUNTS_ALLOCATIONS ? atomic_load(&alloc_bytes) / calls : -1.0;
+    r->iterations = iterations;
+
+    fprintf(stderr, "[bench] %-26s n=%-9zu %-16s %12.1f ns/call\n", kernel, samples, params, r->ns_per_call);
+}
+
+/* ---------------------------------------------------------------------------
+ * Inputs
+ * ------------------------------------------------------------------------- */
+
+static uint32_t bench_rng = 0x9e3779b9u;
+
+static uint32_t bench_rand(void) {
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 17;
+    bench_rng ^= bench_rng << 5;
+    return bench_rng;
+}
+
+static int8_t* random_cs8(size_t samples) {
+    int8_t* data = (int8_t*)malloc(2 * samples);
+    for (size_t i = 0; i < 2 * samples; i++) {
+        data[i] = (int8_t)(bench_rand() & 0xff);
+    }
+    return data;
+}
+
+/* Noise-like positive PSD, as welch_engine produces */
+static dsp_real_t* random_psd(size_t length) {
+    dsp_real_t* psd = (dsp_real_t*)malloc(length * sizeof(dsp_real_t));
+    for (size_t i = 0; i < length; i++) {
+        psd[i] = (dsp_real_t)(1e-9 * (1.0 + (bench_rand() & 0xffff) / 4096.0));
+    }
+    return psd;
+}
+
+/* Ascending absolute frequencies in MHz over 88-108 */
+static double* linear_freqs(size_t length) {
+    double* f = (double*)malloc(length * sizeof(double));
+    for (size_t i = 0; i < length; i++) {
+        f[i] = 88.0 + 20.0 * i / length;
+    }
+    return f;
+}
+
+/* ---------------------------------------------------------------------------
+ * Kernels
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    int8_t* raw;
+    complex double* out;
+    size_t samples;
+} ConvertCtx;
+
+static void run_convert(void* p) {
+    ConvertCtx* c = (ConvertCtx*)p;
+    cs8_to_iq_convert(c->raw, 2 * c->samples, c->out, c->samples);
+}
+
+static void bench_convert(void) {
+    static const size_t sizes[] = { 1 << 12, 1 << 16, 1 << 20, 1 << 22 };
+    if (!bench_selected("cs8_to_iq_convert")) return;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        ConvertCtx c = { random_cs8(sizes[s]), malloc(sizes[s] * sizeof(complex double)), sizes[s] };
+        char params[48];
+        snprintf(params, sizeof(params), "isa=%s", cs8_iq_kernel_name());
+        bench_case("cs8_to_iq_convert", params, c.samples,
+                   c.samples * (2.0 + sizeof(complex double)), run_convert, &c);
+        free(c.raw);
+        free(c.out);
+    }
+}
+
+typedef struct {
+    complex double* signal;
+    size_t samples;
+    int nperseg;
+    double* f;
+    double* psd;
+} WelchCtx;
+
+static void run_welch(void* p) {
+    WelchCtx* c = (WelchCtx*)p;
+    welch_psd_complex(c->signal, c->samples, 20e6, c->nperseg, 0.0, c->f, c->psd);
+}
+
+static void bench_welch(void) {
+    static const size_t sizes[] = { 1 << 18, 1 << 20, 1 << 22 };
+    static const int npersegs[] = { 4096, 32768 };
+    if (!bench_selected("welch_psd_complex")) return;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int8_t* raw = random_cs8(sizes[s]);
+        complex double* signal = (complex double*)malloc(sizes[s] * sizeof(complex double));
+        cs8_to_iq_convert(raw, 2 * sizes[s], signal, sizes[s]);
+        free(raw);
+
+        for (size_t k = 0; k < sizeof(npersegs) / sizeof(npersegs[0]); k++) {
+            WelchCtx c = { signal, sizes[s], npersegs[k],
+                           malloc(npersegs[k] * sizeof(double)), malloc(npersegs[k] * sizeof(double)) };
+            char params[48];
+            snprintf(params, sizeof(params), "nperseg=%d", c.nperseg);
+            bench_case("welch_psd_complex", params, c.samples,
+                       c.samples * (double)sizeof(complex double) + 2.0 * c.nperseg * sizeof(double),
+                       run_welch, &c);
+            free(c.f);
+            free(c.psd);
+        }
+        free(signal);
+    }
+}
+
+typedef struct {
+    dsp_real_t* psd;
+    int length;
+} PsdCtx;
+
+static void run_rearrange(void* p) {
+    PsdCtx* c = (PsdCtx*)p;
+    rearrange_welch_psd(c->psd, c->length);
+}
+
+static void run_correction(void* p) {
+    PsdCtx* c = (PsdCtx*)p;
+    apply_spectral_correction(c->psd, c->length, c->length / 2, (int)(c->length * 0.002));
+}
+
+static const int psd_sizes[] = { 4096, 32768, 262144 };
+
+static void bench_rearrange(void) {
+    if (!bench_selected("rearrange_welch_psd")) return;
+
+    for (size_t s = 0; s < sizeof(psd_sizes) / sizeof(psd_sizes[0]); s++) {
+        PsdCtx c = { random_psd(psd_sizes[s]), psd_sizes[s] };
+        /* In-place swap: every bin read and written once */
+        bench_case("rearrange_welch_psd", "-", c.length, 2.0 * c.length * sizeof(dsp_real_t),
+                   run_rearrange, &c);
+        free(c.psd);
+    }
+}
+
+static void bench_correction(void) {
+    if (!bench_selected("apply_spectral_correction")) return;
+
+    for (size_t s = 0; s < sizeof(psd_sizes) / sizeof(psd_sizes[0]); s++) {
+        PsdCtx c = { random_psd(psd_sizes[s]), psd_sizes[s] };
+        int width = (int)(c.length * 0.002);
+        char params[48];
+        snprintf(params, sizeof(params), "width=%d", width);
+        /* Only the bins around DC are touched; n is the PSD length */
+        bench_case("apply_spectral_correction", params, c.length, 4.0 * width * sizeof(dsp_real_t),
+                   run_correction, &c);
+        free(c.psd);
+    }
+}
+
+typedef struct {
+    dsp_real_t* psd;
+    dsp_real_t* scratch;
+    int length;
+    volatile double sink;
+} MedianCtx;
+
+static void run_median(void* p) {
+    MedianCtx* c = (MedianCtx*)p;
+    c->sink = calculate_median(c->psd, 0, c->length, c->scratch);
+}
+
+static void bench_median(void) {
+    /* Channel widths in bins: 250 kHz at 32768 over 20 MHz is ~410 */
+    static const int sizes[] = { 16, 410, 4096, 65536 };
+    if (!bench_selected("calculate_median")) return;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        MedianCtx c = { random_psd(sizes[s]), random_psd(sizes[s]), sizes[s], 0.0 };
+        bench_case("calculate_median", "-", c.length, 2.0 * c.length * sizeof(dsp_real_t),
+                   run_median, &c);
+        free(c.psd);
+        free(c.scratch);
+    }
+}
+
+typedef struct {
+    dsp_real_t* psd;
+    dsp_real_t* scratch;
+    BandPlan plan;
+    ChannelStats stats[199];
+} StatsCtx;
+
+static void run_channel_stats(void* p) {
+    StatsCtx* c = (StatsCtx*)p;
+    calculate_channel_stats(c->psd, &c->plan, c->scratch, c->stats);
+}
+
+static void bench_channel_stats(void) {
+    static double centers[199];
+    static double widths[199];
+    if (!bench_selected("calculate_channel_stats")) return;
+
+    /* The VHF1.csv plan on the 32768-bin detection spectrum */
+    for (int i = 0; i < 199; i++) {
+        centers[i] = 88.1 + 0.1 * i;
+        widths[i] = 0.25;
+    }
+    StatsCtx c = { .psd = random_psd(32768), .scratch = random_psd(32768) };
+    if (band_plan_init(&c.plan, centers, widths, 199) == BAND_PLAN_SUCCESS &&
+        band_plan_compile_uniform(&c.plan, 98000000, 20e6, 32768) == BAND_PLAN_SUCCESS) {
+        size_t bins = 0;
+        for (int i = 0; i < 199; i++) {
+            bins += c.plan.ranges[i].upper_index - c.plan.ranges[i].lower_index + 1;
+        }
+        /* n is the number of channel bins read; each is copied once for the selection */
+        bench_case("calculate_channel_stats", "channels=199", bins, 2.0 * bins * sizeof(dsp_real_t),
+                   run_channel_stats, &c);
+    }
+    band_plan_free(&c.plan);
+    free(c.psd);
+    free(c.scratch);
+}
+
+typedef struct {
+    double* f;
+    int length;
+    unsigned lookup;
+    volatile int sink;
+} ClosestCtx;
+
+static void run_closest(void* p) {
+    ClosestCtx* c = (ClosestCtx*)p;
+    /* Walk the channel plan so branch history does not settle on one target */
+    double value = 88.1 + 0.1 * (c->lookup++ % 199);
+    c->sink = find_closest_index(c->f, c->length, value);
+}
+
+static void run_closest_sorted(void* p) {
+    ClosestCtx* c = (ClosestCtx*)p;
+    double value = 88.1 + 0.1 * (c->lookup++ % 199);
+    c->sink = find_closest_index_sorted(c->f, c->length, value);
+}
+
+static void bench_closest(void) {
+    for (size_t s = 0; s < sizeof(psd_sizes) / sizeof(psd_sizes[0]); s++) {
+        ClosestCtx c = { linear_freqs(psd_sizes[s]), psd_sizes[s], 0, 0 };
+        if (bench_selected("find_closest_index")) {
+            bench_case("find_closest_index", "-", c.length, (double)c.length * sizeof(double),
+                       run_closest, &c);
+        }
+        if (bench_selected("find_closest_index_sorted")) {
+            /* About log2(n) bins touched */
+            bench_case("find_closest_index_sorted", "-", c.length, 0.0, run_closest_sorted, &c);
+        }
+        free(c.f);
+    }
+}
+
+typedef struct {
+    BandPlan plan;
+    int length;
+    unsigned retunes;
+} BandPlanCtx;
+
+static void run_band_plan(void* p) {
+    BandPlanCtx* c = (BandPlanCtx*)p;
+    /* A new center every call, so every call compiles */
+    band_plan_compile_uniform(&c->plan, 98000000 + (c->retunes++ & 1), 20e6, c->length);
+}
+
+static void bench_band_plan(void) {
+    static double centers[199];
+    static double widths[199];
+    if (!bench_selected("band_plan_compile")) return;
+
+    /* The VHF1.csv plan: 88.1 .. 107.9 MHz every 100 kHz, 250 kHz wide */
+    for (int i = 0; i < 199; i++) {
+        centers[i] = 88.1 + 0.1 * i;
+        widths[i] = 0.25;
+    }
+    for (size_t s = 0; s < sizeof(psd_sizes) / sizeof(psd_sizes[0]); s++) {
+        BandPlanCtx c = { .length = psd_sizes[s] };
+        if (band_plan_init(&c.plan, centers, widths, 199) != BAND_PLAN_SUCCESS) {
+            continue;
+        }
+        char params[48];
+        snprintf(params, sizeof(params), "channels=199");
+        bench_case("band_plan_compile", params, c.length, 0.0, run_band_plan, &c);
+        band_plan_free(&c.plan);
+    }
+}
+
+typedef struct {
+    double* f;
+    dsp_real_t* psd;
+    int length;
+    cJSON* json;
+    const char* path;
+    SpectrumJson spectrum;
+    double* db;
+    SpectrumFrame frame;
+    SpectrumFrameEncoding encoding;
+    SpectrumRing* ring;
+} JsonCtx;
+
+static double bench_canalization[1] = { 98.0 };
+static double bench_bandwidth[1] = { 0.2 };
+
+static void run_create_json(void* p) {
+    JsonCtx* c = (JsonCtx*)p;
+    cJSON* json = create_signal_json(c->f, c->psd, c->length, 0.0, bench_canalization,
+                                     bench_bandwidth, 1, -80, 0.0);
+    cJSON_Delete(json);
+}
+
+static void run_save_json(void* p) {
+    JsonCtx* c = (JsonCtx*)p;
+    save_json_to_file(c->json, c->path);
+}
+
+static void run_db_convert(void* p) {
+    JsonCtx* c = (JsonCtx*)p;
+    spectrum_db_convert(c->psd, c->db, c->length, 0.0);
+}
+
+static void run_spectrum_build(void* p) {
+    JsonCtx* c = (JsonCtx*)p;
+    spectrum_json_build(&c->spectrum, c->f, c->psd, c->length, 0.0);
+}
+
+static void run_spectrum_write(void* p) {
+    JsonCtx* c = (JsonCtx*)p;
+    spectrum_json_write(&c->spectrum, c->path);
+}
+
+static void run_frame_build(void* p) {
+    JsonCtx* c = (JsonCtx*)p;
+    spectrum_frame_build(&c->frame, c->f, c->psd, c->length, 0.0, c->encoding);
+}
+
+static void run_ring_publish(void* p) {
+    JsonCtx* c = (JsonCtx*)p;
+    size_t capacity = 0;
+    size_t written = 0;
+    uint8_t* slot = spectrum_ring_begin(c->ring, &capacity);
+    spectrum_frame_encode(&c->frame, slot, capacity, c->f, c->psd, c->length, 0.0, c->encoding, &written);
+    spectrum_ring_commit(c->ring, written);
+}
+
+static void bench_json(void) {
+    static const int sizes[] = { 4096, 32768 };
+    bool create = bench_selected("create_signal_json");
+    bool save = bench_selected("save_json_to_file");
+    bool db = bench_selected("spectrum_db_convert");
+    bool build = bench_selected("spectrum_json_build");
+    bool write = bench_selected("spectrum_json_write");
+    bool frame = bench_selected("spectrum_frame_build");
+    bool ring = bench_selected("spectrum_ring_publish");
+    if (!create && !save && !db && !build && !write && !frame && !ring) return;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/bench_kernels_%d.json", (int)getpid());
+    char ring_path[64];
+    snprintf(ring_path, sizeof(ring_path), "/tmp/bench_kernels_%d.ring", (int)getpid());
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        JsonCtx c = { linear_freqs(sizes[s]), random_psd(sizes[s]), sizes[s], NULL, path,
+                      { 0 }, NULL, { 0 }, SPECTRUM_FRAME_F32, NULL };
+        double input_bytes = (double)c.length * (sizeof(double) + sizeof(dsp_real_t));
+
+        if (create) {
+            bench_case("create_signal_json", "incl. cJSON_Delete", c.length, input_bytes,
+                       run_create_json, &c);
+        }
+        if (save) {
+            c.json = create_signal_json(c.f, c.psd, c.length, 0.0, bench_canalization,
+                                        bench_bandwidth, 1, -80, 0.0);
+            char* text = cJSON_Print(c.json);
+            double text_bytes = text ? (double)strlen(text) : 0.0;
+            free(text);
+            bench_case("save_json_to_file", "cJSON_Print+fwrite", c.length, text_bytes,
+                       run_save_json, &c);
+            cJSON_Delete(c.json);
+        }
+        if (db) {
+            c.db = (double*)malloc(c.length * sizeof(double));
+            bench_case("spectrum_db_convert", "", c.length,
+                       (double)c.length * (sizeof(dsp_real_t) + sizeof(double)), run_db_convert, &c);
+            free(c.db);
+        }
+        if (build || write) {
+            /* Buffers sized by a first build, as in steady state */
+            spectrum_json_init(&c.spectrum);
+            spectrum_json_build(&c.spectrum, c.f, c.psd, c.length, 0.0);
+            if (build) {
+                bench_case("spectrum_json_build", "reused buffer", c.length, input_bytes,
+                           run_spectrum_build, &c);
+            }
+            if (write) {
+                bench_case("spectrum_json_write", "fwrite", c.length, (double)c.spectrum.length,
+                           run_spectrum_write, &c);
+            }
+            spectrum_json_free(&c.spectrum);
+        }
+        if (frame) {
+            spectrum_frame_init(&c.frame);
+            for (int e = 0; e < 2; e++) {
+                c.encoding = (e == 0) ? SPECTRUM_FRAME_F32 : SPECTRUM_FRAME_I16;
+                spectrum_frame_build(&c.frame, c.f, c.psd, c.length, 0.0, c.encoding);
+                bench_case("spectrum_frame_build", e == 0 ? "f32" : "i16", c.length,
+                           (double)c.length * sizeof(dsp_real_t) + (double)c.frame.length,
+                           run_frame_build, &c);
+            }
+            spectrum_frame_free(&c.frame);
+        }
+        if (ring) {
+            /* Encode into the mapped slot and commit: replaces build + file write */
+            spectrum_frame_init(&c.frame);
+            c.encoding = SPECTRUM_FRAME_I16;
+            c.ring = spectrum_ring_create(ring_path, 8, spectrum_frame_size(c.length, SPECTRUM_FRAME_F32),
+                                          0, NULL);
+            if (c.ring != NULL) {
+                bench_case("spectrum_ring_publish", "i16 slots=8", c.length,
+                           (double)c.length * sizeof(dsp_real_t) +
+                           (double)spectrum_frame_size(c.length, c.encoding),
+                           run_ring_publish, &c);
+                spectrum_ring_close(c.ring);
+            }
+            spectrum_frame_free(&c.frame);
+        }
+        free(c.f);
+        free(c.psd);
+    }
+    unlink(path);
+    unlink(ring_path);
+}
+
+/* ---------------------------------------------------------------------------
+ * Precision check
+ * ------------------------------------------------------------------------- */
+
+/*
+ * PSD of the build's precision (WelchEngine, dsp_real_t) against the double
+ * reference welch_psd_complex() on the same tone-plus-noise capture, in dB,
+ * at the length main analyses (DEFAULT_SAMPLES_TO_XFER_MAX), where the
+ * periodogram accumulation error is largest. Returns false when a bin
+ * deviates by more than DSP_SINGLE_TOLERANCE_DB.
+ */
+static bool check_precision(void) {
+    static const size_t samples = DEFAULT_SAMPLES_TO_XFER_MAX;
+    static const int npersegs[] = { 4096, 32768 };
+    if (!bench_selected("welch_precision")) return true;
+
+    int8_t* raw = (int8_t*)malloc(2 * samples);
+    complex double* signal = (complex double*)malloc(samples * sizeof(complex double));
+    for (size_t i = 0; i < samples; i++) {
+        double phase = 2.0 * PI * 0.1234 * (double)i;
+        raw[2 * i] = (int8_t)lrint(60.0 * cos(phase) + (double)(int8_t)(bench_rand() & 0xff) / 4.0);
+        raw[2 * i + 1] = (int8_t)lrint(60.0 * sin(phase) + (double)(int8_t)(bench_rand() & 0xff) / 4.0);
+    }
+    cs8_to_iq_convert(raw, 2 * samples, signal, samples);
+
+    WelchEngineConfig config = { .fs = 20e6, .overlap = 0.0, .planning = WELCH_PLAN_ESTIMATE };
+    WelchEngine* engine = welch_engine_create(&config);
+    bool within = engine != NULL;
+
+    for (size_t k = 0; within && k < sizeof(npersegs) / sizeof(npersegs[0]); k++) {
+        int n = npersegs[k];
+        double* f = (double*)malloc(n * sizeof(double));
+        double* reference = (double*)malloc(n * sizeof(double));
+        dsp_real_t* psd = (dsp_real_t*)malloc(n * sizeof(dsp_real_t));
+
+        welch_psd_complex(signal, samples, 20e6, n, 0.0, f, reference);
+        double max_db = INFINITY;
+        if (welch_engine_psd_cs8(engine, raw, samples, n, f, psd) == WELCH_SUCCESS) {
+            max_db = 0.0;
+            for (int i = 0; i < n; i++) {
+                double diff = fabs(10.0 * log10((double)psd[i]) - 10.0 * log10(reference[i]));
+                if (!(diff <= max_db)) max_db = diff;
+            }
+        }
+        bool ok = max_db <= DSP_SINGLE_TOLERANCE_DB;
+        fprintf(stderr, "[bench] welch_precision          n=%-9d %-6s max |dB| = %.5f (tolerance %.2f) %s\n",
+                n, DSP_PRECISION_NAME, max_db, DSP_SINGLE_TOLERANCE_DB, ok ? "ok" : "FAILED");
+        within = within && ok;
+        free(f);
+        free(reference);
+        free(psd);
+    }
+
+    welch_engine_destroy(engine);
+    free(raw);
+    free(signal);
+    return within;
+}
+
+/* ---------------------------------------------------------------------------
+ * Reporting
+ * ------------------------------------------------------------------------- */
+
+static double ns_per_sample(const BenchResult* r) {
+    return r->ns_per_call / (double)r->samples;
+}
+
+static double gb_per_second(const BenchResult* r) {
+    return r->bytes / r->ns_per_call;
+}
+
+static void print_table(FILE* out) {
+    fprintf(out, "# precision=%s isa=%s build=%s\n", DSP_PRECISION_NAME, cs8_iq_kernel_name(), BENCH_BUILD_TYPE);
+    fprintf(out, "%-26s %-20s %10s %14s %10s %8s %10s %12s\n",
+            "kernel", "params", "n", "ns/call", "ns/sample", "GB/s", "allocs", "alloc_bytes");
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(out, "%-26s %-20s %10zu %14.1f %10.3f %8.2f %10.2f %12.0f\n",
+                r->kernel, r->params, r->samples, r->ns_per_call, ns_per_sample(r),
+                gb_per_second(r), r->allocs_per_call, r->alloc_bytes_per_call);
+    }
+}
+
+static void print_csv(FILE* out) {
+    fprintf(out, "kernel,params,n,ns_per_call,ns_per_call_min,ns_per_sample,gb_per_s,"
+                 "allocs_per_call,alloc_bytes_per_call,iterations,precision,isa,build\n");
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(out, "%s,%s,%zu,%.1f,%.1f,%.4f,%.3f,%.2f,%.0f,%ld,%s,%s,%s\n",
+                r->kernel, r->params, r->samples, r->ns_per_call, r->ns_per_call_min,
+                ns_per_sample(r), gb_per_second(r), r->allocs_per_call, r->alloc_bytes_per_call,
+                r->iterations, DSP_PRECISION_NAME, cs8_iq_kernel_name(), BENCH_BUILD_TYPE);
+    }
+}
+
+static void print_json(FILE* out) {
+    fprintf(out, "{\n  \"build\": {\"precision\": \"%s\", \"isa\": \"%s\", \"build_type\": \"%s\"},\n",
+            DSP_PRECISION_NAME, cs8_iq_kernel_name(), BENCH_BUILD_TYPE);
+    fprintf(out, "  \"results\": [\n");
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(out, "    {\"kernel\": \"%s\", \"params\": \"%s\", \"n\": %zu, \"ns_per_call\": %.1f, "
+                     "\"ns_per_call_min\": %.1f, \"ns_per_sample\": %.4f, \"gb_per_s\": %.3f, "
+                     "\"allocs_per_call\": %.2f, \"alloc_bytes_per_call\": %.0f, \"iterations\": %ld}%s\n",
+                r->kernel, r->params, r->samples, r->ns_per_call, r->ns_per_call_min,
+                ns_per_sample(r), gb_per_second(r), r->allocs_per_call, r->alloc_bytes_per_call,
+                r->iterations, i + 1 < result_count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [--format table|csv|json] [--filter substring] [--min-time s] [--verbose]\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    const char* format = "table";
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            format = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (strcmp(format, "table") != 0 && strcmp(format, "csv") != 0 && strcmp(format, "json") != 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Keep the report on the real stdout; kernels log with printf */
+    FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    if (out == NULL) {
+        perror("[bench] dup");
+        return EXIT_FAILURE;
+    }
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL) {
+        perror("[bench] freopen");
+        return EXIT_FAILURE;
+    }
+
+    bench_convert();
+    bench_welch();
+    bench_rearrange();
+    bench_correction();
+    bench_median();
+    bench_channel_stats();
+    bench_closest();
+    bench_band_plan();
+    bench_json();
+    bool precise = check_precision();
+
+    if (strcmp(format, "csv") == 0) {
+        print_csv(out);
+    } else if (strcmp(format, "json") == 0) {
+        print_json(out);
+    } else {
+        print_table(out);
+    }
+    fclose(out);
+    return precise ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,635 @@
+/**
+ * @file bench_pipeline.c
+ * @brief End-to-end throughput of the signal processor over capture sizes.
+ *
+ * A synthetic FM scene (Modules/rf_scene.h) or a CS8 file is held in memory
+ * and analysed exactly as main does: a persistent WelchEngine and
+ * SignalProcessor, in-memory input, detection over the channel plan and the
+ * JSON written to disk. For every capture size x nperseg pair x thread count
+ * the harness reports:
+ *
+ * - wall time of signal_processor_process_cs8() and samples/s relative to the
+ *   20 MS/s real-time rate (rt > 1 means faster than the radio)
+ * - peak RSS during the call (VmHWM, reset through /proc/self/clear_refs)
+ * - a per-stage breakdown of that same call, read from the spans the
+ *   processor records in perf_stats: psd (convert + welch, both
+ *   resolutions), post (postprocess: FFT shift, DC correction, absolute
+ *   frequencies) and publish (detect, json_build and file_write)
+ * - plan: one-time engine and processor creation, FFTW planning for the pair
+ *
+ * Usage:
+ *   bench_pipeline [--sizes 1M,4M,10M,40M,100M] [--nperseg 32768/4096,...]
+ *                  [--threads 1,2,auto] [--repeat n] [--file capture.cs8]
+ *                  [--bands bands/VHF1.csv] [--planning estimate|measure]
+ *                  [--format table|csv|json]
+ *
+ * Times are medians over --repeat runs.
+ *
+ * Before the sweep, an overlap check runs the capture pipeline (pipeline.h)
+ * with sleeping stages, processing slower than acquisition, and fails the run
+ * when the update rate falls towards 1/(acquire + process) instead of
+ * 1/process.
+ */
+
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Modules/dsp_precision.h"
+#include "Modules/CS8toIQ.h"
+#include "Modules/welch_engine.h"
+#include "Modules/parameter.h"
+#include "Modules/perf_stats.h"
+#include "Modules/pipeline.h"
+#include "Modules/rf_scene.h"
+
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE "unknown"
+#endif
+
+/** @brief Real-time sample rate of the radio */
+#define BENCH_REALTIME_RATE 20e6
+
+/** @brief Centre frequency of the synthetic scene and of the analysis */
+#define BENCH_CENTER_FREQ 98000000ULL
+
+#define BENCH_MAX_LIST 16
+#define BENCH_MAX_REPEAT 15
+#define BENCH_MAX_CHANNELS 250
+
+typedef struct {
+    size_t samples;
+    int    nperseg_large;
+    int    nperseg_small;
+    int    threads_requested;
+    int    threads;             /**< Workers the engine actually started */
+    double plan_ms;
+    double total_ms;            /**< signal_processor_process_cs8() */
+    double psd_ms;
+    double post_ms;
+    double publish_ms;
+    double peak_rss_mb;         /**< VmHWM during signal_processor_process_cs8() */
+    double base_rss_mb;         /**< VmRSS before the call (includes the capture) */
+} PipelineResult;
+
+typedef struct {
+    const int8_t* capture;
+    double*       canalization;
+    double*       bandwidth;
+    int           channel_count;
+    const char*   json_path;
+    WelchPlanning planning;
+    int           repeat;
+} BenchSetup;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double* values, int count) {
+    qsort(values, count, sizeof(double), compare_doubles);
+    return values[count / 2];
+}
+
+/* ---------------------------------------------------------------------------
+ * Memory
+ * ------------------------------------------------------------------------- */
+
+static double proc_status_mb(const char* key) {
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file == NULL) {
+        return -1.0;
+    }
+    char line[256];
+    size_t key_length = strlen(key);
+    double kb = -1.0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strncmp(line, key, key_length) == 0 && line[key_length] == ':') {
+            kb = atof(line + key_length + 1);
+            break;
+        }
+    }
+    fclose(file);
+    return kb < 0 ? -1.0 : kb / 1024.0;
+}
+
+/* Restart the peak RSS watermark (Linux >= 4.0); harmless elsewhere */
+static void reset_peak_rss(void) {
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (file != NULL) {
+        fputs("5", file);
+        fclose(file);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Inputs
+ * ------------------------------------------------------------------------- */
+
+static int load_plan(const char* path, double* canalization, double* bandwidth) {
+    FILE* file = fopen(path, "r");
+    int count = 0;
+
+    if (file != NULL) {
+        char line[128];
+        if (fgets(line, sizeof(line), file) != NULL) {   /* header */
+            while (count < BENCH_MAX_CHANNELS && fgets(line, sizeof(line), file) != NULL) {
+                if (sscanf(line, "%lf,%lf", &canalization[count], &bandwidth[count]) == 2) {
+                    count++;
+                }
+            }
+        }
+        fclose(file);
+    }
+    if (count == 0) {
+        fprintf(stderr, "[bench] No channel plan at %s, using 88.1-107.9 MHz every 200 kHz\n", path);
+        for (count = 0; count < 100; count++) {
+            canalization[count] = 88.1 + 0.2 * count;
+            bandwidth[count] = 0.2;
+        }
+    }
+    return count;
+}
+
+static int8_t* synthesize_capture(size_t samples, const double* channels, int channel_count) {
+    RFSceneConfig config;
+    rf_scene_default_config(&config);
+    config.sample_rate = BENCH_REALTIME_RATE;
+    config.channels_mhz = channels;
+    config.channel_count = channel_count;
+
+    int8_t* capture = (int8_t*)malloc(2 * samples);
+    RFScene* scene = rf_scene_create(&config);
+    if (capture == NULL || scene == NULL || rf_scene_tune(scene, (double)BENCH_CENTER_FREQ) != RF_SCENE_SUCCESS) {
+        free(capture);
+        rf_scene_destroy(scene);
+        return NULL;
+    }
+    rf_scene_generate(scene, capture, samples);
+    rf_scene_destroy(scene);
+    return capture;
+}
+
+static int8_t* read_capture(const char* path, size_t* samples) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long bytes = ftell(file);
+    rewind(file);
+
+    size_t available = bytes > 0 ? (size_t)bytes / 2 : 0;
+    if (available < *samples) {
+        *samples = available;
+    }
+    int8_t* capture = (int8_t*)malloc(2 * *samples + 1);
+    if (capture != NULL && fread(capture, 2, *samples, file) != *samples) {
+        free(capture);
+        capture = NULL;
+    }
+    fclose(file);
+    return capture;
+}
+
+/* ---------------------------------------------------------------------------
+ * One case
+ * ------------------------------------------------------------------------- */
+
+/* Time recorded for one stage since the last perf_stats_reset(), in ms */
+static double stage_ms(PerfStage stage) {
+    PerfStageSummary summary;
+    perf_stats_summary(stage, &summary);
+    return summary.mean_ns * summary.count / 1e6;
+}
+
+static int run_case(const BenchSetup* setup, size_t samples, int nperseg_large, int nperseg_small,
+                    int threads, PipelineResult* r) {
+    memset(r, 0, sizeof(*r));
+    r->samples = samples;
+    r->nperseg_large = nperseg_large;
+    r->nperseg_small = nperseg_small;
+    r->threads_requested = threads;
+
+    double t0 = now_ms();
+    WelchEngineConfig engine_config = {
+        .fs = BENCH_REALTIME_RATE,
+        .overlap = 0,
+        .planning = setup->planning,
+        .wisdom_path = NULL,
+        .num_threads = threads
+    };
+    WelchEngine* engine = welch_engine_create(&engine_config);
+    if (engine == NULL || welch_engine_prepare(engine, nperseg_large) != WELCH_SUCCESS ||
+        welch_engine_prepare(engine, nperseg_small) != WELCH_SUCCESS) {
+        welch_engine_destroy(engine);
+        return -1;
+    }
+    r->threads = welch_engine_thread_count(engine);
+
+    SignalProcessorConfig config = {
+        .central_freq = BENCH_CENTER_FREQ,
+        .nperseg_large = nperseg_large,
+        .nperseg_small = nperseg_small,
+        .threshold = -80,
+        .canalization = setup->canalization,
+        .bandwidth = setup->bandwidth,
+        .canalization_length = setup->channel_count,
+        .output_json_path = setup->json_path,
+        .verbose_output = false,
+        .welch_engine = engine,
+        .num_threads = threads
+    };
+    SignalProcessor* processor = signal_processor_create(&config);
+    if (processor == NULL) {
+        welch_engine_destroy(engine);
+        return -1;
+    }
+    r->plan_ms = now_ms() - t0;
+
+    int status = 0;
+    double total[BENCH_MAX_REPEAT], psd[BENCH_MAX_REPEAT], post[BENCH_MAX_REPEAT], publish[BENCH_MAX_REPEAT];
+    for (int i = 0; i < setup->repeat; i++) {
+        r->base_rss_mb = proc_status_mb("VmRSS");
+        reset_peak_rss();
+        perf_stats_reset();
+        double start = now_ms();
+        if (signal_processor_process_cs8(processor, setup->capture, samples) != SP_SUCCESS) {
+            status = -1;
+            break;
+        }
+        total[i] = now_ms() - start;
+        double peak = proc_status_mb("VmHWM");
+        if (peak > r->peak_rss_mb) {
+            r->peak_rss_mb = peak;
+        }
+
+        /* Stage breakdown of the same call, as recorded by the processor itself */
+        psd[i] = stage_ms(PERF_STAGE_CONVERT) + stage_ms(PERF_STAGE_WELCH);
+        post[i] = stage_ms(PERF_STAGE_POSTPROCESS);
+        publish[i] = stage_ms(PERF_STAGE_DETECT) + stage_ms(PERF_STAGE_JSON_BUILD) +
+                     stage_ms(PERF_STAGE_FILE_WRITE);
+    }
+
+    if (status == 0) {
+        r->total_ms = median(total, setup->repeat);
+        r->psd_ms = median(psd, setup->repeat);
+        r->post_ms = median(post, setup->repeat);
+        r->publish_ms = median(publish, setup->repeat);
+    }
+
+    signal_processor_destroy(processor);
+    welch_engine_destroy(engine);
+    return status;
+}
+
+/* ---------------------------------------------------------------------------
+ * Overlap check
+ * ------------------------------------------------------------------------- */
+
+/** @brief Stage times of the overlap check: processing is the slower stage */
+#define OVERLAP_ACQUIRE_MS 20
+#define OVERLAP_PROCESS_MS 25
+#define OVERLAP_RUN_MS     1000
+
+typedef struct {
+    double                start_ms;
+    volatile sig_atomic_t running;
+} OverlapRun;
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0) {
+    }
+}
+
+static int overlap_acquire(PipelineBuffer* buffer, void* user) {
+    (void)user;
+    sleep_ms(OVERLAP_ACQUIRE_MS);
+    buffer->length = buffer->capacity;
+    return 0;
+}
+
+static int overlap_process(const PipelineBuffer* buffer, void* user) {
+    OverlapRun* run = (OverlapRun*)user;
+    (void)buffer;
+    sleep_ms(OVERLAP_PROCESS_MS);
+    if (now_ms() - run->start_ms >= OVERLAP_RUN_MS) {
+        run->running = 0;
+    }
+    return 0;
+}
+
+/*
+ * With processing slower than acquisition the pipeline must keep the
+ * consumer busy: at least 80% of OVERLAP_RUN_MS / OVERLAP_PROCESS_MS
+ * captures processed, for either policy. Returns false otherwise.
+ */
+static bool check_overlap(void) {
+    static const struct {
+        int                  buffers;
+        PipelineBackpressure backpressure;
+    } cases[] = {
+        { 2, PIPELINE_BLOCK },
+        { 2, PIPELINE_DROP_OLDEST },
+        { 3, PIPELINE_DROP_OLDEST },
+    };
+    const uint64_t expected = (uint64_t)(0.8 * OVERLAP_RUN_MS / OVERLAP_PROCESS_MS);
+    bool within = true;
+
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+        OverlapRun run = { .running = 1 };
+        PipelineConfig config = {
+            .num_buffers = cases[k].buffers,
+            .buffer_bytes = 64,
+            .backpressure = cases[k].backpressure,
+            .acquire = overlap_acquire,
+            .process = overlap_process,
+            .user = &run
+        };
+        Pipeline* pipeline = pipeline_create(&config);
+        PipelineStats stats = { 0 };
+        bool ok = false;
+        if (pipeline != NULL) {
+            run.start_ms = now_ms();
+            ok = pipeline_run(pipeline, &run.running) == PIPELINE_SUCCESS;
+            pipeline_get_stats(pipeline, &stats);
+            pipeline_destroy(pipeline);
+        }
+        ok = ok && stats.processed >= expected;
+        fprintf(stderr, "[bench] pipeline_overlap %d buffers %-11s %3llu processed, %3llu dropped "
+                        "(expected >= %llu) %s\n",
+                cases[k].buffers, cases[k].backpressure == PIPELINE_BLOCK ? "block" : "drop_oldest",
+                (unsigned long long)stats.processed, (unsigned long long)stats.dropped,
+                (unsigned long long)expected, ok ? "ok" : "FAILED");
+        within = within && ok;
+    }
+    return within;
+}
+
+/* ---------------------------------------------------------------------------
+ * Reporting
+ * ------------------------------------------------------------------------- */
+
+static double samples_per_second(const PipelineResult* r) {
+    return r->samples / (r->total_ms / 1e3);
+}
+
+static void print_table(FILE* out, const PipelineResult* results, int count) {
+    fprintf(out, "# precision=%s isa=%s build=%s realtime=%.0f S/s\n",
+            DSP_PRECISION_NAME, cs8_iq_kernel_name(), BENCH_BUILD_TYPE, BENCH_REALTIME_RATE);
+    fprintf(out, "%10s %13s %7s %9s %10s %9s %8s %10s %9s %8s %9s %9s\n",
+            "samples", "nperseg", "threads", "plan_ms", "total_ms", "psd_ms", "post_ms",
+            "publish_ms", "MS/s", "rt", "rss_MB", "base_MB");
+    for (int i = 0; i < count; i++) {
+        const PipelineResult* r = &results[i];
+        char nperseg[24];
+        snprintf(nperseg, sizeof(nperseg), "%d/%d", r->nperseg_large, r->nperseg_small);
+        fprintf(out, "%10zu %13s %7d %9.1f %10.1f %9.1f %8.2f %10.2f %9.2f %8.3f %9.1f %9.1f\n",
+                r->samples, nperseg, r->threads, r->plan_ms, r->total_ms, r->psd_ms, r->post_ms,
+                r->publish_ms, samples_per_second(r) / 1e6, samples_per_second(r) / BENCH_REALTIME_RATE,
+                r->peak_rss_mb, r->base_rss_mb);
+    }
+}
+
+static void print_csv(FILE* out, const PipelineResult* results, int count) {
+    fprintf(out, "samples,nperseg_large,nperseg_small,threads,plan_ms,total_ms,psd_ms,post_ms,publish_ms,"
+                 "samples_per_s,realtime_factor,peak_rss_mb,base_rss_mb,precision,isa,build\n");
+    for (int i = 0; i < count; i++) {
+        const PipelineResult* r = &results[i];
+        fprintf(out, "%zu,%d,%d,%d,%.2f,%.2f,%.2f,%.3f,%.3f,%.0f,%.4f,%.1f,%.1f,%s,%s,%s\n",
+                r->samples, r->nperseg_large, r->nperseg_small, r->threads, r->plan_ms, r->total_ms,
+                r->psd_ms, r->post_ms, r->publish_ms, samples_per_second(r),
+                samples_per_second(r) / BENCH_REALTIME_RATE, r->peak_rss_mb, r->base_rss_mb,
+                DSP_PRECISION_NAME, cs8_iq_kernel_name(), BENCH_BUILD_TYPE);
+    }
+}
+
+static void print_json(FILE* out, const PipelineResult* results, int count) {
+    fprintf(out, "{\n  \"build\": {\"precision\": \"%s\", \"isa\": \"%s\", \"build_type\": \"%s\", "
+                 "\"realtime_rate\": %.0f},\n",
+            DSP_PRECISION_NAME, cs8_iq_kernel_name(), BENCH_BUILD_TYPE, BENCH_REALTIME_RATE);
+    fprintf(out, "  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const PipelineResult* r = &results[i];
+        fprintf(out, "    {\"samples\": %zu, \"nperseg_large\": %d, \"nperseg_small\": %d, \"threads\": %d, "
+                     "\"plan_ms\": %.2f, \"total_ms\": %.2f, \"stages_ms\": {\"psd\": %.2f, \"post\": %.3f, "
+                     "\"publish\": %.3f}, \"samples_per_s\": %.0f, \"realtime_factor\": %.4f, "
+                     "\"peak_rss_mb\": %.1f, \"base_rss_mb\": %.1f}%s\n",
+                r->samples, r->nperseg_large, r->nperseg_small, r->threads, r->plan_ms, r->total_ms,
+                r->psd_ms, r->post_ms, r->publish_ms, samples_per_second(r),
+                samples_per_second(r) / BENCH_REALTIME_RATE, r->peak_rss_mb, r->base_rss_mb,
+                i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+/* ---------------------------------------------------------------------------
+ * Command line
+ * ------------------------------------------------------------------------- */
+
+/* "1M,4M,250k,1000" */
+static int parse_sizes(const char* text, size_t* sizes) {
+    int count = 0;
+    const char* p = text;
+    while (*p && count < BENCH_MAX_LIST) {
+        char* end = NULL;
+        double value = strtod(p, &end);
+        if (end == p || value <= 0) return -1;
+        if (*end == 'M' || *end == 'm') { value *= 1e6; end++; }
+        else if (*end == 'k' || *end == 'K') { value *= 1e3; end++; }
+        sizes[count++] = (size_t)value;
+        if (*end == ',') end++;
+        else if (*end != '\0') return -1;
+        p = end;
+    }
+    return count;
+}
+
+/* "32768/4096,65536/8192" */
+static int parse_npersegs(const char* text, int* large, int* small) {
+    int count = 0;
+    const char* p = text;
+    while (*p && count < BENCH_MAX_LIST) {
+        int consumed = 0;
+        if (sscanf(p, "%d/%d%n", &large[count], &small[count], &consumed) != 2 ||
+            large[count] <= 0 || small[count] <= 0 || large[count] % 2 || small[count] % 2) {
+            return -1;
+        }
+        count++;
+        p += consumed;
+        if (*p == ',') p++;
+        else if (*p != '\0') return -1;
+    }
+    return count;
+}
+
+/* "1,2,auto" */
+static int parse_threads(const char* text, int* threads) {
+    int count = 0;
+    const char* p = text;
+    while (*p && count < BENCH_MAX_LIST) {
+        if (strncmp(p, "auto", 4) == 0) {
+            threads[count++] = WELCH_THREADS_AUTO;
+            p += 4;
+        } else {
+            char* end = NULL;
+            long value = strtol(p, &end, 10);
+            if (end == p || value < 0) return -1;
+            threads[count++] = (int)value;
+            p = end;
+        }
+        if (*p == ',') p++;
+        else if (*p != '\0') return -1;
+    }
+    return count;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--sizes 1M,4M,10M,40M,100M] [--nperseg 32768/4096,...] [--threads 1,2,auto]\n"
+            "          [--repeat n] [--file capture.cs8] [--bands bands/VHF1.csv]\n"
+            "          [--planning estimate|measure] [--format table|csv|json]\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    const char* sizes_arg = "1M,4M,10M,40M,100M";
+    const char* nperseg_arg = "32768/4096,16384/2048";
+    const char* threads_arg = "1,2,auto";
+    const char* format = "table";
+    const char* file = NULL;
+    const char* bands = "bands/VHF1.csv";
+    BenchSetup setup = { .planning = WELCH_PLAN_MEASURE, .repeat = 3 };
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[i], "--sizes") == 0) sizes_arg = value;
+        else if (strcmp(argv[i], "--nperseg") == 0) nperseg_arg = value;
+        else if (strcmp(argv[i], "--threads") == 0) threads_arg = value;
+        else if (strcmp(argv[i], "--repeat") == 0) setup.repeat = atoi(value);
+        else if (strcmp(argv[i], "--file") == 0) file = value;
+        else if (strcmp(argv[i], "--bands") == 0) bands = value;
+        else if (strcmp(argv[i], "--format") == 0) format = value;
+        else if (strcmp(argv[i], "--planning") == 0) {
+            setup.planning = strcmp(value, "estimate") == 0 ? WELCH_PLAN_ESTIMATE : WELCH_PLAN_MEASURE;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    size_t sizes[BENCH_MAX_LIST];
+    int large[BENCH_MAX_LIST], small[BENCH_MAX_LIST], threads[BENCH_MAX_LIST];
+    int size_count = parse_sizes(sizes_arg, sizes);
+    int nperseg_count = parse_npersegs(nperseg_arg, large, small);
+    int thread_count = parse_threads(threads_arg, threads);
+    if (size_count <= 0 || nperseg_count <= 0 || thread_count <= 0 ||
+        setup.repeat < 1 || setup.repeat > BENCH_MAX_REPEAT ||
+        (strcmp(format, "table") != 0 && strcmp(format, "csv") != 0 && strcmp(format, "json") != 0)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bool overlapped = check_overlap();
+
+    static double canalization[BENCH_MAX_CHANNELS], bandwidth[BENCH_MAX_CHANNELS];
+    setup.canalization = canalization;
+    setup.bandwidth = bandwidth;
+    setup.channel_count = load_plan(bands, canalization, bandwidth);
+
+    size_t max_samples = 0;
+    for (int i = 0; i < size_count; i++) {
+        if (sizes[i] > max_samples) max_samples = sizes[i];
+    }
+
+    /* One capture; smaller sizes analyse a prefix of it */
+    double t0 = now_ms();
+    int8_t* capture;
+    if (file != NULL) {
+        size_t available = max_samples;
+        capture = read_capture(file, &available);
+        if (capture != NULL && available < max_samples) {
+            fprintf(stderr, "[bench] %s holds %zu samples; larger sizes are skipped\n", file, available);
+            max_samples = available;
+        }
+    } else {
+        capture = synthesize_capture(max_samples, canalization, setup.channel_count);
+    }
+    if (capture == NULL) {
+        fprintf(stderr, "[bench] Unable to prepare a %zu-sample capture\n", max_samples);
+        return EXIT_FAILURE;
+    }
+    setup.capture = capture;
+    fprintf(stderr, "[bench] %zu-sample capture ready in %.0f ms (%s)\n",
+            max_samples, now_ms() - t0, file != NULL ? file : "synthetic scene");
+
+    char json_path[64];
+    snprintf(json_path, sizeof(json_path), "/tmp/bench_pipeline_%d.json", (int)getpid());
+    setup.json_path = json_path;
+
+    /* Keep the report on the real stdout; the modules log with printf */
+    FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    if (out == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        perror("[bench] stdout");
+        free(capture);
+        return EXIT_FAILURE;
+    }
+
+    PipelineResult* results = (PipelineResult*)calloc(size_count * nperseg_count * thread_count,
+                                                      sizeof(PipelineResult));
+    int result_count = 0;
+    int status = EXIT_SUCCESS;
+
+    for (int k = 0; k < nperseg_count; k++) {
+        for (int t = 0; t < thread_count; t++) {
+            for (int s = 0; s < size_count; s++) {
+                if (sizes[s] > max_samples || sizes[s] < (size_t)large[k]) {
+                    continue;
+                }
+                PipelineResult* r = &results[result_count];
+                if (run_case(&setup, sizes[s], large[k], small[k], threads[t], r) != 0) {
+                    fprintf(stderr, "[bench] %zu samples, nperseg %d/%d, %d threads: processing failed\n",
+                            sizes[s], large[k], small[k], threads[t]);
+                    status = EXIT_FAILURE;
+                    continue;
+                }
+                fprintf(stderr, "[bench] %10zu samples %6d/%-5d %2d threads: %9.1f ms, %.3fx real time\n",
+                        r->samples, r->nperseg_large, r->nperseg_small, r->threads, r->total_ms,
+                        samples_per_second(r) / BENCH_REALTIME_RATE);
+                result_count++;
+            }
+        }
+    }
+
+    if (strcmp(format, "csv") == 0) {
+        print_csv(out, results, result_count);
+    } else if (strcmp(format, "json") == 0) {
+        print_json(out, results, result_count);
+    } else {
+        print_table(out, results, result_count);
+    }
+
+    fclose(out);
+    unlink(json_path);
+    free(results);
+    free(capture);
+    return overlapped ? status : EXIT_FAILURE;
+}
@@ -1,10 +1,15 @@
-#include <libhackrf/hackrf.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <unistd.h>
 #include <signal.h>
+#include <pthread.h>
+#include <time.h>
 #include "bacn_RF.h"
+#include "sdr_backend.h"
+#include "perf_stats.h"
+#include "trace.h"
 
 
 static volatile bool do_exit = false;
@@ -23,29 +28,112 @@ size_t bytes_to_xfer = 0;
 int64_t lo_freq = 0;
 int64_t hi_freq = 0;
 
-static hackrf_device* device = NULL;
+/* Fin de captura: lo marca rx_deliver, lo espera wait_capture() */
+static pthread_mutex_t capture_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t capture_cond = PTHREAD_COND_INITIALIZER;
+static bool capture_done = false;
+
+/* Destino lineal de getSamplesInto(); NULL fuera de esa llamada */
+static uint8_t* capture_dst = NULL;
+static size_t capture_cap = 0;
+static size_t capture_pos = 0;
+
+/* Fuente usada por getSamples(); se abre en la primera llamada */
+static sdr_backend_t* backend = NULL;
+static sdr_backend_options_t backend_options = {
+#ifdef HAVE_HACKRF
+	.kind = SDR_BACKEND_HACKRF,
+#else
+	.kind = SDR_BACKEND_SYNTHETIC,
+#endif
+	.rate = 1.0,
+	.loop = true
+};
+
+static sample_sink_fn sample_sink = NULL;
+static void* sample_sink_user = NULL;
+
+void set_sample_sink(sample_sink_fn sink, void* user)
+{
+	sample_sink_user = user;
+	sample_sink = sink;
+}
+
+/*
+ * Anillo en memoria (modo sin disco). Un solo productor (rx_callback) avanza
+ * stream_tail y un solo consumidor (hilo DSP) avanza stream_head; cada lado
+ * publica su índice con release y lee el del otro con acquire.
+ */
+int stream_init(size_t size)
+{
+	if (size < 2 || size > UINT32_MAX) {
+		return -1;
+	}
+	stream_free();
+	stream_buf = (uint8_t*)malloc(size);
+	if (stream_buf == NULL) {
+		return -1;
+	}
+	stream_head = 0;
+	stream_tail = 0;
+	stream_drop = 0;
+	stream_size = size;
+	return 0;
+}
+
+void stream_free(void)
+{
+	stream_size = 0;
+	free(stream_buf);
+	stream_buf = NULL;
+}
+
+size_t stream_peek(const int8_t** data)
+{
+	uint32_t head = __atomic_load_n(&stream_head, __ATOMIC_RELAXED);
+	uint32_t tail = __atomic_load_n(&stream_tail, __ATOMIC_ACQUIRE);
+
+	*data = (const int8_t*)(stream_buf + head);
+	/* Solo la parte contigua; el resto queda para el siguiente peek */
+	return (tail >= head) ? (tail - head) : (stream_size - head);
+}
+
+void stream_consume(size_t length)
+{
+	uint32_t head = __atomic_load_n(&stream_head, __ATOMIC_RELAXED);
+	__atomic_store_n(&stream_head, (uint32_t)((head + length) % stream_size), __ATOMIC_RELEASE);
+}
+
+uint32_t get_stream_drops(void)
+{
+	return __atomic_load_n(&stream_drop, __ATOMIC_RELAXED);
+}
 
 void stop_main_loop(void)
 {
-	do_exit = true;
-	kill(getpid(), SIGALRM);
+	pthread_mutex_lock(&capture_lock);
+	capture_done = true;
+	pthread_cond_broadcast(&capture_cond);
+	pthread_mutex_unlock(&capture_lock);
 }
 
-int rx_callback(hackrf_transfer* transfer)
+/* Callback común de todos los backends: reparte cada búfer recibido */
+static int rx_deliver(const uint8_t* buffer, size_t valid_length, void* user)
 {
+	(void)user;
 	size_t bytes_to_write;
 	size_t bytes_written;
 
-	if (file == NULL) {
+	if (file == NULL && stream_size == 0 && sample_sink == NULL && capture_dst == NULL) {
 		stop_main_loop();
 		return -1;
 	}
 
 	/* Determina cuántos bytes escribir */
-	bytes_to_write = transfer->valid_length;
+	bytes_to_write = valid_length;
 
 	/* Actualiza el conteo de bytes */
-	byte_count += transfer->valid_length;
+	byte_count += valid_length;
 	
 	if (limit_num_samples) {
 		if (bytes_to_write >= bytes_to_xfer) {
@@ -54,9 +142,36 @@ int rx_callback(hackrf_transfer* transfer)
 		bytes_to_xfer -= bytes_to_write;
 	}
 
+	/* Entrega el bloque al consumidor en memoria antes de tocar el disco */
+	if (sample_sink != NULL) {
+		sample_sink((const int8_t*)buffer, bytes_to_write, sample_sink_user);
+	}
+
+	/* Captura directa al búfer del llamador */
+	if (capture_dst != NULL) {
+		size_t room = capture_cap - capture_pos;
+		size_t n = bytes_to_write < room ? bytes_to_write : room;
+		memcpy(capture_dst + capture_pos, buffer, n);
+		capture_pos += n;
+		if ((limit_num_samples && (bytes_to_xfer == 0)) || capture_pos == capture_cap) {
+			stop_main_loop();
+			return -1;
+		}
+		return 0;
+	}
+
+	/* Solo consumidor en memoria: sin archivo ni anillo */
+	if (file == NULL && stream_size == 0) {
+		if (limit_num_samples && (bytes_to_xfer == 0)) {
+			stop_main_loop();
+			return -1;
+		}
+		return 0;
+	}
+
 	/* Escribe los datos directamente en el archivo si no hay búfer de transmisión */
 	if (stream_size == 0) {
-		bytes_written = fwrite(transfer->buffer, 1, bytes_to_write, file);
+		bytes_written = fwrite(buffer, 1, bytes_to_write, file);
 		if ((bytes_written != bytes_to_write) ||
 		    (limit_num_samples && (bytes_to_xfer == 0))) {
 			stop_main_loop();
@@ -67,20 +182,21 @@ int rx_callback(hackrf_transfer* transfer)
 		}
 	}
 
-	if ((stream_size - 1 + stream_head - stream_tail) % stream_size <
+	uint32_t head = __atomic_load_n(&stream_head, __ATOMIC_ACQUIRE);
+	if ((stream_size - 1 + head - stream_tail) % stream_size <
 	    bytes_to_write) {
-		stream_drop++;
+		__atomic_fetch_add(&stream_drop, 1, __ATOMIC_RELAXED);
 	} else {
 		if (stream_tail + bytes_to_write <= stream_size) {
 			memcpy(stream_buf + stream_tail,
-			       transfer->buffer,
+			       buffer,
 			       bytes_to_write);
 		} else {
 			memcpy(stream_buf + stream_tail,
-			       transfer->buffer,
+			       buffer,
 			       (stream_size - stream_tail));
 			memcpy(stream_buf,
-			       transfer->buffer + (stream_size - stream_tail),
+			       buffer + (stream_size - stream_tail),
 			       bytes_to_write - (stream_size - stream_tail));
 		};
 		__atomic_store_n(
@@ -88,6 +204,12 @@ int rx_callback(hackrf_transfer* transfer)
 			(stream_tail + bytes_to_write) % stream_size,
 			__ATOMIC_RELEASE);
 	}
+
+	if (limit_num_samples && (bytes_to_xfer == 0)) {
+		stop_main_loop();
+		fprintf(stderr, "[driver] Total Bytes: %u\n",byte_count);
+		return -1;
+	}
 	return 0;
 }
 
@@ -107,29 +229,8 @@ void sigalrm_callback_handler()
 {
 }
 
-int getSamples(int64_t lo_freq, int64_t hi_freq)
+void rf_install_signal_handlers(void)
 {
-    int result = 0;
-	uint8_t tSample = 0;
-	int64_t central_freq;
-	uint64_t byte_count_now = 0;
-	char path[60];
-
-    tSample = (hi_freq - lo_freq)/DEFAULT_SAMPLE_RATE_HZ;
-				
-    central_freq = lo_freq + DEFAULT_CENTRAL_FREQ_HZ;
-    fprintf(stderr, "[driver] central frequency: %lu\n", central_freq);
-
-    result = hackrf_init();
-	if (result != HACKRF_SUCCESS) {
-		fprintf(stderr,
-			"[driver] hackrf_init() failed: %s (%d)\n",
-			hackrf_error_name(result),
-			result);
-		return -1;
-	}
-
-	// Configura manejadores de señales
 	signal(SIGINT, &sigint_callback_handler);
 	signal(SIGILL, &sigint_callback_handler);
 	signal(SIGFPE, &sigint_callback_handler);
@@ -138,145 +239,256 @@ int getSamples(int64_t lo_freq, int64_t hi_freq)
 	signal(SIGABRT, &sigint_callback_handler);
 
 	signal(SIGALRM, &sigalrm_callback_handler);
+}
 
-	fprintf(stderr, "[driver] Device initialized\r\n");
+int select_sdr_backend(const sdr_backend_options_t* options)
+{
+	/* Cambiar de fuente cierra la anterior; la nueva se abre en la próxima captura */
+	closeSamples();
+	backend_options = *options;
+	return 0;
+}
 
-    for(uint8_t i=0; i<tSample; i++)
-	{		
-		byte_count_now = 0;
-		bytes_to_xfer = DEFAULT_SAMPLES_TO_XFER_MAX * 2ull;
-		
-		memset(path, 0, 20);
-		sprintf(path, "backend/Core/Samples/%d", i);
-		file = fopen(path, "wb");
-	
-		if (file == NULL) {
-			fprintf(stderr, "[driver] Failed to open file: %s\n", path);
-			return -1;
-		}
-		/* Change file buffer to have bigger one to store or read data on/to HDD */
-		result = setvbuf(file, NULL, _IOFBF, FD_BUFFER_SIZE);
-		if (result != 0) {
-			fprintf(stderr, "[driver] setvbuf() failed: %d\n", result);
+static int open_backend(void)
+{
+	if (backend == NULL) {
+		backend = sdr_backend_create(&backend_options);
+		if (backend == NULL) {
 			return -1;
 		}
+	}
+	if (sdr_open(backend, DEFAULT_SAMPLE_RATE_HZ) != 0) {
+		sdr_backend_destroy(backend);
+		backend = NULL;
+		return -1;
+	}
+	rf_install_signal_handlers();
+	return 0;
+}
 
-		fprintf(stderr,"[driver] Start Acquisition\n");
 
-		result = hackrf_open(&device);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"[driver] hackrf_open() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-			return -1;
-		}
-		
-        result = hackrf_set_sample_rate(device, DEFAULT_SAMPLE_RATE_HZ);
-        if (result != HACKRF_SUCCESS) {
-            fprintf(stderr,
-                "[driver] hackrf_set_sample_rate() failed: %s (%d)\n",
-                hackrf_error_name(result),
-                result);
-            return -1;
-        }		
-		
-		result = hackrf_set_hw_sync_mode(device, 0);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"[driver] hackrf_set_hw_sync_mode() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-			return -1;
+/*
+ * Espera a que rx_callback complete la captura. Sale antes si llega una
+ * señal de salida o si no entra ningún byte durante un segundo.
+ */
+static int wait_capture(void)
+{
+	uint32_t last_count = 0;
+	int idle_ms = 0;
+	bool done;
+
+	pthread_mutex_lock(&capture_lock);
+	while (!capture_done && !do_exit && idle_ms < 1000) {
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += 100 * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
 		}
-		
-        result = hackrf_set_freq(device, central_freq);
-        if (result != HACKRF_SUCCESS) {
-            fprintf(stderr,
-                "[driver] hackrf_set_freq() failed: %s (%d)\n",
-                hackrf_error_name(result),
-                result);
-            return -1;
-        }		
-		
-        result = hackrf_set_vga_gain(device, 0);
-        result |= hackrf_set_lna_gain(device, 0);
-        result |= hackrf_start_rx(device, rx_callback, NULL);
-
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"[driver] hackrf_start_rx() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-			return -1;
+		pthread_cond_timedwait(&capture_cond, &capture_lock, &deadline);
+
+		uint32_t count = byte_count;
+		if (count == last_count) {
+			idle_ms += 100;
+		} else {
+			idle_ms = 0;
+			last_count = count;
 		}
+	}
+	done = capture_done;
+	pthread_mutex_unlock(&capture_lock);
 
-		// Wait for SIGALRM from interval timer, or another signal.
-		pause();
+	return done ? 0 : -1;
+}
 
-		/* Read and reset both totals at approximately the same time. */
-		byte_count_now = byte_count;
-		byte_count = 0;
+/* Captura num_bytes con el backend abierto y sintonizado */
+static int backend_capture(size_t num_bytes)
+{
+	limit_num_samples = true;
+	bytes_to_xfer = num_bytes;
+
+	pthread_mutex_lock(&capture_lock);
+	capture_done = false;
+	pthread_mutex_unlock(&capture_lock);
+	byte_count = 0;
+
+	uint64_t capture_start = perf_now_ns();
+	trace_begin("sdr", "capture");
+	if (sdr_start(backend, rx_deliver, NULL) != 0) {
+		trace_end("sdr", "capture");
+		return -1;
+	}
 
-		if (!((byte_count_now == 0))) {
-			fprintf(stderr, "[driver] Name file RDY: %d\n", i);				
-		}
+	int result = wait_capture();
+	if (result != 0) {
+		fprintf(stderr,
+			"[driver] Couldn't transfer any bytes for one second.\n");
+	}
 
-		if ((byte_count_now == 0)) {
-			fprintf(stderr,
-				"[driver] Couldn't transfer any bytes for one second.\n");
-			break;
-		}	
+	if (sdr_stop(backend) != 0) {
+		result = -1;
+	}
+	trace_end("sdr", "capture");
+	if (result == 0) {
+		perf_stats_record(PERF_STAGE_ACQUIRE, perf_now_ns() - capture_start);
+	}
+	return result;
+}
 
-		// Stop interval timer.
-		result = hackrf_is_streaming(device);
-		if (do_exit) {
-			fprintf(stderr, "Exiting...\n");
-		} else {
-			fprintf(stderr,
-				"[driver] Exiting... device_is_streaming() result: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-		}
+int getSamples(int64_t lo_freq, int64_t hi_freq)
+{
+	int result = 0;
+	uint8_t tSample = 0;
+	int64_t central_freq;
+	char path[60];
+
+	tSample = (hi_freq - lo_freq)/DEFAULT_SAMPLE_RATE_HZ;
 
-		result = hackrf_stop_rx(device);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"[driver] stop_rx() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
+	/* El radio se abre y configura una sola vez; luego solo se arranca y detiene el flujo */
+	if (open_backend() != 0) {
+		return -1;
+	}
+
+	for(uint8_t i=0; i<tSample; i++)
+	{
+		if (capture_dst != NULL) {
+			/* getSamplesInto(): rx_callback escribe en el búfer del llamador */
+		} else if (stream_size > 0) {
+			/* Modo sin disco: con el anillo vacío se reinicia para que la captura quede contigua */
+			if (__atomic_load_n(&stream_head, __ATOMIC_ACQUIRE) == stream_tail) {
+				stream_head = 0;
+				stream_tail = 0;
+			}
 		} else {
-			fprintf(stderr, "[driver] stop_rx() done\n");
-		}		
+			memset(path, 0, 20);
+			sprintf(path, "backend/Core/Samples/%d", i);
+			file = fopen(path, "wb");
 
-		if (file != NULL) {
-			if (file != stdin) {
-				fflush(file);
+			if (file == NULL) {
+				fprintf(stderr, "[driver] Failed to open file: %s\n", path);
+				return -1;
 			}
-			if ((file != stdout) && (file != stdin)) {
-				fclose(file);
-				file = NULL;
-				fprintf(stderr, "[driver] fclose() done\n");
+			/* Change file buffer to have bigger one to store or read data on/to HDD */
+			result = setvbuf(file, NULL, _IOFBF, FD_BUFFER_SIZE);
+			if (result != 0) {
+				fprintf(stderr, "[driver] setvbuf() failed: %d\n", result);
+				return -1;
 			}
 		}
 
-		result = hackrf_close(device);
-		if (result != HACKRF_SUCCESS) {
-			fprintf(stderr,
-				"[driver] device_close() failed: %s (%d)\n",
-				hackrf_error_name(result),
-				result);
-		} else {
-			fprintf(stderr, "[driver] device_close() done\n");
-		}			
+		/* Ventana i: [lo + i*fs, lo + (i+1)*fs), centrada en su mitad */
+		central_freq = lo_freq + DEFAULT_CENTRAL_FREQ_HZ + (int64_t)i * DEFAULT_SAMPLE_RATE_HZ;
+		fprintf(stderr, "[driver] central frequency: %ld\n", central_freq);
+
+		fprintf(stderr,"[driver] Start Acquisition\n");
+
+		result = sdr_configure(backend, central_freq);
+		if (result == 0) {
+			result = backend_capture(DEFAULT_SAMPLES_TO_XFER_MAX * 2ull);
+		}
+
+		if (file != NULL) {
+			fflush(file);
+			fclose(file);
+			file = NULL;
+		}
+
+		if (result != 0) {
+			/* Se reabre en la próxima llamada por si el dispositivo se perdió */
+			closeSamples();
+			return -1;
+		}
+
+		fprintf(stderr, "[driver] Name file RDY: %d\n", i);
 	}
 
-	if (device != NULL) 
-	{
-		hackrf_exit();
-		fprintf(stderr, "[driver] device_exit() done\n");
+	return 0;
+}
+
+int getSamplesInto(int64_t lo_freq, int64_t hi_freq, int8_t* dst, size_t capacity, size_t* length)
+{
+	int result;
+
+	capture_pos = 0;
+	capture_cap = capacity;
+	capture_dst = (uint8_t*)dst;
+
+	result = getSamples(lo_freq, hi_freq);
+
+	*length = capture_pos;
+	capture_dst = NULL;
+	return result;
+}
+
+int getSamplesAt(uint64_t center_freq, int8_t* dst, size_t capacity, size_t* length)
+{
+	int result;
+
+	if (open_backend() != 0) {
+		return -1;
 	}
 
-	fprintf(stderr, "[driver] exit\n");
+	capture_pos = 0;
+	capture_cap = capacity;
+	capture_dst = (uint8_t*)dst;
+
+	result = sdr_configure(backend, center_freq);
+	if (result == 0) {
+		result = backend_capture(capacity);
+	}
+
+	*length = capture_pos;
+	capture_dst = NULL;
+
+	if (result != 0) {
+		closeSamples();
+		return -1;
+	}
 	return 0;
 }
+
+int startSampleStream(uint64_t center_freq)
+{
+	if (sample_sink == NULL || open_backend() != 0) {
+		return -1;
+	}
+
+	/* Sin límite de bytes: rx_deliver entrega todo al sink hasta stopSampleStream() */
+	limit_num_samples = false;
+	bytes_to_xfer = 0;
+	byte_count = 0;
+
+	if (sdr_configure(backend, center_freq) != 0 ||
+	    sdr_start(backend, rx_deliver, NULL) != 0) {
+		limit_num_samples = true;
+		closeSamples();
+		return -1;
+	}
+	fprintf(stderr, "[driver] Streaming at %llu Hz\n", (unsigned long long)center_freq);
+	return 0;
+}
+
+uint32_t getStreamedBytes(void)
+{
+	return byte_count;
+}
+
+int stopSampleStream(void)
+{
+	int result = 0;
+
+	if (backend != NULL && sdr_stop(backend) != 0) {
+		result = -1;
+	}
+	limit_num_samples = true;
+	return result;
+}
+
+void closeSamples(void)
+{
+	if (backend != NULL) {
+		sdr_backend_destroy(backend);
+		backend = NULL;
+	}
+}
@@ -1,7 +1,11 @@
 #ifndef BACN_RF_H
 #define BACN_RF_H
 
-#include <libhackrf/hackrf.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdr_backend.h"
 
 #define DEFAULT_SAMPLE_RATE_HZ (20000000)
 
@@ -11,10 +15,36 @@
 
 #define FD_BUFFER_SIZE (8 * 1024)
 
+/* Zero-disk ring: one full capture plus one USB transfer of slack */
+#define STREAM_RING_SIZE (DEFAULT_SAMPLES_TO_XFER_MAX * 2ull + 262144)
+
+/* Receives every CS8 buffer delivered by the SDR backend (e.g. welch_stream_push_samples) */
+typedef void (*sample_sink_fn)(const int8_t* buffer, size_t length, void* user);
+
 void stop_main_loop(void);
-int rx_callback(hackrf_transfer* transfer);
 void sigint_callback_handler(int signum);
 void sigalrm_callback_handler();
+void rf_install_signal_handlers(void);
+/* Fuente de muestras de getSamples*(): hackrf, replay o synthetic */
+int select_sdr_backend(const sdr_backend_options_t* options);
 int getSamples(int64_t lo_freq, int64_t hi_freq);
+int getSamplesInto(int64_t lo_freq, int64_t hi_freq, int8_t* dst, size_t capacity, size_t* length);
+/* Sweep: sintoniza center_freq y captura hasta capacity bytes en dst */
+int getSamplesAt(uint64_t center_freq, int8_t* dst, size_t capacity, size_t* length);
+void closeSamples(void);
+
+void set_sample_sink(sample_sink_fn sink, void* user);
+/* Captura continua: sintoniza center_freq y entrega cada búfer al sink hasta stopSampleStream() */
+int startSampleStream(uint64_t center_freq);
+int stopSampleStream(void);
+/* Bytes recibidos desde startSampleStream() (se reinicia al desbordar 32 bits) */
+uint32_t getStreamedBytes(void);
+
+/* Zero-disk mode: captures go to an in-memory SPSC ring instead of Samples/N */
+int stream_init(size_t size);
+void stream_free(void);
+size_t stream_peek(const int8_t** data);
+void stream_consume(size_t length);
+uint32_t get_stream_drops(void);
 
 #endif // BACN_RF_H
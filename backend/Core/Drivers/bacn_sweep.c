@@ -0,0 +1,358 @@
+#include <libhackrf/hackrf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <math.h>
+#include <fftw3.h>
+
+#include "bacn_sweep.h"
+#include "CS8toIQ.h"
+
+#define SWEEP_FREQ_ONE_MHZ (1000000ull)
+#define SWEEP_FREQ_MAX_MHZ (7250)
+
+typedef struct {
+	int fft_size;
+	int bins;                 /* Rejilla de salida: (hi - lo) / df */
+	double df;
+	dsp_real_t scale;         /* 1 / (fs * U), igual que welch_engine */
+	dsp_real_t* window;
+	dsp_complex_t* in;
+	dsp_complex_t* out;
+	DSP_FFTW(plan) plan;
+	double* sum;              /* Barrido en curso (solo hilo USB) */
+	uint16_t* hits;
+	dsp_real_t* ready;        /* Último barrido completo, protegido por lock */
+} rf_sweep_resolution_t;
+
+struct rf_sweep {
+	rf_sweep_config_t config;
+	rf_session_t session;
+	bool session_open;
+	uint64_t lo_hz;
+	uint64_t hi_hz;
+	rf_sweep_resolution_t res[RF_SWEEP_MAX_RESOLUTIONS];
+
+	/* Estado del hilo USB */
+	bool started;
+	uint64_t last_frequency;
+	volatile bool stop;
+
+	pthread_mutex_t lock;
+	pthread_cond_t published;
+	uint64_t sequence;
+	rf_sweep_stats_t stats;
+};
+
+void rf_sweep_close(rf_sweep_t* sweep)
+{
+	if (sweep == NULL) {
+		return;
+	}
+
+	sweep->stop = true;
+	if (sweep->session_open) {
+		rf_session_stop(&sweep->session);
+		rf_session_close(&sweep->session);
+	}
+
+	for (int r = 0; r < RF_SWEEP_MAX_RESOLUTIONS; r++) {
+		rf_sweep_resolution_t* res = &sweep->res[r];
+		if (res->plan) DSP_FFTW(destroy_plan)(res->plan);
+		DSP_FFTW(free)(res->window);
+		DSP_FFTW(free)(res->in);
+		DSP_FFTW(free)(res->out);
+		free(res->sum);
+		free(res->hits);
+		free(res->ready);
+	}
+	pthread_cond_destroy(&sweep->published);
+	pthread_mutex_destroy(&sweep->lock);
+	free(sweep);
+}
+
+rf_sweep_t* rf_sweep_open(const rf_sweep_config_t* config)
+{
+	if (config == NULL || config->lo_mhz >= config->hi_mhz ||
+		config->hi_mhz > SWEEP_FREQ_MAX_MHZ ||
+		config->resolution_count < 1 || config->resolution_count > RF_SWEEP_MAX_RESOLUTIONS ||
+		config->blocks_per_hop < 1) {
+		fprintf(stderr, "[driver] Invalid sweep configuration\n");
+		return NULL;
+	}
+
+	rf_sweep_t* sweep = (rf_sweep_t*)calloc(1, sizeof(rf_sweep_t));
+	if (sweep == NULL) {
+		return NULL;
+	}
+	pthread_mutex_init(&sweep->lock, NULL);
+	pthread_cond_init(&sweep->published, NULL);
+	sweep->config = *config;
+
+	/* El firmware avanza en pasos enteros de 20 MHz */
+	uint32_t step_mhz = SWEEP_TUNE_STEP_HZ / SWEEP_FREQ_ONE_MHZ;
+	uint32_t steps = 1 + (config->hi_mhz - config->lo_mhz - 1) / step_mhz;
+	sweep->config.hi_mhz = config->lo_mhz + steps * step_mhz;
+	sweep->lo_hz = config->lo_mhz * SWEEP_FREQ_ONE_MHZ;
+	sweep->hi_hz = sweep->config.hi_mhz * SWEEP_FREQ_ONE_MHZ;
+
+	double fs = DEFAULT_SAMPLE_RATE_HZ;
+	for (int r = 0; r < config->resolution_count; r++) {
+		rf_sweep_resolution_t* res = &sweep->res[r];
+		int n = config->fft_sizes[r];
+
+		if (n < 8 || n % 8 != 0 || n > SWEEP_MAX_FFT_SIZE) {
+			fprintf(stderr, "[driver] Invalid sweep FFT size: %d\n", n);
+			rf_sweep_close(sweep);
+			return NULL;
+		}
+		res->fft_size = n;
+		res->df = fs / n;
+		res->bins = (int)(steps * (uint64_t)n);
+
+		res->window = DSP_FFTW(alloc_real)(n);
+		res->in = DSP_FFTW(alloc_complex)(n);
+		res->out = DSP_FFTW(alloc_complex)(n);
+		res->sum = (double*)calloc(res->bins, sizeof(double));
+		res->hits = (uint16_t*)calloc(res->bins, sizeof(uint16_t));
+		res->ready = (dsp_real_t*)calloc(res->bins, sizeof(dsp_real_t));
+		if (!res->window || !res->in || !res->out || !res->sum || !res->hits || !res->ready) {
+			rf_sweep_close(sweep);
+			return NULL;
+		}
+
+		double U = 0.0;
+		for (int i = 0; i < n; i++) {
+			double w = 0.54 - 0.46 * cos((2.0 * M_PI * i) / (n - 1));
+			res->window[i] = (dsp_real_t)w;
+			U += w * w;
+		}
+		U /= n;
+		res->scale = (dsp_real_t)(1.0 / (fs * U));
+
+		res->plan = DSP_FFTW(plan_dft_1d)(n, res->in, res->out, FFTW_FORWARD, FFTW_MEASURE);
+		if (res->plan == NULL) {
+			rf_sweep_close(sweep);
+			return NULL;
+		}
+	}
+
+	if (rf_session_open(&sweep->session, DEFAULT_SAMPLE_RATE_HZ) != 0) {
+		rf_sweep_close(sweep);
+		return NULL;
+	}
+	sweep->session_open = true;
+
+	fprintf(stderr, "[driver] Sweep %u-%u MHz, %u hops of %u blocks\n",
+		sweep->config.lo_mhz, sweep->config.hi_mhz, 2 * steps, config->blocks_per_hop);
+	return sweep;
+}
+
+/* Suma los N/4 bins a partir de first en la rejilla, desde la posición j */
+static void sweep_stitch(rf_sweep_resolution_t* res, int j, int first)
+{
+	const dsp_real_t* X = (const dsp_real_t*)res->out;
+	int count = res->fft_size / 4;
+
+	if (j + count > res->bins) {
+		count = res->bins - j;
+	}
+	for (int i = 0; i < count; i++) {
+		int k = first + i;
+		double power = (double)X[2 * k] * X[2 * k] + (double)X[2 * k + 1] * X[2 * k + 1];
+		res->sum[j + i] += power * res->scale;
+		res->hits[j + i]++;
+	}
+}
+
+/* FFT de las últimas N muestras de un bloque sintonizado en frequency */
+static void sweep_block(rf_sweep_t* sweep, const uint8_t* block, uint64_t quarter)
+{
+	for (int r = 0; r < sweep->config.resolution_count; r++) {
+		rf_sweep_resolution_t* res = &sweep->res[r];
+		int n = res->fft_size;
+		const int8_t* samples = (const int8_t*)(block + BYTES_PER_BLOCK - 2 * n);
+
+		cs8_to_dsp_convert(samples, 2 * (size_t)n, res->in, n);
+		for (int i = 0; i < n; i++) {
+			res->in[i] *= res->window[i];
+		}
+		DSP_FFTW(execute)(res->plan);
+
+		/* El bin 1 + 5N/8 cae en f + df: la rejilla empieza en lo + df */
+		int j = (int)(quarter * (n / 4));
+		sweep_stitch(res, j, 1 + (5 * n) / 8);
+		sweep_stitch(res, j + n / 2, 1 + n / 8);
+	}
+}
+
+/* Barrido completo: se copia al búfer publicado y se reinicia la suma */
+static void sweep_publish(rf_sweep_t* sweep)
+{
+	pthread_mutex_lock(&sweep->lock);
+	for (int r = 0; r < sweep->config.resolution_count; r++) {
+		rf_sweep_resolution_t* res = &sweep->res[r];
+		for (int j = 0; j < res->bins; j++) {
+			/* Un bloque perdido deja el valor del barrido anterior */
+			if (res->hits[j] > 0) {
+				res->ready[j] = (dsp_real_t)(res->sum[j] / res->hits[j]);
+			}
+		}
+		memset(res->sum, 0, res->bins * sizeof(double));
+		memset(res->hits, 0, res->bins * sizeof(uint16_t));
+	}
+	sweep->sequence++;
+	sweep->stats.sweeps++;
+	pthread_cond_broadcast(&sweep->published);
+	pthread_mutex_unlock(&sweep->lock);
+}
+
+static int sweep_callback(hackrf_transfer* transfer)
+{
+	rf_sweep_t* sweep = (rf_sweep_t*)transfer->rx_ctx;
+	uint64_t quarter_hz = DEFAULT_SAMPLE_RATE_HZ / 4;
+	uint64_t blocks = 0;
+	uint64_t bad_blocks = 0;
+
+	if (sweep->stop) {
+		return -1;
+	}
+
+	for (int offset = 0; offset + BYTES_PER_BLOCK <= transfer->valid_length; offset += BYTES_PER_BLOCK) {
+		const uint8_t* buf = transfer->buffer + offset;
+
+		if (buf[0] != 0x7f || buf[1] != 0x7f) {
+			bad_blocks++;
+			continue;
+		}
+		uint64_t frequency = 0;
+		for (int i = 7; i >= 0; i--) {
+			frequency = (frequency << 8) | buf[2 + i];
+		}
+		blocks++;
+
+		/* Vuelta al primer salto: termina el barrido anterior */
+		if (frequency == sweep->lo_hz && sweep->last_frequency != sweep->lo_hz) {
+			if (sweep->started) {
+				sweep_publish(sweep);
+			}
+			sweep->started = true;
+		}
+		sweep->last_frequency = frequency;
+
+		if (!sweep->started || frequency < sweep->lo_hz || frequency >= sweep->hi_hz ||
+			(frequency - sweep->lo_hz) % quarter_hz != 0) {
+			continue;
+		}
+		sweep_block(sweep, buf, (frequency - sweep->lo_hz) / quarter_hz);
+	}
+
+	pthread_mutex_lock(&sweep->lock);
+	sweep->stats.blocks += blocks;
+	sweep->stats.bad_blocks += bad_blocks;
+	pthread_mutex_unlock(&sweep->lock);
+	return 0;
+}
+
+int rf_sweep_start(rf_sweep_t* sweep)
+{
+	int result;
+	uint16_t frequencies[2] = { sweep->config.lo_mhz, sweep->config.hi_mhz };
+	hackrf_device* device = sweep->session.device;
+
+	if (sweep->session.streaming) {
+		return 0;
+	}
+
+	result = hackrf_set_baseband_filter_bandwidth(device,
+		hackrf_compute_baseband_filter_bw(SWEEP_BASEBAND_FILTER_HZ));
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_set_baseband_filter_bandwidth() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		return -1;
+	}
+
+	result = hackrf_init_sweep(device, frequencies, 1,
+		sweep->config.blocks_per_hop * BYTES_PER_BLOCK,
+		SWEEP_TUNE_STEP_HZ, SWEEP_LO_OFFSET_HZ, INTERLEAVED);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_init_sweep() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		return -1;
+	}
+
+	sweep->started = false;
+	sweep->last_frequency = 0;
+	sweep->stop = false;
+
+	result = hackrf_start_rx_sweep(device, sweep_callback, sweep);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_start_rx_sweep() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		return -1;
+	}
+	sweep->session.streaming = true;
+	return 0;
+}
+
+/*
+ * Espera un barrido más nuevo que last_sequence. Devuelve -1 si en un
+ * segundo no se publica ninguno (dispositivo parado o perdido).
+ */
+int rf_sweep_wait(rf_sweep_t* sweep, uint64_t last_sequence, uint64_t* sequence)
+{
+	struct timespec deadline;
+	int result = 0;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += 1;
+
+	pthread_mutex_lock(&sweep->lock);
+	while (sweep->sequence <= last_sequence && result == 0) {
+		result = pthread_cond_timedwait(&sweep->published, &sweep->lock, &deadline);
+	}
+	*sequence = sweep->sequence;
+	pthread_mutex_unlock(&sweep->lock);
+
+	return (*sequence > last_sequence) ? 0 : -1;
+}
+
+int rf_sweep_result(rf_sweep_t* sweep, int resolution, double* f_mhz, dsp_real_t* P_out)
+{
+	if (resolution < 0 || resolution >= sweep->config.resolution_count) {
+		return -1;
+	}
+	rf_sweep_resolution_t* res = &sweep->res[resolution];
+
+	pthread_mutex_lock(&sweep->lock);
+	memcpy(P_out, res->ready, res->bins * sizeof(dsp_real_t));
+	pthread_mutex_unlock(&sweep->lock);
+
+	if (f_mhz != NULL) {
+		for (int j = 0; j < res->bins; j++) {
+			f_mhz[j] = (sweep->lo_hz + (j + 1) * res->df) / 1e6;
+		}
+	}
+	return 0;
+}
+
+int rf_sweep_bin_count(const rf_sweep_t* sweep, int resolution)
+{
+	return sweep->res[resolution].bins;
+}
+
+void rf_sweep_get_stats(rf_sweep_t* sweep, rf_sweep_stats_t* stats)
+{
+	pthread_mutex_lock(&sweep->lock);
+	*stats = sweep->stats;
+	pthread_mutex_unlock(&sweep->lock);
+}
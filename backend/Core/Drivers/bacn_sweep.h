@@ -0,0 +1,67 @@
+#ifndef BACN_SWEEP_H
+#define BACN_SWEEP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <libhackrf/hackrf.h>
+
+#include "bacn_RF.h"
+#include "sdr_hackrf.h"
+#include "dsp_precision.h"
+
+/*
+ * Barrido por firmware (hackrf_init_sweep / hackrf_start_rx_sweep).
+ *
+ * El HackRF salta el LO en hardware en pasos de 20 MHz, intercalando un
+ * segundo salto desplazado fs/4, y entrega bloques de BYTES_PER_BLOCK con una
+ * cabecera 0x7f 0x7f + frecuencia (uint64 LE). De cada bloque se transforman
+ * las últimas N muestras (las primeras pueden caer en el transitorio del
+ * salto) y se conservan dos cuartos de banda lejos del DC y de los bordes:
+ *
+ *   bins [1 + 5N/8, +N/4)  ->  f        .. f + fs/4
+ *   bins [1 + N/8,  +N/4)  ->  f + fs/2 .. f + 3fs/4
+ *
+ * Los bins se cosen en una rejilla fija [lo, hi) con la misma escala de
+ * densidad que welch_engine, así el umbral y el JSON no cambian de unidades.
+ * Cada barrido completo se publica para el hilo de análisis.
+ */
+
+#define SWEEP_TUNE_STEP_HZ (DEFAULT_SAMPLE_RATE_HZ)
+
+#define SWEEP_LO_OFFSET_HZ (DEFAULT_SAMPLE_RATE_HZ / 8 * 3)
+
+#define SWEEP_BASEBAND_FILTER_HZ (15000000)
+
+#define SWEEP_BLOCK_HEADER_BYTES (10)
+
+/* Muestras útiles por bloque tras la cabecera */
+#define SWEEP_MAX_FFT_SIZE ((BYTES_PER_BLOCK - SWEEP_BLOCK_HEADER_BYTES) / 2)
+
+#define RF_SWEEP_MAX_RESOLUTIONS 2
+
+typedef struct {
+	uint16_t lo_mhz;        /* Inicio del barrido */
+	uint16_t hi_mhz;        /* Fin; se redondea hacia arriba a pasos de 20 MHz */
+	int fft_sizes[RF_SWEEP_MAX_RESOLUTIONS];  /* Múltiplos de 8, <= SWEEP_MAX_FFT_SIZE */
+	int resolution_count;
+	uint32_t blocks_per_hop;  /* Bloques promediados por salto (>= 1) */
+} rf_sweep_config_t;
+
+typedef struct {
+	uint64_t sweeps;        /* Barridos completos publicados */
+	uint64_t blocks;        /* Bloques con cabecera válida */
+	uint64_t bad_blocks;    /* Bloques sin cabecera */
+} rf_sweep_stats_t;
+
+typedef struct rf_sweep rf_sweep_t;
+
+rf_sweep_t* rf_sweep_open(const rf_sweep_config_t* config);
+int rf_sweep_start(rf_sweep_t* sweep);
+int rf_sweep_wait(rf_sweep_t* sweep, uint64_t last_sequence, uint64_t* sequence);
+int rf_sweep_result(rf_sweep_t* sweep, int resolution, double* f_mhz, dsp_real_t* P_out);
+int rf_sweep_bin_count(const rf_sweep_t* sweep, int resolution);
+void rf_sweep_get_stats(rf_sweep_t* sweep, rf_sweep_stats_t* stats);
+void rf_sweep_close(rf_sweep_t* sweep);
+
+#endif // BACN_SWEEP_H
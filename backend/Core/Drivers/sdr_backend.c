@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sdr_backend.h"
+#include "trace.h"
+
+sdr_backend_t* sdr_backend_create(const sdr_backend_options_t* options)
+{
+	const sdr_backend_ops_t* ops = NULL;
+
+	switch (options->kind) {
+	case SDR_BACKEND_HACKRF:
+#ifdef HAVE_HACKRF
+		ops = sdr_hackrf_ops();
+#endif
+		break;
+	case SDR_BACKEND_REPLAY:
+		ops = sdr_replay_ops();
+		break;
+	case SDR_BACKEND_SYNTHETIC:
+		ops = sdr_synthetic_ops();
+		break;
+	}
+	if (ops == NULL) {
+		fprintf(stderr, "[driver] SDR backend %d not available in this build\n", options->kind);
+		return NULL;
+	}
+	if (options->kind == SDR_BACKEND_REPLAY && options->replay_path == NULL) {
+		fprintf(stderr, "[driver] Replay backend needs a CS8 file\n");
+		return NULL;
+	}
+	if (options->rate < 0.0) {
+		fprintf(stderr, "[driver] Invalid replay rate: %f\n", options->rate);
+		return NULL;
+	}
+
+	sdr_backend_t* backend = (sdr_backend_t*)calloc(1, sizeof(sdr_backend_t));
+	if (backend == NULL) {
+		return NULL;
+	}
+	backend->ops = ops;
+	backend->options = *options;
+	return backend;
+}
+
+void sdr_backend_destroy(sdr_backend_t* backend)
+{
+	if (backend == NULL) {
+		return;
+	}
+	sdr_close(backend);
+	free(backend);
+}
+
+int sdr_backend_parse_kind(const char* name, sdr_backend_kind_t* kind)
+{
+	if (strcmp(name, "hackrf") == 0) {
+		*kind = SDR_BACKEND_HACKRF;
+	} else if (strcmp(name, "replay") == 0) {
+		*kind = SDR_BACKEND_REPLAY;
+	} else if (strcmp(name, "synthetic") == 0) {
+		*kind = SDR_BACKEND_SYNTHETIC;
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
+const char* sdr_backend_name(const sdr_backend_t* backend)
+{
+	return backend->ops->name;
+}
+
+int sdr_open(sdr_backend_t* backend, uint32_t sample_rate)
+{
+	if (backend->is_open) {
+		return 0;
+	}
+	if (backend->ops->open(backend, sample_rate) != 0) {
+		return -1;
+	}
+	backend->sample_rate = sample_rate;
+	backend->center_freq = 0;
+	backend->is_open = true;
+	fprintf(stderr, "[driver] %s backend open at %u S/s\n", backend->ops->name, sample_rate);
+	return 0;
+}
+
+int sdr_configure(sdr_backend_t* backend, uint64_t center_freq)
+{
+	if (!backend->is_open) {
+		return -1;
+	}
+	if (backend->center_freq == center_freq) {
+		return 0;
+	}
+	if (backend->ops->configure(backend, center_freq) != 0) {
+		return -1;
+	}
+	backend->center_freq = center_freq;
+	return 0;
+}
+
+int sdr_start(sdr_backend_t* backend, sdr_rx_fn callback, void* user)
+{
+	if (!backend->is_open) {
+		return -1;
+	}
+	if (backend->streaming) {
+		return 0;
+	}
+	if (backend->ops->start(backend, callback, user) != 0) {
+		return -1;
+	}
+	backend->streaming = true;
+	return 0;
+}
+
+int sdr_stop(sdr_backend_t* backend)
+{
+	if (!backend->streaming) {
+		return 0;
+	}
+	backend->streaming = false;
+	return backend->ops->stop(backend);
+}
+
+void sdr_close(sdr_backend_t* backend)
+{
+	if (!backend->is_open) {
+		return;
+	}
+	sdr_stop(backend);
+	backend->ops->close(backend);
+	backend->is_open = false;
+}
+
+static void* sdr_feeder_main(void* arg)
+{
+	sdr_feeder_t* feeder = (sdr_feeder_t*)arg;
+	sdr_backend_t* backend = feeder->backend;
+	double rate = backend->options.rate;
+	struct timespec deadline;
+
+	/* Tiempo que tarda un bloque en llegar al ritmo pedido */
+	long long period_ns = 0;
+	if (rate > 0.0) {
+		period_ns = (long long)((SDR_FEEDER_CHUNK / 2) * 1e9 / (backend->sample_rate * rate));
+	}
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	trace_thread_name("sdr feeder");
+
+	while (feeder->run) {
+		if (period_ns > 0) {
+			deadline.tv_nsec += period_ns;
+			while (deadline.tv_nsec >= 1000000000L) {
+				deadline.tv_sec++;
+				deadline.tv_nsec -= 1000000000L;
+			}
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+		}
+		if (!feeder->run) {
+			break;
+		}
+		trace_begin("sdr", "fill");
+		int result = feeder->fill(backend, feeder->buffer, SDR_FEEDER_CHUNK);
+		trace_end("sdr", "fill");
+		if (result != 0) {
+			break;
+		}
+		if (feeder->callback(feeder->buffer, SDR_FEEDER_CHUNK, feeder->user) != 0) {
+			break;
+		}
+	}
+	return NULL;
+}
+
+int sdr_feeder_start(sdr_feeder_t* feeder, sdr_backend_t* backend, sdr_fill_fn fill,
+	sdr_rx_fn callback, void* user)
+{
+	if (feeder->buffer == NULL) {
+		feeder->buffer = (uint8_t*)malloc(SDR_FEEDER_CHUNK);
+		if (feeder->buffer == NULL) {
+			return -1;
+		}
+	}
+	feeder->backend = backend;
+	feeder->fill = fill;
+	feeder->callback = callback;
+	feeder->user = user;
+	feeder->run = true;
+
+	if (pthread_create(&feeder->thread, NULL, sdr_feeder_main, feeder) != 0) {
+		feeder->run = false;
+		return -1;
+	}
+	feeder->active = true;
+	return 0;
+}
+
+int sdr_feeder_stop(sdr_feeder_t* feeder)
+{
+	if (feeder->active) {
+		feeder->run = false;
+		pthread_join(feeder->thread, NULL);
+		feeder->active = false;
+	}
+	return 0;
+}
@@ -0,0 +1,100 @@
+#ifndef SDR_BACKEND_H
+#define SDR_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/*
+ * Interfaz común de fuentes de muestras CS8.
+ *
+ * Cada backend abre su fuente, se sintoniza, y entrega búferes a un callback
+ * desde su propio hilo hasta que el callback devuelve distinto de cero o se
+ * llama a stop. getSamples() y el resto de bacn_RF solo hablan con esta
+ * interfaz, así el modo tiempo real corre igual con un HackRF, con una
+ * captura reproducida o con señales sintéticas.
+ */
+
+/* Recibe length bytes CS8 intercalados; distinto de cero detiene el flujo */
+typedef int (*sdr_rx_fn)(const uint8_t* buffer, size_t length, void* user);
+
+typedef enum {
+	SDR_BACKEND_HACKRF = 0,     /* HackRF One vía libhackrf */
+	SDR_BACKEND_REPLAY = 1,     /* Captura CS8 en disco, reproducida con ritmo */
+	SDR_BACKEND_SYNTHETIC = 2   /* Escena FM generada (rf_scene) */
+} sdr_backend_kind_t;
+
+typedef struct {
+	sdr_backend_kind_t kind;
+	const char* replay_path;    /* Archivo CS8 (REPLAY) */
+	double rate;                /* 1.0 tiempo real, N = N veces más rápido, 0 sin espera */
+	bool loop;                  /* REPLAY: volver al inicio al llegar al final */
+	uint32_t seed;              /* SYNTHETIC: semilla de la escena */
+	const char* scene_bands_path;  /* SYNTHETIC: canalización CSV; NULL solo ruido */
+} sdr_backend_options_t;
+
+typedef struct sdr_backend sdr_backend_t;
+
+typedef struct {
+	const char* name;
+	int (*open)(sdr_backend_t* backend, uint32_t sample_rate);
+	int (*configure)(sdr_backend_t* backend, uint64_t center_freq);
+	int (*start)(sdr_backend_t* backend, sdr_rx_fn callback, void* user);
+	int (*stop)(sdr_backend_t* backend);
+	void (*close)(sdr_backend_t* backend);
+} sdr_backend_ops_t;
+
+struct sdr_backend {
+	const sdr_backend_ops_t* ops;
+	sdr_backend_options_t options;
+	uint32_t sample_rate;
+	uint64_t center_freq;
+	bool is_open;
+	bool streaming;
+	void* priv;                 /* Estado propio del backend */
+};
+
+sdr_backend_t* sdr_backend_create(const sdr_backend_options_t* options);
+void sdr_backend_destroy(sdr_backend_t* backend);
+int sdr_backend_parse_kind(const char* name, sdr_backend_kind_t* kind);
+const char* sdr_backend_name(const sdr_backend_t* backend);
+
+int sdr_open(sdr_backend_t* backend, uint32_t sample_rate);
+int sdr_configure(sdr_backend_t* backend, uint64_t center_freq);
+int sdr_start(sdr_backend_t* backend, sdr_rx_fn callback, void* user);
+int sdr_stop(sdr_backend_t* backend);
+void sdr_close(sdr_backend_t* backend);
+
+/* Implementaciones (una por archivo sdr_*.c) */
+#ifdef HAVE_HACKRF
+const sdr_backend_ops_t* sdr_hackrf_ops(void);
+#endif
+const sdr_backend_ops_t* sdr_replay_ops(void);
+const sdr_backend_ops_t* sdr_synthetic_ops(void);
+
+/*
+ * Hilo productor para backends por software: llama a fill() para cada
+ * bloque de SDR_FEEDER_CHUNK bytes y lo entrega al callback, esperando entre
+ * bloques lo que duraría su transferencia a sample_rate * rate.
+ */
+#define SDR_FEEDER_CHUNK (262144)
+
+typedef int (*sdr_fill_fn)(sdr_backend_t* backend, uint8_t* buffer, size_t length);
+
+typedef struct {
+	pthread_t thread;
+	volatile bool run;
+	bool active;
+	sdr_backend_t* backend;
+	sdr_fill_fn fill;
+	sdr_rx_fn callback;
+	void* user;
+	uint8_t* buffer;
+} sdr_feeder_t;
+
+int sdr_feeder_start(sdr_feeder_t* feeder, sdr_backend_t* backend, sdr_fill_fn fill,
+	sdr_rx_fn callback, void* user);
+int sdr_feeder_stop(sdr_feeder_t* feeder);
+
+#endif // SDR_BACKEND_H
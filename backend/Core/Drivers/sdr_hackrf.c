@@ -0,0 +1,229 @@
+#include <libhackrf/hackrf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bacn_RF.h"
+#include "sdr_hackrf.h"
+
+int rf_session_open(rf_session_t* session, uint32_t sample_rate)
+{
+	int result;
+
+	memset(session, 0, sizeof(*session));
+	session->sample_rate = sample_rate;
+
+	result = hackrf_init();
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_init() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		return -1;
+	}
+
+	// Configura manejadores de señales
+	rf_install_signal_handlers();
+
+	result = hackrf_open(&session->device);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_open() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		session->device = NULL;
+		hackrf_exit();
+		return -1;
+	}
+
+	result = hackrf_set_sample_rate(session->device, sample_rate);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_set_sample_rate() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		rf_session_close(session);
+		return -1;
+	}
+
+	result = hackrf_set_hw_sync_mode(session->device, 0);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_set_hw_sync_mode() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		rf_session_close(session);
+		return -1;
+	}
+
+	result = hackrf_set_vga_gain(session->device, session->vga_gain);
+	result |= hackrf_set_lna_gain(session->device, session->lna_gain);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr, "[driver] Failed to set gains\n");
+		rf_session_close(session);
+		return -1;
+	}
+
+	fprintf(stderr, "[driver] Device initialized\r\n");
+	return 0;
+}
+
+int rf_session_set_freq(rf_session_t* session, uint64_t freq_hz)
+{
+	int result;
+
+	if (session->device == NULL) {
+		return -1;
+	}
+	if (session->center_freq == freq_hz) {
+		return 0;
+	}
+
+	/* Se puede resintonizar con el flujo activo */
+	result = hackrf_set_freq(session->device, freq_hz);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_set_freq() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		return -1;
+	}
+	session->center_freq = freq_hz;
+	return 0;
+}
+
+int rf_session_start_rx(rf_session_t* session, hackrf_sample_block_cb_fn callback, void* rx_ctx)
+{
+	int result;
+
+	if (session->device == NULL) {
+		return -1;
+	}
+	if (session->streaming) {
+		return 0;
+	}
+
+	result = hackrf_start_rx(session->device, callback, rx_ctx);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] hackrf_start_rx() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		return -1;
+	}
+	session->streaming = true;
+	return 0;
+}
+
+int rf_session_stop(rf_session_t* session)
+{
+	int result;
+
+	if (session->device == NULL || !session->streaming) {
+		return 0;
+	}
+
+	result = hackrf_stop_rx(session->device);
+	session->streaming = false;
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] stop_rx() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+		return -1;
+	}
+	return 0;
+}
+
+void rf_session_close(rf_session_t* session)
+{
+	int result;
+
+	if (session->device == NULL) {
+		return;
+	}
+
+	rf_session_stop(session);
+
+	result = hackrf_close(session->device);
+	if (result != HACKRF_SUCCESS) {
+		fprintf(stderr,
+			"[driver] device_close() failed: %s (%d)\n",
+			hackrf_error_name(result),
+			result);
+	} else {
+		fprintf(stderr, "[driver] device_close() done\n");
+	}
+	session->device = NULL;
+
+	hackrf_exit();
+	fprintf(stderr, "[driver] device_exit() done\n");
+}
+
+/* Adaptador sdr_backend: reenvía cada transferencia al callback genérico */
+typedef struct {
+	rf_session_t session;
+	sdr_rx_fn callback;
+	void* user;
+} hackrf_backend_t;
+
+static int hackrf_backend_rx(hackrf_transfer* transfer)
+{
+	hackrf_backend_t* hb = (hackrf_backend_t*)transfer->rx_ctx;
+	return hb->callback(transfer->buffer, transfer->valid_length, hb->user);
+}
+
+static int hackrf_backend_open(sdr_backend_t* backend, uint32_t sample_rate)
+{
+	hackrf_backend_t* hb = (hackrf_backend_t*)calloc(1, sizeof(hackrf_backend_t));
+	if (hb == NULL) {
+		return -1;
+	}
+	if (rf_session_open(&hb->session, sample_rate) != 0) {
+		free(hb);
+		return -1;
+	}
+	backend->priv = hb;
+	return 0;
+}
+
+static int hackrf_backend_configure(sdr_backend_t* backend, uint64_t center_freq)
+{
+	hackrf_backend_t* hb = (hackrf_backend_t*)backend->priv;
+	return rf_session_set_freq(&hb->session, center_freq);
+}
+
+static int hackrf_backend_start(sdr_backend_t* backend, sdr_rx_fn callback, void* user)
+{
+	hackrf_backend_t* hb = (hackrf_backend_t*)backend->priv;
+	hb->callback = callback;
+	hb->user = user;
+	return rf_session_start_rx(&hb->session, hackrf_backend_rx, hb);
+}
+
+static int hackrf_backend_stop(sdr_backend_t* backend)
+{
+	hackrf_backend_t* hb = (hackrf_backend_t*)backend->priv;
+	return rf_session_stop(&hb->session);
+}
+
+static void hackrf_backend_close(sdr_backend_t* backend)
+{
+	hackrf_backend_t* hb = (hackrf_backend_t*)backend->priv;
+	rf_session_close(&hb->session);
+	free(hb);
+	backend->priv = NULL;
+}
+
+static const sdr_backend_ops_t hackrf_backend_ops = {
+	.name = "hackrf",
+	.open = hackrf_backend_open,
+	.configure = hackrf_backend_configure,
+	.start = hackrf_backend_start,
+	.stop = hackrf_backend_stop,
+	.close = hackrf_backend_close
+};
+
+const sdr_backend_ops_t* sdr_hackrf_ops(void)
+{
+	return &hackrf_backend_ops;
+}
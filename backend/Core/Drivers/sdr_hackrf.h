@@ -0,0 +1,26 @@
+#ifndef SDR_HACKRF_H
+#define SDR_HACKRF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <libhackrf/hackrf.h>
+
+#include "sdr_backend.h"
+
+/* Radio abierto y configurado una vez, reutilizado entre capturas */
+typedef struct {
+	hackrf_device* device;
+	uint32_t sample_rate;
+	uint64_t center_freq;   /* 0 hasta la primera sintonía */
+	uint32_t lna_gain;
+	uint32_t vga_gain;
+	bool streaming;
+} rf_session_t;
+
+int rf_session_open(rf_session_t* session, uint32_t sample_rate);
+int rf_session_set_freq(rf_session_t* session, uint64_t freq_hz);
+int rf_session_start_rx(rf_session_t* session, hackrf_sample_block_cb_fn callback, void* rx_ctx);
+int rf_session_stop(rf_session_t* session);
+void rf_session_close(rf_session_t* session);
+
+#endif // SDR_HACKRF_H
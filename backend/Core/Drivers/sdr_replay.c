@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sdr_backend.h"
+
+/*
+ * Reproduce una captura CS8 como si llegara del radio. El ritmo lo marca
+ * options.rate (1.0 tiempo real, N veces más rápido, 0 sin espera); la
+ * sintonía se acepta pero no cambia los datos.
+ */
+
+typedef struct {
+	FILE* file;
+	sdr_feeder_t feeder;
+} replay_backend_t;
+
+static int replay_fill(sdr_backend_t* backend, uint8_t* buffer, size_t length)
+{
+	replay_backend_t* rb = (replay_backend_t*)backend->priv;
+	size_t filled = 0;
+
+	while (filled < length) {
+		size_t n = fread(buffer + filled, 1, length - filled, rb->file);
+		filled += n;
+		if (filled == length) {
+			break;
+		}
+		if (ferror(rb->file) || !backend->options.loop) {
+			return -1;
+		}
+		/* Fin de archivo: vuelve al inicio */
+		if (n == 0 && ftell(rb->file) == 0) {
+			return -1;
+		}
+		rewind(rb->file);
+	}
+	return 0;
+}
+
+static int replay_open(sdr_backend_t* backend, uint32_t sample_rate)
+{
+	(void)sample_rate;
+	replay_backend_t* rb = (replay_backend_t*)calloc(1, sizeof(replay_backend_t));
+	if (rb == NULL) {
+		return -1;
+	}
+
+	rb->file = fopen(backend->options.replay_path, "rb");
+	if (rb->file == NULL) {
+		fprintf(stderr, "[driver] Failed to open replay file: %s\n", backend->options.replay_path);
+		free(rb);
+		return -1;
+	}
+	backend->priv = rb;
+
+	if (backend->options.rate > 0.0) {
+		fprintf(stderr, "[driver] Replaying %s at %.2fx real time\n",
+			backend->options.replay_path, backend->options.rate);
+	} else {
+		fprintf(stderr, "[driver] Replaying %s as fast as possible\n", backend->options.replay_path);
+	}
+	return 0;
+}
+
+static int replay_configure(sdr_backend_t* backend, uint64_t center_freq)
+{
+	(void)backend;
+	(void)center_freq;
+	return 0;
+}
+
+static int replay_start(sdr_backend_t* backend, sdr_rx_fn callback, void* user)
+{
+	replay_backend_t* rb = (replay_backend_t*)backend->priv;
+	return sdr_feeder_start(&rb->feeder, backend, replay_fill, callback, user);
+}
+
+static int replay_stop(sdr_backend_t* backend)
+{
+	replay_backend_t* rb = (replay_backend_t*)backend->priv;
+	return sdr_feeder_stop(&rb->feeder);
+}
+
+static void replay_close(sdr_backend_t* backend)
+{
+	replay_backend_t* rb = (replay_backend_t*)backend->priv;
+
+	sdr_feeder_stop(&rb->feeder);
+	free(rb->feeder.buffer);
+	fclose(rb->file);
+	free(rb);
+	backend->priv = NULL;
+}
+
+static const sdr_backend_ops_t replay_backend_ops = {
+	.name = "replay",
+	.open = replay_open,
+	.configure = replay_configure,
+	.start = replay_start,
+	.stop = replay_stop,
+	.close = replay_close
+};
+
+const sdr_backend_ops_t* sdr_replay_ops(void)
+{
+	return &replay_backend_ops;
+}
@@ -13,10 +13,12 @@
  * Key features:
  * - Memory mapping for efficient I/O on supported platforms
  * - Block processing for handling large files
+ * - SIMD conversion kernels selected at startup (see CS8toIQ_simd.c)
  * - Robust error handling and parameter validation
  * - Cross-platform compatibility (Windows/POSIX)
  */
 #include "CS8toIQ.h"
+#include "CS8toIQ_simd.h"
 
 
 #ifdef _WIN32
@@ -96,14 +98,71 @@ int cs8_to_iq_convert(const int8_t* raw_data, size_t size_bytes,
         num_samples = max_samples;  // Limit to buffer size
     }
     
-    for (size_t i = 0; i < num_samples; i++) {
-        // Create complex sample: real (I) + imaginary (Q)
-        output_buffer[i] = raw_data[2 * i] + raw_data[2 * i + 1] * I;
-    }
+    // Real (I) and imaginary (Q) parts map 1:1 onto the interleaved bytes
+    cs8_iq_get_kernels()->to_cdouble(raw_data, output_buffer, num_samples);
     
     return (int)num_samples;
 }
 
+/**
+ * @brief Convert raw CS8 data to single-precision IQ format
+ *
+ * @param raw_data Input CS8 buffer containing interleaved I/Q samples
+ * @param size_bytes Size in bytes of raw_data (must be even)
+ * @param output_buffer Output buffer for complex float samples
+ * @param max_samples Maximum capacity of output_buffer in complex samples
+ * @return Number of complex samples converted, or negative error code
+ */
+int cs8_to_iq_convert_f(const int8_t* raw_data, size_t size_bytes,
+                        complex float* output_buffer, size_t max_samples) {
+    if (!raw_data || !output_buffer || size_bytes % 2 != 0) {
+        return CS8_IQ_ERROR_PARAM;
+    }
+
+    size_t num_samples = size_bytes / 2;
+    if (num_samples > max_samples) {
+        num_samples = max_samples;
+    }
+
+    cs8_iq_get_kernels()->to_cfloat(raw_data, output_buffer, num_samples);
+
+    return (int)num_samples;
+}
+
+/**
+ * @brief Widen raw CS8 data to interleaved int16 I/Q pairs
+ *
+ * @param raw_data Input CS8 buffer containing interleaved I/Q samples
+ * @param size_bytes Size in bytes of raw_data (must be even)
+ * @param output_buffer Output buffer (2 * max_samples int16 values)
+ * @param max_samples Maximum capacity of output_buffer in I/Q pairs
+ * @return Number of I/Q pairs converted, or negative error code
+ */
+int cs8_to_iq_convert_s16(const int8_t* raw_data, size_t size_bytes,
+                          int16_t* output_buffer, size_t max_samples) {
+    if (!raw_data || !output_buffer || size_bytes % 2 != 0) {
+        return CS8_IQ_ERROR_PARAM;
+    }
+
+    size_t num_samples = size_bytes / 2;
+    if (num_samples > max_samples) {
+        num_samples = max_samples;
+    }
+
+    cs8_iq_get_kernels()->to_s16(raw_data, output_buffer, num_samples);
+
+    return (int)num_samples;
+}
+
+/**
+ * @brief Name of the conversion kernel selected at startup
+ *
+ * @return Static ISA label of the active kernel table
+ */
+const char* cs8_iq_kernel_name(void) {
+    return cs8_iq_get_kernels()->name;
+}
+
 /**
  * @brief Initialize a context for block processing
  *
@@ -192,6 +251,32 @@ int cs8_iq_init_context(CS8_IQ_Context* ctx, const char* filename, bool use_mmap
     return CS8_IQ_SUCCESS;
 }
 
+/**
+ * @brief Initialize a context over CS8 bytes already in memory
+ *
+ * The context behaves like a memory-mapped capture: readers access the
+ * buffer in place and cs8_iq_close_context() leaves it untouched.
+ *
+ * @param ctx Context structure to initialize
+ * @param data Interleaved I/Q bytes (2 * num_samples bytes)
+ * @param num_samples Number of I/Q pairs
+ * @return CS8_IQ_SUCCESS on success, negative error code otherwise
+ */
+int cs8_iq_init_memory_context(CS8_IQ_Context* ctx, const int8_t* data, size_t num_samples) {
+    if (!ctx || !data) {
+        return CS8_IQ_ERROR_PARAM;
+    }
+
+    memset(ctx, 0, sizeof(CS8_IQ_Context));
+    ctx->mapped_memory = (void*)data;
+    ctx->file_size = 2 * num_samples;
+    ctx->use_mmap = true;
+    ctx->borrowed = true;
+    ctx->error_code = CS8_IQ_SUCCESS;
+
+    return CS8_IQ_SUCCESS;
+}
+
 /**
  * @brief Process a block of data from the context
  *
@@ -235,14 +320,9 @@ int cs8_iq_process_block(CS8_IQ_Context* ctx, complex double* output_buffer,
     int result;
     
     if (ctx->use_mmap) {
-#if USE_MMAP
-        // Access mapped memory directly
+        // Access mapped (or caller-provided) memory directly
         const int8_t* data_ptr = (const int8_t*)ctx->mapped_memory + ctx->processed_bytes;
         result = cs8_to_iq_convert(data_ptr, bytes_to_process, output_buffer, max_samples);
-#else
-        // Should not reach here if USE_MMAP is disabled
-        return CS8_IQ_ERROR_PARAM;
-#endif
     } else {
         // Read a block from the file
         int8_t* buffer = (int8_t*)malloc(bytes_to_process);
@@ -269,6 +349,74 @@ int cs8_iq_process_block(CS8_IQ_Context* ctx, complex double* output_buffer,
     }
 }
 
+/**
+ * @brief Copy the next block of raw CS8 bytes from the context
+ *
+ * Same bookkeeping as cs8_iq_process_block, but leaves the interleaved
+ * bytes untouched so the caller decides where and how to convert them.
+ *
+ * @param ctx Initialized processing context
+ * @param dst Destination buffer for the raw bytes
+ * @param max_samples Maximum number of I/Q pairs to copy
+ * @param samples_read Updated with the actual number of pairs copied
+ * @return 0 on success with more data available, 1 at EOF, negative on error
+ */
+int cs8_iq_read_raw(CS8_IQ_Context* ctx, int8_t* dst,
+                    size_t max_samples, size_t* samples_read) {
+    if (!ctx || !dst || !samples_read || max_samples == 0) {
+        return CS8_IQ_ERROR_PARAM;
+    }
+
+    *samples_read = 0;
+
+    if (ctx->processed_bytes >= ctx->file_size) {
+        return 1;  // End of file indicator
+    }
+
+    size_t remaining_bytes = ctx->file_size - ctx->processed_bytes;
+    size_t bytes_to_copy = max_samples * 2;
+
+    if (bytes_to_copy > remaining_bytes) {
+        bytes_to_copy = remaining_bytes;
+    }
+    bytes_to_copy &= ~1UL;
+
+    if (bytes_to_copy == 0) {
+        return 1;
+    }
+
+    if (ctx->use_mmap) {
+        memcpy(dst, (const int8_t*)ctx->mapped_memory + ctx->processed_bytes, bytes_to_copy);
+    } else {
+        if (fread(dst, 1, bytes_to_copy, ctx->file) != bytes_to_copy) {
+            return CS8_IQ_ERROR_READ;
+        }
+    }
+
+    ctx->processed_bytes += bytes_to_copy;
+    *samples_read = bytes_to_copy / 2;
+    return (ctx->processed_bytes >= ctx->file_size) ? 1 : 0;
+}
+
+/**
+ * @brief Reset a processing context to the beginning of its data
+ *
+ * @param ctx Initialized processing context
+ * @return CS8_IQ_SUCCESS on success, negative error code otherwise
+ */
+int cs8_iq_rewind_context(CS8_IQ_Context* ctx) {
+    if (!ctx || (!ctx->use_mmap && !ctx->file)) {
+        return CS8_IQ_ERROR_PARAM;
+    }
+
+    if (!ctx->use_mmap && fseek(ctx->file, 0, SEEK_SET) != 0) {
+        return CS8_IQ_ERROR_READ;
+    }
+
+    ctx->processed_bytes = 0;
+    return CS8_IQ_SUCCESS;
+}
+
 /**
  * @brief Release resources used by a processing context
  *
@@ -282,7 +430,7 @@ void cs8_iq_close_context(CS8_IQ_Context* ctx) {
     
     if (ctx->use_mmap) {
 #if USE_MMAP
-        if (ctx->mapped_memory) {
+        if (ctx->mapped_memory && !ctx->borrowed) {
             munmap(ctx->mapped_memory, ctx->file_size);
             ctx->mapped_memory = NULL;
         }
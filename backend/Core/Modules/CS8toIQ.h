@@ -35,6 +35,7 @@ typedef struct CS8_IQ_Context {
     size_t processed_bytes;  /**< Number of bytes processed so far */
     void* mapped_memory;     /**< Pointer to memory-mapped data (if used) */
     bool use_mmap;           /**< Indicates memory mapping usage */
+    bool borrowed;           /**< mapped_memory belongs to the caller (in-memory capture) */
     int error_code;          /**< Last error code (0 if no error, negative otherwise) */
 } CS8_IQ_Context;
 
@@ -69,6 +70,21 @@ enum CS8_IQ_ErrorCodes {
  */
 int cs8_iq_init_context(CS8_IQ_Context* ctx, const char* filename, bool use_mmap);
 
+/**
+ * @brief Initialize a context over a CS8 capture that is already in memory
+ *
+ * Used for zero-disk acquisition: the capture stays in the driver's buffer
+ * and every reader accesses it in place, exactly like a mapped file.
+ *
+ * @param ctx Pointer to context structure to initialize
+ * @param data Interleaved I/Q bytes, owned by the caller for the context's lifetime
+ * @param num_samples Number of I/Q pairs in data
+ * @return CS8_IQ_SUCCESS on success, negative error code on failure
+ *
+ * @see cs8_iq_close_context
+ */
+int cs8_iq_init_memory_context(CS8_IQ_Context* ctx, const int8_t* data, size_t num_samples);
+
 /**
  * @brief Convert a data block from the opened CS8 file to IQ samples
  *
@@ -87,6 +103,34 @@ int cs8_iq_init_context(CS8_IQ_Context* ctx, const char* filename, bool use_mmap
 int cs8_iq_process_block(CS8_IQ_Context* ctx, complex double* output_buffer, 
                         size_t max_samples, size_t* samples_read);
 
+/**
+ * @brief Copy the next raw CS8 bytes from the context without converting them
+ *
+ * Streaming consumers (e.g. the Welch estimator) use this to pull interleaved
+ * I/Q bytes segment by segment, so only a small window of the capture has to
+ * live in memory at any time.
+ *
+ * @param ctx Initialized processing context
+ * @param dst Destination buffer (at least 2 * max_samples bytes)
+ * @param max_samples Maximum number of I/Q pairs to copy
+ * @param samples_read Pointer to variable updated with actual pairs copied
+ * @return 0 on success with more data available, 1 at end of file, negative on error
+ *
+ * @see cs8_iq_rewind_context
+ */
+int cs8_iq_read_raw(CS8_IQ_Context* ctx, int8_t* dst,
+                    size_t max_samples, size_t* samples_read);
+
+/**
+ * @brief Reset the read position of a context to the start of the data
+ *
+ * Allows several passes over the same capture without reopening it.
+ *
+ * @param ctx Initialized processing context
+ * @return CS8_IQ_SUCCESS on success, negative error code on failure
+ */
+int cs8_iq_rewind_context(CS8_IQ_Context* ctx);
+
 /**
  * @brief Release all resources associated with a CS8_IQ_Context
  *
@@ -130,6 +174,45 @@ complex double* load_iq_data(const char* filename, size_t* num_samples, int* err
 int cs8_to_iq_convert(const int8_t* raw_data, size_t size_bytes, 
                     complex double* output_buffer, size_t max_samples);
 
+/**
+ * @brief Convert a raw CS8 buffer to single-precision complex samples
+ *
+ * Same contract as cs8_to_iq_convert(), with complex float output.
+ *
+ * @param raw_data Pointer to input CS8 buffer (interleaved I/Q samples)
+ * @param size_bytes Size in bytes of raw_data (must be even)
+ * @param output_buffer Pointer to the output complex float array
+ * @param max_samples Maximum samples to write into output_buffer
+ * @return Number of complex samples converted, or negative error code
+ */
+int cs8_to_iq_convert_f(const int8_t* raw_data, size_t size_bytes,
+                        complex float* output_buffer, size_t max_samples);
+
+/**
+ * @brief Widen a raw CS8 buffer to interleaved int16 I/Q pairs
+ *
+ * Same contract as cs8_to_iq_convert(); output_buffer receives
+ * 2 * max_samples int16 values (I0, Q0, I1, Q1, ...).
+ *
+ * @param raw_data Pointer to input CS8 buffer (interleaved I/Q samples)
+ * @param size_bytes Size in bytes of raw_data (must be even)
+ * @param output_buffer Pointer to the output int16 array
+ * @param max_samples Maximum I/Q pairs to write into output_buffer
+ * @return Number of I/Q pairs converted, or negative error code
+ */
+int cs8_to_iq_convert_s16(const int8_t* raw_data, size_t size_bytes,
+                          int16_t* output_buffer, size_t max_samples);
+
+/**
+ * @brief Name of the conversion kernel selected for this CPU
+ *
+ * The cs8_to_iq_convert* functions dispatch at startup to AVX2, SSE4.1,
+ * a portable vector-extension or a scalar implementation.
+ *
+ * @return Static string such as "avx2", "sse4.1", "vector" or "scalar"
+ */
+const char* cs8_iq_kernel_name(void);
+
 /**
  * @brief Get a textual description of an error code
  * 
@@ -0,0 +1,261 @@
+/**
+ * @file
+ * @author Martin Ramirez Espinosa, David Ramírez Betancourth
+ *
+ * @brief Vectorized CS8 conversion kernels and runtime dispatch
+ * @ingroup cs8_iq
+ *
+ * An interleaved CS8 buffer maps element-for-element onto an interleaved
+ * complex (re, im) array, so every output variant is a plain widening
+ * conversion of 2 * n signed bytes. This file provides:
+ * - AVX2 and SSE4.1 kernels on x86 (compiled with target attributes so the
+ *   rest of the build does not need -mavx2)
+ * - A portable kernel built on GCC/Clang vector extensions, which the
+ *   compiler lowers to NEON on ARM boards
+ * - A scalar reference used for tails and unsupported compilers
+ *
+ * The table is selected once from CPU feature detection. Setting the
+ * environment variable CS8_IQ_KERNEL to "scalar", "vector", "sse4.1" or
+ * "avx2" forces a specific table (when supported) for benchmarking.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "CS8toIQ_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define CS8_IQ_HAVE_X86 1
+    #include <immintrin.h>
+#else
+    #define CS8_IQ_HAVE_X86 0
+#endif
+
+#if defined(__has_builtin)
+    #if __has_builtin(__builtin_convertvector)
+        #define CS8_IQ_HAVE_VECTOR_EXT 1
+    #endif
+#endif
+#ifndef CS8_IQ_HAVE_VECTOR_EXT
+    #define CS8_IQ_HAVE_VECTOR_EXT 0
+#endif
+
+/* ----------------------------------------------------------------------- */
+/* Scalar reference                                                         */
+/* ----------------------------------------------------------------------- */
+
+static void scalar_to_cdouble(const int8_t* src, complex double* dst, size_t n) {
+    double* out = (double*)dst;
+    for (size_t i = 0; i < 2 * n; i++) {
+        out[i] = src[i];
+    }
+}
+
+static void scalar_to_cfloat(const int8_t* src, complex float* dst, size_t n) {
+    float* out = (float*)dst;
+    for (size_t i = 0; i < 2 * n; i++) {
+        out[i] = src[i];
+    }
+}
+
+static void scalar_to_s16(const int8_t* src, int16_t* dst, size_t n) {
+    for (size_t i = 0; i < 2 * n; i++) {
+        dst[i] = src[i];
+    }
+}
+
+static const CS8_IQ_Kernels kernels_scalar = {
+    "scalar", scalar_to_cdouble, scalar_to_cfloat, scalar_to_s16
+};
+
+/* ----------------------------------------------------------------------- */
+/* Portable vector-extension kernels (16 bytes per iteration)               */
+/* ----------------------------------------------------------------------- */
+
+#if CS8_IQ_HAVE_VECTOR_EXT
+typedef int8_t  v16i8 __attribute__((vector_size(16)));
+typedef int16_t v16i16 __attribute__((vector_size(32)));
+typedef float   v16f32 __attribute__((vector_size(64)));
+typedef double  v16f64 __attribute__((vector_size(128)));
+
+static void vec_to_cdouble(const int8_t* src, complex double* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    double* out = (double*)dst;
+    for (; i + 16 <= total; i += 16) {
+        v16i8 v;
+        memcpy(&v, src + i, sizeof(v));
+        v16f64 d = __builtin_convertvector(v, v16f64);
+        memcpy(out + i, &d, sizeof(d));
+    }
+    scalar_to_cdouble(src + i, (complex double*)(out + i), (total - i) / 2);
+}
+
+static void vec_to_cfloat(const int8_t* src, complex float* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    float* out = (float*)dst;
+    for (; i + 16 <= total; i += 16) {
+        v16i8 v;
+        memcpy(&v, src + i, sizeof(v));
+        v16f32 f = __builtin_convertvector(v, v16f32);
+        memcpy(out + i, &f, sizeof(f));
+    }
+    scalar_to_cfloat(src + i, (complex float*)(out + i), (total - i) / 2);
+}
+
+static void vec_to_s16(const int8_t* src, int16_t* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    for (; i + 16 <= total; i += 16) {
+        v16i8 v;
+        memcpy(&v, src + i, sizeof(v));
+        v16i16 s = __builtin_convertvector(v, v16i16);
+        memcpy(dst + i, &s, sizeof(s));
+    }
+    scalar_to_s16(src + i, dst + i, (total - i) / 2);
+}
+
+static const CS8_IQ_Kernels kernels_vector = {
+    "vector", vec_to_cdouble, vec_to_cfloat, vec_to_s16
+};
+#endif
+
+/* ----------------------------------------------------------------------- */
+/* x86 kernels                                                              */
+/* ----------------------------------------------------------------------- */
+
+#if CS8_IQ_HAVE_X86
+__attribute__((target("sse4.1")))
+static void sse41_to_cdouble(const int8_t* src, complex double* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    double* out = (double*)dst;
+    for (; i + 16 <= total; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        for (int j = 0; j < 4; j++) {
+            __m128i w = _mm_cvtepi8_epi32(v);
+            _mm_storeu_pd(out + i + 4 * j,     _mm_cvtepi32_pd(w));
+            _mm_storeu_pd(out + i + 4 * j + 2, _mm_cvtepi32_pd(_mm_srli_si128(w, 8)));
+            v = _mm_srli_si128(v, 4);
+        }
+    }
+    scalar_to_cdouble(src + i, (complex double*)(out + i), (total - i) / 2);
+}
+
+__attribute__((target("sse4.1")))
+static void sse41_to_cfloat(const int8_t* src, complex float* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    float* out = (float*)dst;
+    for (; i + 16 <= total; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        for (int j = 0; j < 4; j++) {
+            _mm_storeu_ps(out + i + 4 * j, _mm_cvtepi32_ps(_mm_cvtepi8_epi32(v)));
+            v = _mm_srli_si128(v, 4);
+        }
+    }
+    scalar_to_cfloat(src + i, (complex float*)(out + i), (total - i) / 2);
+}
+
+__attribute__((target("sse4.1")))
+static void sse41_to_s16(const int8_t* src, int16_t* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    for (; i + 16 <= total; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i),     _mm_cvtepi8_epi16(v));
+        _mm_storeu_si128((__m128i*)(dst + i + 8), _mm_cvtepi8_epi16(_mm_srli_si128(v, 8)));
+    }
+    scalar_to_s16(src + i, dst + i, (total - i) / 2);
+}
+
+static const CS8_IQ_Kernels kernels_sse41 = {
+    "sse4.1", sse41_to_cdouble, sse41_to_cfloat, sse41_to_s16
+};
+
+__attribute__((target("avx2")))
+static void avx2_to_cdouble(const int8_t* src, complex double* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    double* out = (double*)dst;
+    for (; i + 16 <= total; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        for (int j = 0; j < 4; j++) {
+            _mm256_storeu_pd(out + i + 4 * j, _mm256_cvtepi32_pd(_mm_cvtepi8_epi32(v)));
+            v = _mm_srli_si128(v, 4);
+        }
+    }
+    scalar_to_cdouble(src + i, (complex double*)(out + i), (total - i) / 2);
+}
+
+__attribute__((target("avx2")))
+static void avx2_to_cfloat(const int8_t* src, complex float* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    float* out = (float*)dst;
+    for (; i + 16 <= total; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm256_storeu_ps(out + i,     _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(v)));
+        _mm256_storeu_ps(out + i + 8, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(v, 8))));
+    }
+    scalar_to_cfloat(src + i, (complex float*)(out + i), (total - i) / 2);
+}
+
+__attribute__((target("avx2")))
+static void avx2_to_s16(const int8_t* src, int16_t* dst, size_t n) {
+    size_t total = 2 * n, i = 0;
+    for (; i + 32 <= total; i += 32) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(src + i + 16));
+        _mm256_storeu_si256((__m256i*)(dst + i),      _mm256_cvtepi8_epi16(lo));
+        _mm256_storeu_si256((__m256i*)(dst + i + 16), _mm256_cvtepi8_epi16(hi));
+    }
+    scalar_to_s16(src + i, dst + i, (total - i) / 2);
+}
+
+static const CS8_IQ_Kernels kernels_avx2 = {
+    "avx2", avx2_to_cdouble, avx2_to_cfloat, avx2_to_s16
+};
+#endif
+
+/* ----------------------------------------------------------------------- */
+/* Dispatch                                                                 */
+/* ----------------------------------------------------------------------- */
+
+static const CS8_IQ_Kernels* selected_kernels = NULL;
+
+static const CS8_IQ_Kernels* cs8_iq_detect_kernels(void) {
+    const char* forced = getenv("CS8_IQ_KERNEL");
+    if (forced && strcmp(forced, kernels_scalar.name) == 0) {
+        return &kernels_scalar;
+    }
+#if CS8_IQ_HAVE_VECTOR_EXT
+    if (forced && strcmp(forced, kernels_vector.name) == 0) {
+        return &kernels_vector;
+    }
+#endif
+#if CS8_IQ_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && !(forced && strcmp(forced, kernels_sse41.name) == 0)) {
+        return &kernels_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return &kernels_sse41;
+    }
+#endif
+#if CS8_IQ_HAVE_VECTOR_EXT
+    return &kernels_vector;
+#else
+    return &kernels_scalar;
+#endif
+}
+
+/**
+ * @brief Select the kernel table before main() runs.
+ */
+__attribute__((constructor))
+static void cs8_iq_init_kernels(void) {
+    selected_kernels = cs8_iq_detect_kernels();
+}
+
+const CS8_IQ_Kernels* cs8_iq_get_kernels(void) {
+    const CS8_IQ_Kernels* k = __atomic_load_n(&selected_kernels, __ATOMIC_ACQUIRE);
+    if (!k) {
+        /* Only reachable if called from another constructor; detection is idempotent */
+        k = cs8_iq_detect_kernels();
+        __atomic_store_n(&selected_kernels, k, __ATOMIC_RELEASE);
+    }
+    return k;
+}
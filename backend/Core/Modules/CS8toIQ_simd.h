@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @author Martin Ramirez Espinosa, David Ramírez Betancourth
+ *
+ * @brief Vectorized CS8 conversion kernels with runtime CPU dispatch
+ * @ingroup cs8_iq
+ *
+ * Internal kernel table used by the cs8_to_iq_convert* family. The best
+ * implementation for the running CPU (AVX2, SSE4.1 or a portable
+ * vector-extension fallback) is selected once at startup; the public
+ * functions in CS8toIQ.h only validate parameters and call through it.
+ */
+#ifndef CS8_TO_IQ_SIMD_H
+#define CS8_TO_IQ_SIMD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <complex.h>
+
+/**
+ * @brief Set of conversion kernels for one instruction set.
+ *
+ * Each kernel converts @p n interleaved I/Q byte pairs. No parameter
+ * checking is done at this level.
+ */
+typedef struct {
+    const char* name;                                                   /**< ISA label, e.g. "avx2" */
+    void (*to_cdouble)(const int8_t* src, complex double* dst, size_t n); /**< CS8 -> complex double */
+    void (*to_cfloat)(const int8_t* src, complex float* dst, size_t n);   /**< CS8 -> complex float */
+    void (*to_s16)(const int8_t* src, int16_t* dst, size_t n);            /**< CS8 -> interleaved int16 */
+} CS8_IQ_Kernels;
+
+/**
+ * @brief Return the kernel table selected for the running CPU.
+ *
+ * Detection runs once (at load time through a constructor, or on first use);
+ * later calls return the cached table.
+ *
+ * @return Pointer to a static, never-NULL kernel table
+ */
+const CS8_IQ_Kernels* cs8_iq_get_kernels(void);
+
+#endif // CS8_TO_IQ_SIMD_H
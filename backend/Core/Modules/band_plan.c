@@ -0,0 +1,147 @@
+/**
+ * @file band_plan.c
+ * @brief Compilation of the channel plan to PSD bin ranges.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "band_plan.h"
+#include "find_closest_index.h"
+
+static const char* band_plan_error_messages[] = {
+    "Success",
+    "Invalid argument",
+    "Memory allocation failed"
+};
+
+const char* band_plan_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(band_plan_error_messages) / sizeof(band_plan_error_messages[0]))) {
+        return band_plan_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+int band_plan_init(BandPlan* plan, const double* canalization, const double* bandwidth,
+                   int channel_count) {
+    if (plan == NULL || canalization == NULL || bandwidth == NULL || channel_count <= 0) {
+        return BAND_PLAN_ERROR_PARAM;
+    }
+
+    plan->ranges = (BandPlanRange*)malloc(channel_count * sizeof(BandPlanRange));
+    if (plan->ranges == NULL) {
+        return BAND_PLAN_ERROR_MEMORY;
+    }
+    plan->canalization = canalization;
+    plan->bandwidth = bandwidth;
+    plan->channel_count = channel_count;
+    plan->compiled = false;
+    return BAND_PLAN_SUCCESS;
+}
+
+void band_plan_free(BandPlan* plan) {
+    if (plan == NULL) {
+        return;
+    }
+    free(plan->ranges);
+    plan->ranges = NULL;
+    plan->compiled = false;
+}
+
+/* Store a channel's edge bins in ascending order */
+static void band_plan_set_range(BandPlan* plan, int channel, int lower_index, int upper_index) {
+    if (lower_index > upper_index) {
+        int temp = lower_index;
+        lower_index = upper_index;
+        upper_index = temp;
+    }
+    plan->ranges[channel].lower_index = lower_index;
+    plan->ranges[channel].upper_index = upper_index;
+}
+
+/* Bin i of the Welch axis in MHz, computed exactly as the engine and the signal processor do */
+static double uniform_bin_mhz(uint64_t central_freq, double fs, double df, int i) {
+    return ((-fs / 2 + i * df) + central_freq) / 1e6;
+}
+
+/* Index closest to target_mhz on the uniform axis; ties go to the lower bin, as in the scan */
+static int uniform_closest_index(uint64_t central_freq, double fs, int bins, double target_mhz) {
+    double df = fs / bins;
+    double x = (target_mhz * 1e6 - (double)central_freq + fs / 2) / df;
+
+    int i;
+    if (!(x > 0.0)) {
+        i = 0;
+    } else if (x >= bins - 1) {
+        i = bins - 1;
+    } else {
+        i = (int)x;
+    }
+
+    /* The estimate is at most a bin off; settle it on the real bin values */
+    double diff = fabs(uniform_bin_mhz(central_freq, fs, df, i) - target_mhz);
+    while (i + 1 < bins) {
+        double next = fabs(uniform_bin_mhz(central_freq, fs, df, i + 1) - target_mhz);
+        if (next >= diff) break;
+        diff = next;
+        i++;
+    }
+    while (i > 0) {
+        double prev = fabs(uniform_bin_mhz(central_freq, fs, df, i - 1) - target_mhz);
+        if (prev > diff) break;
+        diff = prev;
+        i--;
+    }
+    return i;
+}
+
+int band_plan_compile_uniform(BandPlan* plan, uint64_t central_freq, double fs, int bins) {
+    if (plan == NULL || plan->ranges == NULL || fs <= 0.0 || bins <= 0) {
+        return BAND_PLAN_ERROR_PARAM;
+    }
+    if (plan->compiled && plan->uniform && plan->bins == bins &&
+        plan->central_freq == central_freq && plan->fs == fs) {
+        return BAND_PLAN_SUCCESS;
+    }
+
+    for (int c = 0; c < plan->channel_count; c++) {
+        double center_freq = plan->canalization[c];
+        double bw = plan->bandwidth[c];
+        band_plan_set_range(plan, c,
+                            uniform_closest_index(central_freq, fs, bins, center_freq - bw / 2),
+                            uniform_closest_index(central_freq, fs, bins, center_freq + bw / 2));
+    }
+
+    plan->compiled = true;
+    plan->uniform = true;
+    plan->bins = bins;
+    plan->central_freq = central_freq;
+    plan->fs = fs;
+    return BAND_PLAN_SUCCESS;
+}
+
+int band_plan_compile_axis(BandPlan* plan, const double* f, int bins) {
+    if (plan == NULL || plan->ranges == NULL || f == NULL || bins <= 0) {
+        return BAND_PLAN_ERROR_PARAM;
+    }
+    if (plan->compiled && !plan->uniform && plan->bins == bins &&
+        plan->f_first == f[0] && plan->f_last == f[bins - 1]) {
+        return BAND_PLAN_SUCCESS;
+    }
+
+    for (int c = 0; c < plan->channel_count; c++) {
+        double center_freq = plan->canalization[c];
+        double bw = plan->bandwidth[c];
+        band_plan_set_range(plan, c,
+                            find_closest_index_sorted(f, bins, center_freq - bw / 2),
+                            find_closest_index_sorted(f, bins, center_freq + bw / 2));
+    }
+
+    plan->compiled = true;
+    plan->uniform = false;
+    plan->bins = bins;
+    plan->f_first = f[0];
+    plan->f_last = f[bins - 1];
+    return BAND_PLAN_SUCCESS;
+}
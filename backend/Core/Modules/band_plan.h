@@ -0,0 +1,124 @@
+/**
+ * @file band_plan.h
+ * @brief Channel plan compiled to PSD bin ranges.
+ *
+ * Channel detection needs, for every channel of the plan, the bins of the
+ * detection spectrum between center - bw/2 and center + bw/2. Those ranges
+ * only depend on the frequency axis, so they are compiled once and reused
+ * until the axis changes (retune, other sample rate or segment length)
+ * instead of scanning the axis twice per channel per capture.
+ *
+ * - band_plan_compile_uniform() computes the ranges analytically for the
+ *   Welch axis of a tuned capture (center frequency, sample rate, nperseg).
+ * - band_plan_compile_axis() handles any ascending axis, e.g. a stitched
+ *   sweep with the edges and DC bins dropped, by binary search.
+ *
+ * Both pick exactly the bins find_closest_index() would, and both return
+ * immediately when called again for the axis already compiled.
+ *
+ * @code
+ * BandPlan plan;
+ * band_plan_init(&plan, canalization, bandwidth, channel_count);
+ * band_plan_compile_uniform(&plan, 98000000, 20e6, 32768);
+ * for (int c = 0; c < plan.channel_count; c++) {
+ *     ... psd[plan.ranges[c].lower_index .. plan.ranges[c].upper_index] ...
+ * }
+ * band_plan_free(&plan);
+ * @endcode
+ */
+
+#ifndef BAND_PLAN_H
+#define BAND_PLAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Error codes returned by the band plan functions
+ */
+typedef enum {
+    BAND_PLAN_SUCCESS      =  0, /**< Success */
+    BAND_PLAN_ERROR_PARAM  = -1, /**< Invalid argument */
+    BAND_PLAN_ERROR_MEMORY = -2  /**< Allocation failure */
+} BandPlanErrorCode;
+
+/**
+ * @brief Bins of one channel, both ends included, lower_index <= upper_index
+ */
+typedef struct {
+    int lower_index;
+    int upper_index;
+} BandPlanRange;
+
+/**
+ * @brief Channel plan and the ranges compiled for one frequency axis
+ */
+typedef struct {
+    const double*  canalization;  /**< Channel centers in MHz (borrowed) */
+    const double*  bandwidth;     /**< Channel bandwidths in MHz (borrowed) */
+    int            channel_count;
+    BandPlanRange* ranges;        /**< One per channel, valid once compiled */
+
+    /* Axis the ranges were compiled for */
+    bool           compiled;
+    bool           uniform;
+    int            bins;
+    uint64_t       central_freq;  /**< Uniform axis: tuned frequency in Hz */
+    double         fs;            /**< Uniform axis: sampling rate in Hz */
+    double         f_first;       /**< Axis: first bin in MHz */
+    double         f_last;        /**< Axis: last bin in MHz */
+} BandPlan;
+
+/**
+ * @brief Allocate the range table for a channel plan (not compiled yet).
+ *
+ * @param plan Plan to initialize
+ * @param canalization Channel centers in MHz; must outlive the plan
+ * @param bandwidth Channel bandwidths in MHz; must outlive the plan
+ * @param channel_count Number of channels
+ * @return BAND_PLAN_SUCCESS or a negative BandPlanErrorCode
+ */
+int band_plan_init(BandPlan* plan, const double* canalization, const double* bandwidth,
+                   int channel_count);
+
+/**
+ * @brief Release the range table.
+ */
+void band_plan_free(BandPlan* plan);
+
+/**
+ * @brief Compile the ranges for the Welch axis of a capture tuned at central_freq.
+ *
+ * Bin i of that axis is (-fs/2 + i * fs/bins + central_freq) / 1e6 MHz, the
+ * values produced by the Welch engine and shifted to absolute frequency by
+ * the signal processor. The index is computed directly from the channel
+ * edge and then checked against its neighbours with that same expression,
+ * so rounding never differs from a scan of the real array.
+ *
+ * @param plan Initialized plan
+ * @param central_freq Tuned frequency in Hz
+ * @param fs Sampling rate in Hz
+ * @param bins Segment length (nperseg)
+ * @return BAND_PLAN_SUCCESS or BAND_PLAN_ERROR_PARAM
+ */
+int band_plan_compile_uniform(BandPlan* plan, uint64_t central_freq, double fs, int bins);
+
+/**
+ * @brief Compile the ranges for an arbitrary ascending axis in MHz.
+ *
+ * The axis is identified by its length and end points: a different array
+ * with the same three values is assumed to be the same axis.
+ *
+ * @param plan Initialized plan
+ * @param f Ascending frequencies in MHz
+ * @param bins Number of bins in f
+ * @return BAND_PLAN_SUCCESS or BAND_PLAN_ERROR_PARAM
+ */
+int band_plan_compile_axis(BandPlan* plan, const double* f, int bins);
+
+/**
+ * @brief Human-readable message for a BandPlanErrorCode.
+ */
+const char* band_plan_error_string(int error_code);
+
+#endif // BAND_PLAN_H
@@ -0,0 +1,59 @@
+/**
+ * @file dsp_precision.h
+ * @brief Compile-time floating-point precision selection for the DSP chain.
+ *
+ * CS8 input carries 8-bit samples, so the spectral path does not need double
+ * precision. Building with DSP_SINGLE_PRECISION (CMake option of the same
+ * name) switches the streaming Welch estimator, its FFTW plans and the PSD
+ * buffers used by parameter.c to float / complex float and fftwf_*, which
+ * halves memory traffic and doubles SIMD width.
+ *
+ * Frequency axes stay in double: absolute frequencies in Hz need more than
+ * the 24-bit float mantissa.
+ *
+ * Accuracy: the int8 inputs are exact in float. What is left is FFT
+ * rounding, which is relative to the whole segment rather than to each bin,
+ * so it shows most in the low bins beside a strong tone at large nperseg.
+ * Measured by bench_kernels (welch_precision, tone plus noise, 20M samples
+ * as in main), the worst bin deviates from the double path by 0.0002 dB at
+ * nperseg 4096 and 0.0017 dB at 32768 (0.0054 dB on a 2M-sample capture,
+ * where fewer periodograms are averaged). DSP_SINGLE_TOLERANCE_DB keeps
+ * about twice the worst of these as margin (0.01 dB is 0.23% in linear
+ * power), so only a channel within 0.01 dB of the threshold can flip.
+ */
+
+#ifndef DSP_PRECISION_H
+#define DSP_PRECISION_H
+
+#include <complex.h>
+
+/** @brief Largest deviation of the single path from the double path accepted by bench_kernels, in dB. */
+#define DSP_SINGLE_TOLERANCE_DB 0.01
+
+#ifdef DSP_SINGLE_PRECISION
+
+typedef float         dsp_real_t;     /**< Real sample / PSD type */
+typedef float complex dsp_complex_t;  /**< Complex sample type */
+
+/** @brief Map an FFTW symbol to its single-precision variant, e.g. DSP_FFTW(plan) -> fftwf_plan */
+#define DSP_FFTW(name) fftwf_##name
+
+/** @brief CS8 conversion kernel producing dsp_complex_t */
+#define cs8_to_dsp_convert cs8_to_iq_convert_f
+
+#define DSP_PRECISION_NAME "single"
+
+#else
+
+typedef double         dsp_real_t;
+typedef double complex dsp_complex_t;
+
+#define DSP_FFTW(name) fftw_##name
+
+#define cs8_to_dsp_convert cs8_to_iq_convert
+
+#define DSP_PRECISION_NAME "double"
+
+#endif
+
+#endif // DSP_PRECISION_H
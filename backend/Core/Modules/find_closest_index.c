@@ -6,8 +6,11 @@
  * find the index of the element closest to a given value in an array of floating-point numbers.
  */
 #include <stdio.h>
+#include <math.h>
 
-int find_closest_index(double* array, int length, double value) {
+#include "find_closest_index.h"
+
+int find_closest_index(const double* array, int length, double value) {
     int min_index = 0;
     double min_diff = fabs(array[0] - value);
     for (int i = 1; i < length; i++) {
@@ -18,4 +21,27 @@ int find_closest_index(double* array, int length, double value) {
         }
     }
     return min_index;
-}
\ No newline at end of file
+}
+
+int find_closest_index_sorted(const double* array, int length, double value) {
+    /* First element >= value */
+    int low = 0;
+    int high = length;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (array[mid] < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == 0) {
+        return 0;
+    }
+    if (low == length) {
+        return length - 1;
+    }
+    /* Closest of the two neighbours; the lower one wins a tie, as in the linear scan */
+    return (value - array[low - 1] <= array[low] - value) ? low - 1 : low;
+}
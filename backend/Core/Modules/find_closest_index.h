@@ -36,6 +36,23 @@
  * // closest_index will be 1, since 3.4 is the value closest to 4.0 in the array.
  * @endcode
  */
-int find_closest_index(double* array, int length, double value);
+int find_closest_index(const double* array, int length, double value);
+
+/**
+ * @brief Binary-search variant of find_closest_index() for ascending arrays.
+ *
+ * Returns the same index as find_closest_index() when `array` is sorted in
+ * ascending order (ties resolve to the lower index), in O(log length)
+ * comparisons instead of a full scan. Use it for one-off lookups on
+ * frequency axes; repeated channel lookups belong in a band plan
+ * (band_plan.h).
+ *
+ * @param array Ascending array of `double` values.
+ * @param length The number of elements in the array (at least 1).
+ * @param value The value to which the closest element is to be found.
+ *
+ * @return The index of the element closest to `value`.
+ */
+int find_closest_index_sorted(const double* array, int length, double value);
 
 #endif // FIND_CLOSEST_INDEX_H
\ No newline at end of file
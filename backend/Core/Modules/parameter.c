@@ -15,105 +15,206 @@
  * - Spectrum visualization data generation
  * - JSON output for web interface integration
  * - Robust error handling and reporting
+ * - PSD buffers at the precision selected in dsp_precision.h
  */
 
 
 
 #include "parameter.h"
+#include "parameter_internal.h"
+#include "band_plan.h"
+#include "spectrum_frame.h"
+#include "spectrum_json.h"
+#include "spectrum_ring.h"
+#include "perf_stats.h"
+#include "trace.h"
+
+// Ranges up to this length are finished by insertion sort
+#define SELECT_INSERTION_THRESHOLD 16
 
 // Static helper function (Internal implementation detail)
-static int compare_doubles(const void* a, const void* b) {
-    double x = *(const double*)a;
-    double y = *(const double*)b;
-    
-    if (x < y) return -1;
-    else if (x > y) return 1;
-    else return 0;
+static void insertion_sort(dsp_real_t* a, int lo, int hi) {
+    for (int i = lo + 1; i <= hi; i++) {
+        dsp_real_t value = a[i];
+        int j = i - 1;
+        while (j >= lo && a[j] > value) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = value;
+    }
 }
 
 // Static helper function (Internal implementation detail)
-static double calculate_median(const double* array, int start, int end) {
-    if (array == NULL || start < 0 || end <= start) {
-        return NAN;
+static void sift_down(dsp_real_t* a, int lo, int root, int count) {
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= count) break;
+        if (child + 1 < count && a[lo + child + 1] > a[lo + child]) child++;
+        if (!(a[lo + child] > a[lo + root])) break;
+        dsp_real_t temp = a[lo + root];
+        a[lo + root] = a[lo + child];
+        a[lo + child] = temp;
+        root = child;
     }
-    
-    int length = end - start;
-    double* temp = (double*)malloc(length * sizeof(double));
-    if (temp == NULL) {
-        return NAN;
+}
+
+// Static helper function (Internal implementation detail)
+// Fallback when pivots keep going bad: O(n log n) whatever the data
+static void heap_sort(dsp_real_t* a, int lo, int hi) {
+    int count = hi - lo + 1;
+    for (int root = count / 2 - 1; root >= 0; root--) {
+        sift_down(a, lo, root, count);
+    }
+    for (int end = count - 1; end > 0; end--) {
+        dsp_real_t temp = a[lo];
+        a[lo] = a[lo + end];
+        a[lo + end] = temp;
+        sift_down(a, lo, 0, end);
     }
-    
-    memcpy(temp, array + start, length * sizeof(double));
-    
-    qsort(temp, length, sizeof(double), compare_doubles);
-    
-    double median_value;
-    if (length % 2 == 0) {
-        median_value = (temp[length/2 - 1] + temp[length/2]) * 0.5;
-    } else {
-        median_value = temp[length/2];
+}
+
+// Static helper function (Internal implementation detail)
+// Introselect: move the k-th smallest of a[0, n) to a[k], smaller values before it.
+// Quickselect with median-of-three pivots, expected O(n); after 2 log2(n)
+// partitions that did not converge the remaining range is heap sorted.
+static void select_kth(dsp_real_t* a, int n, int k) {
+    int lo = 0;
+    int hi = n - 1;
+    int depth = 0;
+    for (int m = n; m > 1; m >>= 1) depth += 2;
+    
+    while (hi - lo >= SELECT_INSERTION_THRESHOLD) {
+        if (depth-- == 0) {
+            heap_sort(a, lo, hi);
+            return;
+        }
+        
+        // Order lo, mid, hi so the pivot is their median and both ends act as sentinels
+        int mid = lo + (hi - lo) / 2;
+        dsp_real_t temp;
+        if (a[mid] < a[lo]) { temp = a[mid]; a[mid] = a[lo]; a[lo] = temp; }
+        if (a[hi] < a[lo])  { temp = a[hi];  a[hi] = a[lo];  a[lo] = temp; }
+        if (a[hi] < a[mid]) { temp = a[hi];  a[hi] = a[mid]; a[mid] = temp; }
+        dsp_real_t pivot = a[mid];
+        
+        // Hoare partition: [lo, j] <= pivot, [i, hi] >= pivot, (j, i) == pivot
+        int i = lo;
+        int j = hi;
+        while (i <= j) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i <= j) {
+                temp = a[i]; a[i] = a[j]; a[j] = temp;
+                i++;
+                j--;
+            }
+        }
+        
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            return;
+        }
     }
-    
-    free(temp);
-    return median_value;
+    insertion_sort(a, lo, hi);
 }
 
 // Static helper function (Internal implementation detail)
-static double find_min(const double* array, int length) {
-    if (array == NULL || length <= 0) {
+// Median of a[0, n), reordering a
+static double median_in_place(dsp_real_t* a, int n) {
+    int k = n / 2;
+    select_kth(a, n, k);
+    if (n % 2 != 0) {
+        return a[k];
+    }
+    
+    // Even length: the lower middle is the largest value left of a[k]
+    dsp_real_t lower = a[0];
+    for (int i = 1; i < k; i++) {
+        if (a[i] > lower) lower = a[i];
+    }
+    return ((double)lower + a[k]) * 0.5;
+}
+
+// Internal helper, declared in parameter_internal.h
+double calculate_median(const dsp_real_t* array, int start, int end, dsp_real_t* scratch) {
+    if (array == NULL || start < 0 || end <= start) {
         return NAN;
     }
     
-    double min_val = array[0];
-    for (int i = 1; i < length; i++) {
-        if (array[i] < min_val) {
-            min_val = array[i];
+    int length = end - start;
+    dsp_real_t* temp = scratch;
+    if (temp == NULL) {
+        temp = (dsp_real_t*)malloc(length * sizeof(dsp_real_t));
+        if (temp == NULL) {
+            return NAN;
         }
     }
     
-    return min_val;
+    memcpy(temp, array + start, length * sizeof(dsp_real_t));
+    double median_value = median_in_place(temp, length);
+    
+    if (temp != scratch) {
+        free(temp);
+    }
+    return median_value;
 }
 
-// Static helper function (Internal implementation detail)
-static double find_max(const double* array, int start, int end) {
-    if (array == NULL || start < 0 || end < start) {
-        return NAN;
+// Internal helper, declared in parameter_internal.h
+bool calculate_channel_stats(const dsp_real_t* psd, const BandPlan* plan, dsp_real_t* scratch,
+                             ChannelStats* stats) {
+    if (psd == NULL || plan == NULL || !plan->compiled || scratch == NULL || stats == NULL) {
+        return false;
     }
     
-    double max_val = array[start];
-    for (int i = start + 1; i <= end; i++) {
-        if (array[i] > max_val) {
-            max_val = array[i];
+    for (int c = 0; c < plan->channel_count; c++) {
+        int lower_index = plan->ranges[c].lower_index;
+        int length = plan->ranges[c].upper_index - lower_index + 1;
+        const dsp_real_t* bins = psd + lower_index;
+        
+        // One read of the channel: extremes and sum while filling the selection buffer
+        dsp_real_t min_val = bins[0];
+        dsp_real_t max_val = bins[0];
+        double sum = 0.0;
+        for (int i = 0; i < length; i++) {
+            dsp_real_t value = bins[i];
+            scratch[i] = value;
+            if (value < min_val) min_val = value;
+            if (value > max_val) max_val = value;
+            sum += value;
         }
+        
+        stats[c].min = min_val;
+        stats[c].max = max_val;
+        stats[c].mean = sum / length;
+        // Median over [lower_index, upper_index), as calculate_median() has always been called
+        stats[c].median = length > 1 ? median_in_place(scratch, length - 1) : NAN;
     }
-    
-    return max_val;
+    return true;
 }
 
-// Static helper function (Internal implementation detail)
-static bool rearrange_welch_psd(double* psd, int length) {
+// Internal helper, declared in parameter_internal.h
+bool rearrange_welch_psd(dsp_real_t* psd, int length) {
     if (psd == NULL || length <= 0 || length % 2 != 0) {
         return false;
     }
     
+    // Even length: swapping the halves is a bin-by-bin exchange, no copy needed
     int half = length / 2;
-    double* temp = (double*)malloc(length * sizeof(double));
-    if (temp == NULL) {
-        return false;
+    for (int i = 0; i < half; i++) {
+        dsp_real_t temp = psd[i];
+        psd[i] = psd[i + half];
+        psd[i + half] = temp;
     }
     
-    memcpy(temp, psd + half, half * sizeof(double));
-    
-    memcpy(temp + half, psd, half * sizeof(double));
-    
-    memcpy(psd, temp, length * sizeof(double));
-    
-    free(temp);
     return true;
 }
 
-// Static helper function (Internal implementation detail)
-static bool apply_spectral_correction(double* psd, int length, int center_index, int correction_width) {
+// Internal helper, declared in parameter_internal.h
+bool apply_spectral_correction(dsp_real_t* psd, int length, int center_index, int correction_width) {
     if (psd == NULL || length <= 0 || center_index < 0 || center_index >= length || correction_width <= 0) {
         return false;
     }
@@ -142,10 +243,10 @@ static bool apply_spectral_correction(double* psd, int length, int center_index,
     return true;
 }
 
-// Static helper function (Internal implementation detail)
-static cJSON* create_signal_json(
+// Internal helper, declared in parameter_internal.h
+cJSON* create_signal_json(
     const double* f, 
-    const double* psd, 
+    const dsp_real_t* psd, 
     int length,
     double calibration_factor,
     const double* canalization,
@@ -219,8 +320,8 @@ static cJSON* create_signal_json(
     return json_data;
 }
 
-// Static helper function (Internal implementation detail)
-static int save_json_to_file(const cJSON* json_obj, const char* filename) {
+// Internal helper, declared in parameter_internal.h
+int save_json_to_file(const cJSON* json_obj, const char* filename) {
     if (json_obj == NULL || filename == NULL) {
         return SP_ERROR_NULL_POINTER;
     }
@@ -245,72 +346,341 @@ static int save_json_to_file(const cJSON* json_obj, const char* filename) {
     return (written == len) ? SP_SUCCESS : SP_ERROR_FILE_IO;
 }
 
-// Implementation for function declared in parameter.h
-int process_signal_spectrum(const SignalProcessorConfig* config) {
-    if (config == NULL || config->input_file_path == NULL || 
-        config->output_json_path == NULL || config->canalization == NULL || 
-        config->bandwidth == NULL || config->canalization_length <= 0) {
-        return SP_ERROR_NULL_POINTER;
+/**
+ * @brief Encoders of the published spectrum, reused across cycles
+ *
+ * Only the one selected by SignalProcessorConfig.output_format ever
+ * allocates. The ring is only published through a SignalProcessor, which
+ * maps it when it is created.
+ */
+typedef struct {
+    SpectrumJson  json;
+    SpectrumFrame frame;
+    SpectrumRing* ring;
+} SpectrumOutput;
+
+// Static helper function (Internal implementation detail)
+static void spectrum_output_init(SpectrumOutput* output) {
+    spectrum_json_init(&output->json);
+    spectrum_frame_init(&output->frame);
+    output->ring = NULL;
+}
+
+// Static helper function (Internal implementation detail)
+static void spectrum_output_free(SpectrumOutput* output) {
+    spectrum_json_free(&output->json);
+    spectrum_frame_free(&output->frame);
+    spectrum_ring_close(output->ring);
+    output->ring = NULL;
+}
+
+// Static helper function (Internal implementation detail)
+// Where the selected output format is published, NULL when it is not configured
+static const char* output_path(const SignalProcessorConfig* config) {
+    switch (config->output_format) {
+        case SP_OUTPUT_JSON:
+            return config->output_json_path;
+        case SP_OUTPUT_FRAME_F32:
+        case SP_OUTPUT_FRAME_I16:
+            return config->output_ring_path != NULL ? config->output_ring_path : config->output_frame_path;
+        default:
+            return NULL;
     }
+}
+
+// Static helper function (Internal implementation detail)
+// JSON document: build in the reused buffer, then rewrite the output file
+static int publish_json(const SignalProcessorConfig* config, const double* f, const dsp_real_t* psd,
+                        int length, double calibration_factor, SpectrumOutput* output) {
+    uint64_t stage_start = perf_now_ns();
+    trace_begin("output", "json_build");
+    int result = spectrum_json_build(&output->json, f, psd, length, calibration_factor);
+    trace_end("output", "json_build");
     
-    complex double* vector_IQ = NULL;
-    double* psd_large = NULL;
-    double* f_large = NULL;
-    double* psd_small = NULL;
-    double* f_small = NULL;
-    size_t num_samples = 0;
-    int error_code = 0;
-    int result = SP_SUCCESS;
+    if (result != SPECTRUM_JSON_SUCCESS) {
+        return (result == SPECTRUM_JSON_ERROR_MEMORY) ? SP_ERROR_MEMORY_ALLOC : SP_ERROR_INVALID_PARAMETER;
+    }
     
-    int nperseg_large = config->nperseg_large > 0 ? config->nperseg_large : 32768;
-    int nperseg_small = config->nperseg_small > 0 ? config->nperseg_small : 4096;
+    perf_stats_record(PERF_STAGE_JSON_BUILD, perf_now_ns() - stage_start);
     
-    if (nperseg_large % 2 != 0 || nperseg_small % 2 != 0) {
-        return SP_ERROR_INVALID_PARAMETER;
+    // Save JSON to output file
+    stage_start = perf_now_ns();
+    trace_begin("output", "file_write");
+    result = spectrum_json_write(&output->json, config->output_json_path);
+    trace_end("output", "file_write");
+    perf_stats_record(PERF_STAGE_FILE_WRITE, perf_now_ns() - stage_start);
+    return (result == SPECTRUM_JSON_SUCCESS) ? SP_SUCCESS : SP_ERROR_FILE_IO;
+}
+
+// Static helper function (Internal implementation detail)
+// Binary frame file: build in the reused buffer, then replace the file atomically
+static int publish_frame_file(const SignalProcessorConfig* config, const double* f, const dsp_real_t* psd,
+                              int length, double calibration_factor, SpectrumFrameEncoding encoding,
+                              SpectrumOutput* output) {
+    uint64_t stage_start = perf_now_ns();
+    trace_begin("output", "frame_build");
+    int result = spectrum_frame_build(&output->frame, f, psd, length, calibration_factor, encoding);
+    trace_end("output", "frame_build");
+    
+    if (result != SPECTRUM_FRAME_SUCCESS) {
+        return (result == SPECTRUM_FRAME_ERROR_MEMORY) ? SP_ERROR_MEMORY_ALLOC : SP_ERROR_INVALID_PARAMETER;
+    }
+    
+    perf_stats_record(PERF_STAGE_JSON_BUILD, perf_now_ns() - stage_start);
+    
+    stage_start = perf_now_ns();
+    trace_begin("output", "file_write");
+    result = spectrum_frame_write(&output->frame, config->output_frame_path);
+    trace_end("output", "file_write");
+    perf_stats_record(PERF_STAGE_FILE_WRITE, perf_now_ns() - stage_start);
+    return (result == SPECTRUM_FRAME_SUCCESS) ? SP_SUCCESS : SP_ERROR_FILE_IO;
+}
+
+// Static helper function (Internal implementation detail)
+// (Re)create the ring for spectra of length bins, keeping the frame numbers
+static int spectrum_output_open_ring(const SignalProcessorConfig* config, int length, SpectrumOutput* output) {
+    uint64_t first_frame = spectrum_ring_published(output->ring);
+    spectrum_ring_close(output->ring);
+    // Sized for f32 so either encoding of this spectrum fits
+    int error = SPECTRUM_RING_SUCCESS;
+    output->ring = spectrum_ring_create(config->output_ring_path, config->output_ring_slots,
+                                        spectrum_frame_size(length, SPECTRUM_FRAME_F32),
+                                        first_frame, &error);
+    if (output->ring == NULL) {
+        return (error == SPECTRUM_RING_ERROR_MEMORY) ? SP_ERROR_MEMORY_ALLOC :
+               (error == SPECTRUM_RING_ERROR_PARAM) ? SP_ERROR_INVALID_PARAMETER : SP_ERROR_FILE_IO;
+    }
+    return SP_SUCCESS;
+}
+
+// Static helper function (Internal implementation detail)
+// Shared-memory ring: encode straight into the next slot and commit it. The ring
+// mapped by signal_processor_create() is recreated, numbering kept, for a larger frame
+static int publish_to_ring(const SignalProcessorConfig* config, const double* f, const dsp_real_t* psd,
+                           int length, double calibration_factor, SpectrumFrameEncoding encoding,
+                           SpectrumOutput* output) {
+    if (output->ring == NULL ||
+        spectrum_ring_frame_capacity(output->ring) < spectrum_frame_size(length, encoding)) {
+        int result = spectrum_output_open_ring(config, length, output);
+        if (result != SP_SUCCESS) {
+            return result;
+        }
     }
     
-    clock_t start_time = 0, end_time = 0;
-    if (config->verbose_output) {
-        start_time = clock();
-        printf("[params] Starting signal processing...\n");
+    uint64_t stage_start = perf_now_ns();
+    trace_begin("output", "frame_build");
+    size_t capacity = 0;
+    size_t written = 0;
+    uint8_t* slot = spectrum_ring_begin(output->ring, &capacity);
+    int result = spectrum_frame_encode(&output->frame, slot, capacity, f, psd, length,
+                                       calibration_factor, encoding, &written);
+    trace_end("output", "frame_build");
+    
+    // An uncommitted slot stays odd: readers skip it and the next frame reuses it
+    if (result != SPECTRUM_FRAME_SUCCESS) {
+        return (result == SPECTRUM_FRAME_ERROR_MEMORY) ? SP_ERROR_MEMORY_ALLOC : SP_ERROR_INVALID_PARAMETER;
     }
     
-    // Load IQ data from the input file
-    vector_IQ = load_iq_data(config->input_file_path, &num_samples, &error_code);
-    if (vector_IQ == NULL) {
-        fprintf(stderr, "[params] Error loading CS8 data: %s\n", cs8_iq_error_string(error_code));
-        return SP_ERROR_FILE_IO;
+    perf_stats_record(PERF_STAGE_JSON_BUILD, perf_now_ns() - stage_start);
+    
+    stage_start = perf_now_ns();
+    result = spectrum_ring_commit(output->ring, written);
+    perf_stats_record(PERF_STAGE_FILE_WRITE, perf_now_ns() - stage_start);
+    return (result == SPECTRUM_RING_SUCCESS) ? SP_SUCCESS : SP_ERROR_INVALID_PARAMETER;
+}
+
+// Static helper function (Internal implementation detail)
+// Encode the display spectrum in the configured format and publish it
+static int publish_spectrum(const SignalProcessorConfig* config, const double* f, const dsp_real_t* psd,
+                            int length, double calibration_factor, SpectrumOutput* output) {
+    if (config->output_format == SP_OUTPUT_JSON) {
+        return publish_json(config, f, psd, length, calibration_factor, output);
     }
     
-    if (config->verbose_output) {
-        printf("[params] Successfully loaded %zu samples\n", num_samples);
+    SpectrumFrameEncoding encoding = (config->output_format == SP_OUTPUT_FRAME_I16)
+                                     ? SPECTRUM_FRAME_I16 : SPECTRUM_FRAME_F32;
+    if (config->output_ring_path != NULL) {
+        return publish_to_ring(config, f, psd, length, calibration_factor, encoding, output);
     }
+    return publish_frame_file(config, f, psd, length, calibration_factor, encoding, output);
+}
+
+// Static helper function (Internal implementation detail)
+// Channel detection and spectrum output for PSDs already in ascending absolute frequency (MHz);
+// plan holds the channel bins of the detection spectrum, scratch at least its widest
+// channel, stats one entry per channel and output the encoders reused across cycles
+static int analyze_and_publish(const SignalProcessorConfig* config,
+                               const dsp_real_t* psd_large,
+                               const double* f_small, const dsp_real_t* psd_small, int nperseg_small,
+                               const BandPlan* plan, dsp_real_t* scratch, ChannelStats* stats,
+                               SpectrumOutput* output, bool* signal_detected) {
+    *signal_detected = false;
     
-    // Allocate memory for PSD and frequency arrays
-    psd_large = (double*)malloc(nperseg_large * sizeof(double));
-    f_large = (double*)malloc(nperseg_large * sizeof(double));
-    psd_small = (double*)malloc(nperseg_small * sizeof(double));
-    f_small = (double*)malloc(nperseg_small * sizeof(double));
+    // Calculate calibration factor between large and small PSDs
+    double constante = fabs(fabs(10 * log10(psd_large[0])) - fabs(10 * log10(psd_small[0])));
     
-    if (psd_large == NULL || f_large == NULL || psd_small == NULL || f_small == NULL) {
-        result = SP_ERROR_MEMORY_ALLOC;
-        goto cleanup;
+    // Check each channel for signal presence over the bins compiled for f_large
+    uint64_t stage_start = perf_now_ns();
+    trace_begin("analysis", "detect");
+    if (!calculate_channel_stats(psd_large, plan, scratch, stats)) {
+        trace_end("analysis", "detect");
+        return SP_ERROR_DATA_PROCESSING;
+    }
+    for (int idx = 0; idx < plan->channel_count; idx++) {
+        if (10.0 * log10(stats[idx].max) > config->threshold) {
+            *signal_detected = true;
+        }
     }
     
-    // Calculate power spectral density with different resolutions
-    welch_psd_complex(vector_IQ, num_samples, 20000000, nperseg_large, 0, f_large, psd_large);
-    welch_psd_complex(vector_IQ, num_samples, 20000000, nperseg_small, 0, f_small, psd_small);
+    trace_end("analysis", "detect");
+    perf_stats_record(PERF_STAGE_DETECT, perf_now_ns() - stage_start);
     
-    free(vector_IQ);
-    vector_IQ = NULL;
+    return publish_spectrum(config, f_small, psd_small, nperseg_small, constante, output);
+}
+
+/**
+ * @brief Everything one analysis cycle needs, allocated once
+ *
+ * The PSD/frequency arrays of both resolutions, the median work area, the
+ * output document buffer and the Welch engine (plans, windows, stream
+ * buffers) live for as long as the processor, so a cycle does no heap
+ * allocation.
+ * The channel plan is compiled to bin ranges for the tuned axis and only
+ * recompiled on retune or when a different spectrum layout is published.
+ */
+struct SignalProcessor {
+    SignalProcessorConfig config;       /**< Settings; the input_* fields are not used */
+    WelchEngine*          engine;       /**< config.welch_engine or owned_engine */
+    WelchEngine*          owned_engine; /**< Created here when the caller keeps none */
+    int                   nperseg_large;
+    int                   nperseg_small;
+    dsp_real_t*           psd_large;
+    double*               f_large;
+    dsp_real_t*           psd_small;
+    double*               f_small;
+    dsp_real_t*           scratch;      /**< Median work area */
+    int                   scratch_length;
+    BandPlan              plan;         /**< Channel bins of the detection spectrum */
+    ChannelStats*         channel_stats; /**< Per-channel statistics of the last cycle */
+    SpectrumOutput        output;       /**< Output document/frame buffers */
+    double                fs;           /**< Sampling rate of the engine */
+};
+
+// Static helper function (Internal implementation detail)
+// Grow the median work area; only spectra larger than any seen before allocate
+static bool signal_processor_reserve_scratch(SignalProcessor* processor, int length) {
+    if (length <= processor->scratch_length) {
+        return true;
+    }
+    dsp_real_t* scratch = (dsp_real_t*)realloc(processor->scratch, length * sizeof(dsp_real_t));
+    if (scratch == NULL) {
+        return false;
+    }
+    processor->scratch = scratch;
+    processor->scratch_length = length;
+    return true;
+}
+
+// Implementation for function declared in parameter.h
+SignalProcessor* signal_processor_create(const SignalProcessorConfig* config) {
+    if (config == NULL || output_path(config) == NULL || config->canalization == NULL ||
+        config->bandwidth == NULL || config->canalization_length <= 0) {
+        return NULL;
+    }
     
-    // Rearrange PSD arrays for proper visualization
-    if (!rearrange_welch_psd(psd_large, nperseg_large) || 
-        !rearrange_welch_psd(psd_small, nperseg_small)) {
-        result = SP_ERROR_MEMORY_ALLOC;
-        goto cleanup;
+    int nperseg_large = config->nperseg_large > 0 ? config->nperseg_large : 32768;
+    int nperseg_small = config->nperseg_small > 0 ? config->nperseg_small : 4096;
+    if (nperseg_large % 2 != 0 || nperseg_small % 2 != 0) {
+        return NULL;
+    }
+    
+    SignalProcessor* processor = (SignalProcessor*)calloc(1, sizeof(SignalProcessor));
+    if (processor == NULL) {
+        return NULL;
+    }
+    processor->config = *config;
+    processor->config.input_file_path = NULL;
+    processor->config.input_cs8 = NULL;
+    processor->config.input_samples = 0;
+    processor->nperseg_large = nperseg_large;
+    processor->nperseg_small = nperseg_small;
+    spectrum_output_init(&processor->output);
+    
+    // Fall back to an engine of our own when the caller does not keep one
+    processor->engine = config->welch_engine;
+    if (processor->engine == NULL) {
+        WelchEngineConfig engine_config = {
+            .fs = 20000000,
+            .overlap = 0,
+            .planning = WELCH_PLAN_ESTIMATE,
+            .num_threads = config->num_threads
+        };
+        processor->owned_engine = welch_engine_create(&engine_config);
+        processor->engine = processor->owned_engine;
+    }
+    
+    // Plan both resolutions now so the first cycle does not
+    processor->psd_large = (dsp_real_t*)malloc(nperseg_large * sizeof(dsp_real_t));
+    processor->f_large = (double*)malloc(nperseg_large * sizeof(double));
+    processor->psd_small = (dsp_real_t*)malloc(nperseg_small * sizeof(dsp_real_t));
+    processor->f_small = (double*)malloc(nperseg_small * sizeof(double));
+    processor->channel_stats = (ChannelStats*)malloc(config->canalization_length * sizeof(ChannelStats));
+    
+    if (processor->engine == NULL ||
+        band_plan_init(&processor->plan, config->canalization, config->bandwidth,
+                       config->canalization_length) != BAND_PLAN_SUCCESS ||
+        welch_engine_prepare(processor->engine, nperseg_large) != WELCH_SUCCESS ||
+        welch_engine_prepare(processor->engine, nperseg_small) != WELCH_SUCCESS ||
+        processor->psd_large == NULL || processor->f_large == NULL ||
+        processor->psd_small == NULL || processor->f_small == NULL || processor->channel_stats == NULL ||
+        !signal_processor_reserve_scratch(processor, nperseg_large > nperseg_small ? nperseg_large : nperseg_small)) {
+        signal_processor_destroy(processor);
+        return NULL;
+    }
+    
+    // Map the ring before the first cycle, so the web server finds it (still empty) from startup
+    if (config->output_format != SP_OUTPUT_JSON && config->output_ring_path != NULL &&
+        spectrum_output_open_ring(config, nperseg_small, &processor->output) != SP_SUCCESS) {
+        signal_processor_destroy(processor);
+        return NULL;
     }
     
+    processor->fs = welch_engine_sample_rate(processor->engine);
+    band_plan_compile_uniform(&processor->plan, config->central_freq, processor->fs, nperseg_large);
+    return processor;
+}
+
+// Implementation for function declared in parameter.h
+void signal_processor_destroy(SignalProcessor* processor) {
+    if (processor == NULL) {
+        return;
+    }
+    free(processor->psd_large);
+    free(processor->f_large);
+    free(processor->psd_small);
+    free(processor->f_small);
+    free(processor->scratch);
+    free(processor->channel_stats);
+    band_plan_free(&processor->plan);
+    spectrum_output_free(&processor->output);
+    welch_engine_destroy(processor->owned_engine);
+    free(processor);
+}
+
+// Static helper function (Internal implementation detail)
+// Welch output (FFT order, axis relative to the tuner) to detection and output, in place
+static int signal_processor_finish(SignalProcessor* processor, double* f_large, dsp_real_t* psd_large,
+                                   double* f_small, dsp_real_t* psd_small, uint64_t start_time) {
+    const SignalProcessorConfig* config = &processor->config;
+    int nperseg_large = processor->nperseg_large;
+    int nperseg_small = processor->nperseg_small;
+    
+    uint64_t stage_start = perf_now_ns();
+    
+    // Rearrange PSD arrays for proper visualization
+    rearrange_welch_psd(psd_large, nperseg_large);
+    rearrange_welch_psd(psd_small, nperseg_small);
+    
     // Apply spectral correction to remove DC spike artifacts
     int center_large = nperseg_large / 2;
     int count_large = (int)(nperseg_large * 0.002);
@@ -328,88 +698,251 @@ int process_signal_spectrum(const SignalProcessorConfig* config) {
     for (int i = 0; i < nperseg_small; i++) {
         f_small[i] = (f_small[i] + config->central_freq) / 1e6;
     }
+    perf_stats_record(PERF_STAGE_POSTPROCESS, perf_now_ns() - stage_start);
     
-    // Calculate calibration factor between large and small PSDs
-    double constante = fabs(fabs(10 * log10(psd_large[0])) - fabs(10 * log10(psd_small[0])));
-    
-    // Find noise floor
-    float noise = find_min(psd_large, nperseg_large);
+    // Same axis as last cycle unless the processor was retuned: nothing to recompile
+    band_plan_compile_uniform(&processor->plan, config->central_freq, processor->fs, nperseg_large);
     
-    int N_f = nperseg_large;
     bool signal_detected = false;
+    int result = analyze_and_publish(config, psd_large,
+                                     f_small, psd_small, nperseg_small,
+                                     &processor->plan, processor->scratch, processor->channel_stats,
+                                     &processor->output, &signal_detected);
     
-    // Check each channel for signal presence
-    for (int idx = 0; idx < config->canalization_length; idx++) {
-        double center_freq = config->canalization[idx];
-        double bw = config->bandwidth[idx];
-        
-        double target_lower_freq = center_freq - bw / 2;
-        double target_upper_freq = center_freq + bw / 2;
-        
-        int lower_index = find_closest_index(f_large, N_f, target_lower_freq);
-        int upper_index = find_closest_index(f_large, N_f, target_upper_freq);
-        
-        if (lower_index > upper_index) {
-            int temp = lower_index;
-            lower_index = upper_index;
-            upper_index = temp;
-        }
-        
-        if (lower_index < 0) lower_index = 0;
-        if (upper_index >= N_f) upper_index = N_f - 1;
-        
-        int range_length = upper_index - lower_index + 1;
-        
-        if (range_length > 0) {
-            double power_max = find_max(psd_large, lower_index, upper_index);
-            double power = calculate_median(psd_large, lower_index, upper_index);
-            double snr = 10.0 * log10(power_max / noise);
-            
-            if (10.0 * log10(power_max) > config->threshold) {
-                signal_detected = true;
-            }
-        }
+    if (config->verbose_output && result == SP_SUCCESS) {
+        double processing_time = (perf_now_ns() - start_time) / 1e9;
+        printf("[params] Processing completed in %.3f seconds\n", processing_time);
+        printf("[params] Signal %s\n", signal_detected ? "DETECTED" : "NOT DETECTED");
     }
     
-    // Create JSON representation of signal data
-    cJSON *json_data = create_signal_json(
-        f_small,
-        psd_small,
-        nperseg_small,
-        constante,
-        config->canalization,
-        config->bandwidth,
-        config->canalization_length,
-        config->threshold,
-        noise
-    );
+    return result;
+}
+
+// Static helper function (Internal implementation detail)
+// Welch pass over an open capture, DC cleanup, detection and output
+static int signal_processor_run(SignalProcessor* processor, CS8_IQ_Context* iq_ctx) {
+    const SignalProcessorConfig* config = &processor->config;
+    int nperseg_large = processor->nperseg_large;
+    int nperseg_small = processor->nperseg_small;
+    dsp_real_t* psd_large = processor->psd_large;
+    double* f_large = processor->f_large;
+    dsp_real_t* psd_small = processor->psd_small;
+    double* f_small = processor->f_small;
+    
+    uint64_t start_time = 0;
+    if (config->verbose_output) {
+        start_time = perf_now_ns();
+        printf("[params] Starting signal processing...\n");
+        printf("[params] Streaming %zu samples\n", iq_ctx->file_size / 2);
+    }
     
-    if (json_data == NULL) {
-        result = SP_ERROR_MEMORY_ALLOC;
-        goto cleanup;
+    // Calculate power spectral density with both resolutions in one pass over the capture
+    WelchResolution resolutions[] = {
+        { nperseg_large, f_large, psd_large },
+        { nperseg_small, f_small, psd_small }
+    };
+    bool same_resolution = (nperseg_large == nperseg_small);
+    int error_code = welch_engine_psd_multi(processor->engine, iq_ctx, resolutions, same_resolution ? 1 : 2);
+    if (error_code == WELCH_SUCCESS && same_resolution) {
+        memcpy(psd_small, psd_large, nperseg_small * sizeof(dsp_real_t));
+        memcpy(f_small, f_large, nperseg_small * sizeof(double));
     }
     
-    // Save JSON to output file
-    result = save_json_to_file(json_data, config->output_json_path);
-    cJSON_Delete(json_data);
+    cs8_iq_close_context(iq_ctx);
+    
+    if (error_code != WELCH_SUCCESS) {
+        fprintf(stderr, "[params] Error computing PSD: %s\n", welch_engine_error_string(error_code));
+        return (error_code == WELCH_ERROR_MEMORY) ? SP_ERROR_MEMORY_ALLOC : SP_ERROR_DATA_PROCESSING;
+    }
     
     if (config->verbose_output) {
-        end_time = clock();
-        double processing_time = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
-        printf("[params] Processing completed in %.3f seconds\n", processing_time);
+        printf("[welch] PSD computation complete.\n");
+    }
+    
+    return signal_processor_finish(processor, f_large, psd_large, f_small, psd_small, start_time);
+}
+
+// Implementation for function declared in parameter.h
+int signal_processor_retune(SignalProcessor* processor, uint64_t central_freq) {
+    if (processor == NULL) {
+        return SP_ERROR_NULL_POINTER;
+    }
+    processor->config.central_freq = central_freq;
+    int result = band_plan_compile_uniform(&processor->plan, central_freq, processor->fs,
+                                           processor->nperseg_large);
+    return result == BAND_PLAN_SUCCESS ? SP_SUCCESS : SP_ERROR_INVALID_PARAMETER;
+}
+
+// Implementation for function declared in parameter.h
+int signal_processor_process_file(SignalProcessor* processor, const char* input_file_path) {
+    if (processor == NULL || input_file_path == NULL) {
+        return SP_ERROR_NULL_POINTER;
+    }
+    
+    // Open the capture; samples are converted segment by segment while streaming
+    CS8_IQ_Context iq_ctx;
+    int error_code = cs8_iq_init_context(&iq_ctx, input_file_path, processor->config.use_mmap);
+    if (error_code != CS8_IQ_SUCCESS) {
+        fprintf(stderr, "[params] Error loading CS8 data: %s\n", cs8_iq_error_string(error_code));
+        return SP_ERROR_FILE_IO;
+    }
+    return signal_processor_run(processor, &iq_ctx);
+}
+
+// Implementation for function declared in parameter.h
+int signal_processor_process_cs8(SignalProcessor* processor, const int8_t* input_cs8, size_t input_samples) {
+    if (processor == NULL || input_cs8 == NULL) {
+        return SP_ERROR_NULL_POINTER;
+    }
+    
+    CS8_IQ_Context iq_ctx;
+    int error_code = cs8_iq_init_memory_context(&iq_ctx, input_cs8, input_samples);
+    if (error_code != CS8_IQ_SUCCESS) {
+        fprintf(stderr, "[params] Error loading CS8 data: %s\n", cs8_iq_error_string(error_code));
+        return SP_ERROR_FILE_IO;
+    }
+    return signal_processor_run(processor, &iq_ctx);
+}
+
+// Implementation for function declared in parameter.h
+int signal_processor_process_welch(SignalProcessor* processor, double* f_large, dsp_real_t* psd_large,
+                                   double* f_small, dsp_real_t* psd_small) {
+    if (processor == NULL || f_large == NULL || psd_large == NULL || f_small == NULL || psd_small == NULL) {
+        return SP_ERROR_NULL_POINTER;
+    }
+    uint64_t start_time = perf_now_ns();
+    return signal_processor_finish(processor, f_large, psd_large, f_small, psd_small, start_time);
+}
+
+// Implementation for function declared in parameter.h
+int signal_processor_process_psd(SignalProcessor* processor,
+                                 const double* f_large, const dsp_real_t* psd_large, int n_large,
+                                 const double* f_small, const dsp_real_t* psd_small, int n_small) {
+    if (processor == NULL || f_large == NULL || psd_large == NULL || f_small == NULL || psd_small == NULL) {
+        return SP_ERROR_NULL_POINTER;
+    }
+    if (n_large <= 0 || n_small <= 0) {
+        return SP_ERROR_INVALID_PARAMETER;
+    }
+    // Stitched spectra can be wider than one segment; sized once, on the first sweep
+    if (!signal_processor_reserve_scratch(processor, n_large)) {
+        return SP_ERROR_MEMORY_ALLOC;
+    }
+    
+    const SignalProcessorConfig* config = &processor->config;
+    uint64_t start_time = perf_now_ns();
+    band_plan_compile_axis(&processor->plan, f_large, n_large);
+    bool signal_detected = false;
+    int result = analyze_and_publish(config, psd_large,
+                                     f_small, psd_small, n_small,
+                                     &processor->plan, processor->scratch, processor->channel_stats,
+                                     &processor->output, &signal_detected);
+    
+    if (config->verbose_output && result == SP_SUCCESS) {
+        double processing_time = (perf_now_ns() - start_time) / 1e9;
+        printf("[params] Analysis completed in %.3f seconds\n", processing_time);
         printf("[params] Signal %s\n", signal_detected ? "DETECTED" : "NOT DETECTED");
     }
+    return result;
+}
+
+// Implementation for function declared in parameter.h
+int process_signal_spectrum(const SignalProcessorConfig* config) {
+    if (config == NULL || (config->input_file_path == NULL && config->input_cs8 == NULL) || 
+        output_path(config) == NULL || config->canalization == NULL || 
+        config->bandwidth == NULL || config->canalization_length <= 0) {
+        return SP_ERROR_NULL_POINTER;
+    }
+    
+    int nperseg_large = config->nperseg_large > 0 ? config->nperseg_large : 32768;
+    int nperseg_small = config->nperseg_small > 0 ? config->nperseg_small : 4096;
+    
+    // A ring recreated on every call would restart its frame numbers each time
+    if (nperseg_large % 2 != 0 || nperseg_small % 2 != 0 || config->output_ring_path != NULL) {
+        return SP_ERROR_INVALID_PARAMETER;
+    }
+    
+    // One-shot processor: everything it holds is freed again after this capture
+    SignalProcessor* processor = signal_processor_create(config);
+    if (processor == NULL) {
+        return SP_ERROR_MEMORY_ALLOC;
+    }
+    
+    int result;
+    if (config->input_cs8 != NULL) {
+        result = signal_processor_process_cs8(processor, config->input_cs8, config->input_samples);
+    } else {
+        result = signal_processor_process_file(processor, config->input_file_path);
+    }
     
-cleanup:
-    free(psd_large);
-    free(f_large);
-    free(psd_small);
-    free(f_small);
-    free(vector_IQ); 
+    signal_processor_destroy(processor);
+    return result;
+}
+
+// Implementation for function declared in parameter.h
+int process_signal_psd(const SignalProcessorConfig* config,
+                       const double* f_large, const dsp_real_t* psd_large, int n_large,
+                       const double* f_small, const dsp_real_t* psd_small, int n_small) {
+    if (config == NULL || output_path(config) == NULL || config->canalization == NULL ||
+        config->bandwidth == NULL || config->canalization_length <= 0 ||
+        f_large == NULL || psd_large == NULL || f_small == NULL || psd_small == NULL) {
+        return SP_ERROR_NULL_POINTER;
+    }
+    if (n_large <= 0 || n_small <= 0 || config->output_ring_path != NULL) {
+        return SP_ERROR_INVALID_PARAMETER;
+    }
     
+    uint64_t start_time = perf_now_ns();
+    BandPlan plan;
+    if (band_plan_init(&plan, config->canalization, config->bandwidth,
+                       config->canalization_length) != BAND_PLAN_SUCCESS) {
+        return SP_ERROR_MEMORY_ALLOC;
+    }
+    dsp_real_t* scratch = (dsp_real_t*)malloc(n_large * sizeof(dsp_real_t));
+    ChannelStats* stats = (ChannelStats*)malloc(config->canalization_length * sizeof(ChannelStats));
+    if (scratch == NULL || stats == NULL) {
+        free(scratch);
+        free(stats);
+        band_plan_free(&plan);
+        return SP_ERROR_MEMORY_ALLOC;
+    }
+    SpectrumOutput output;
+    spectrum_output_init(&output);
+    band_plan_compile_axis(&plan, f_large, n_large);
+    bool signal_detected = false;
+    int result = analyze_and_publish(config, psd_large,
+                                     f_small, psd_small, n_small, &plan, scratch, stats,
+                                     &output, &signal_detected);
+    spectrum_output_free(&output);
+    free(scratch);
+    free(stats);
+    band_plan_free(&plan);
+    
+    if (config->verbose_output && result == SP_SUCCESS) {
+        double processing_time = (perf_now_ns() - start_time) / 1e9;
+        printf("[params] Analysis completed in %.3f seconds\n", processing_time);
+        printf("[params] Signal %s\n", signal_detected ? "DETECTED" : "NOT DETECTED");
+    }
     return result;
 }
 
+// Implementation for function declared in parameter.h
+int signal_processor_parse_output_format(const char* name, SPOutputFormat* format) {
+    if (name == NULL || format == NULL) {
+        return SP_ERROR_NULL_POINTER;
+    }
+    if (strcmp(name, "json") == 0) {
+        *format = SP_OUTPUT_JSON;
+    } else if (strcmp(name, "f32") == 0) {
+        *format = SP_OUTPUT_FRAME_F32;
+    } else if (strcmp(name, "i16") == 0) {
+        *format = SP_OUTPUT_FRAME_I16;
+    } else {
+        return SP_ERROR_INVALID_PARAMETER;
+    }
+    return SP_SUCCESS;
+}
+
 // Implementation for function declared in parameter.h
 const char* get_signal_processor_error(int error_code) {
     switch (error_code) {
@@ -27,6 +27,7 @@
 #include "../Modules/CS8toIQ.h"
 #include "../Modules/IQ.h"
 #include "../Modules/welch.h"
+#include "../Modules/welch_engine.h"
 #include "../Modules/cJSON.h"
 #include "../Modules/find_closest_index.h"
 
@@ -51,12 +52,25 @@ typedef enum {
     SP_ERROR_DATA_PROCESSING   = -5  /**< Data processing error */
 } SPErrorCode;
 
+/**
+ * @enum SPOutputFormat
+ * @brief Encoding of the spectrum published every cycle
+ */
+typedef enum {
+    SP_OUTPUT_JSON      = 0, /**< {"data": {...}} document at output_json_path (default) */
+    SP_OUTPUT_FRAME_F32 = 1, /**< Binary frame, float32 dB, at output_frame_path (spectrum_frame.h) */
+    SP_OUTPUT_FRAME_I16 = 2  /**< Binary frame, int16 centi-dB, at output_frame_path */
+} SPOutputFormat;
+
 /**
  * @struct SignalProcessorConfig
  * @brief Configuration for spectrum processing
  *
  * Holds all parameters required to perform spectrum analysis:
  * - input_file_path: Path to the raw signal data file
+ * - input_cs8:       In-memory CS8 capture used instead of input_file_path
+ *                    (zero-disk acquisition); NULL to read the file
+ * - input_samples:   Number of I/Q pairs in input_cs8
  * - central_freq:    Center frequency in Hertz
  * - nperseg_large:   Segment size for coarse analysis
  * - nperseg_small:   Segment size for fine analysis
@@ -65,11 +79,23 @@ typedef enum {
  * - bandwidth:       Array of channel bandwidths (MHz)
  * - canalization_length: Number of channels defined
  * - output_json_path: Path where JSON results will be written
+ * - output_format:   JSON document (default) or binary frame
+ * - output_frame_path: Path of the binary frame; only needed for the frame formats
+ * - output_ring_path: Frame formats only: publish into a shared-memory ring of
+ *                    output_ring_slots frames (spectrum_ring.h) instead of output_frame_path;
+ *                    SignalProcessor only, the one-shot wrappers reject it
+ * - output_ring_slots: Frames kept in the ring (>= 2)
  * - use_mmap:        Enable memory-mapped file access
  * - verbose_output:  Enable detailed console logging
+ * - welch_engine:    Optional persistent Welch engine (cached plans/windows);
+ *                    when NULL a one-shot FFTW_ESTIMATE engine is used per call
+ * - num_threads:     Welch worker threads (0/1 serial, N, or WELCH_THREADS_AUTO);
+ *                    a caller-supplied welch_engine should be created with the same value
  */
 typedef struct {
     const char* input_file_path;
+    const int8_t* input_cs8;
+    size_t      input_samples;
     uint64_t    central_freq;
     int         nperseg_large;
     int         nperseg_small;
@@ -78,10 +104,112 @@ typedef struct {
     double*     bandwidth;
     int         canalization_length;
     const char* output_json_path;
+    SPOutputFormat output_format;
+    const char* output_frame_path;
+    const char* output_ring_path;
+    int         output_ring_slots;
     bool        use_mmap;
     bool        verbose_output;
+    WelchEngine* welch_engine;
+    int         num_threads;
 } SignalProcessorConfig;
 
+/**
+ * @brief Opaque analysis context created once from a SignalProcessorConfig.
+ *
+ * Owns the PSD and frequency arrays of both resolutions, the median work
+ * area, the channel plan compiled to bin ranges and, when the configuration
+ * has no welch_engine, its own engine with both segment lengths planned, and
+ * the output buffer. Cycles run through a processor reuse all of it, so in
+ * steady state nothing is allocated. The configuration is copied; the arrays
+ * and strings it points to must outlive the processor.
+ *
+ * @code
+ * SignalProcessor* processor = signal_processor_create(&config);
+ * while (running) {
+ *     signal_processor_process_cs8(processor, capture, samples);
+ * }
+ * signal_processor_destroy(processor);
+ * @endcode
+ */
+typedef struct SignalProcessor SignalProcessor;
+
+/**
+ * @brief Allocate every buffer and plan used by the analysis cycles.
+ *
+ * The input_file_path/input_cs8/input_samples fields are ignored; each
+ * cycle passes its own capture.
+ *
+ * @param config Analysis settings (copied)
+ * @return New processor, or NULL on invalid configuration or allocation failure
+ */
+SignalProcessor* signal_processor_create(const SignalProcessorConfig* config);
+
+/**
+ * @brief Free a processor and the engine it created (NULL is a no-op).
+ */
+void signal_processor_destroy(SignalProcessor* processor);
+
+/**
+ * @brief Change the tuned frequency of the following captures.
+ *
+ * Recompiles the channel bin ranges for the new axis; cycles at an
+ * unchanged frequency reuse them.
+ *
+ * @param processor Processor handle
+ * @param central_freq New center frequency in Hertz
+ * @return SP_SUCCESS on success, or an SPErrorCode on failure
+ */
+int signal_processor_retune(SignalProcessor* processor, uint64_t central_freq);
+
+/**
+ * @brief Analyze a CS8 capture file and write the JSON output.
+ *
+ * @param processor Processor handle
+ * @param input_file_path Raw capture, read through mmap when config.use_mmap is set
+ * @return SP_SUCCESS on success, or an SPErrorCode on failure
+ */
+int signal_processor_process_file(SignalProcessor* processor, const char* input_file_path);
+
+/**
+ * @brief Analyze an in-memory CS8 capture and write the JSON output.
+ *
+ * @param processor Processor handle
+ * @param input_cs8 Interleaved I/Q bytes (zero-disk acquisition)
+ * @param input_samples Number of I/Q pairs
+ * @return SP_SUCCESS on success, or an SPErrorCode on failure
+ */
+int signal_processor_process_cs8(SignalProcessor* processor, const int8_t* input_cs8, size_t input_samples);
+
+/**
+ * @brief Detect channels and write the output from Welch PSDs computed elsewhere.
+ *
+ * Takes both resolutions as a Welch estimator returns them (FFT order, axis
+ * relative to the tuner, e.g. welch_stream_snapshot()) and runs the same
+ * steps as a capture: FFT shift, DC correction, absolute frequencies,
+ * detection and output. The arrays are modified in place.
+ *
+ * @param processor Processor handle
+ * @param f_large Frequency bins of the detection resolution (nperseg_large)
+ * @param psd_large PSD of the detection resolution (nperseg_large)
+ * @param f_small Frequency bins of the display resolution (nperseg_small)
+ * @param psd_small PSD of the display resolution (nperseg_small)
+ * @return SP_SUCCESS on success, or an SPErrorCode on failure
+ */
+int signal_processor_process_welch(SignalProcessor* processor, double* f_large, dsp_real_t* psd_large,
+                                   double* f_small, dsp_real_t* psd_small);
+
+/**
+ * @brief process_signal_psd() with the processor's work area.
+ *
+ * The median work area grows to n_large on the first call if needed.
+ *
+ * @return SP_SUCCESS on success, or an SPErrorCode on failure
+ */
+int signal_processor_process_psd(SignalProcessor* processor,
+                                 const double* f_large, const dsp_real_t* psd_large, int n_large,
+                                 const double* f_small, const dsp_real_t* psd_small, int n_small);
+
 /**
  * @brief Analyze signal spectrum and produce JSON output.
  *
@@ -92,11 +220,49 @@ typedef struct {
  * 4. Detects active channels and timestamps
  * 5. Writes results to a JSON file
  *
+ * One-shot wrapper creating and destroying a SignalProcessor around the
+ * capture; loops should keep a processor instead. A shared-memory ring
+ * (output_ring_path) is rejected with SP_ERROR_INVALID_PARAMETER: it would
+ * be recreated, and its frame numbers restarted, on every call. Publish to
+ * a ring through a persistent SignalProcessor.
+ *
  * @param config Pointer to a fully populated SignalProcessorConfig
  * @return SP_SUCCESS on success, or an SPErrorCode on failure
  */
 int process_signal_spectrum(const SignalProcessorConfig* config);
 
+/**
+ * @brief Detect channels and write the JSON output from precomputed PSDs.
+ *
+ * Runs the analysis half of process_signal_spectrum() on spectra produced
+ * elsewhere, e.g. stitched by the sweep engine. Both spectra must be in
+ * ascending absolute frequency (MHz) with the DC artifacts already removed;
+ * input_file_path/input_cs8, nperseg_* and central_freq are ignored. As in
+ * process_signal_spectrum(), output_ring_path is rejected with
+ * SP_ERROR_INVALID_PARAMETER; use signal_processor_process_psd() instead.
+ *
+ * @param config Output path, channel plan, threshold and verbosity
+ * @param f_large Frequencies of the detection spectrum in MHz
+ * @param psd_large Detection spectrum (linear power)
+ * @param n_large Number of bins in the detection spectrum
+ * @param f_small Frequencies of the display spectrum in MHz
+ * @param psd_small Display spectrum (linear power)
+ * @param n_small Number of bins in the display spectrum
+ * @return SP_SUCCESS on success, or an SPErrorCode on failure
+ */
+int process_signal_psd(const SignalProcessorConfig* config,
+                       const double* f_large, const dsp_real_t* psd_large, int n_large,
+                       const double* f_small, const dsp_real_t* psd_small, int n_small);
+
+/**
+ * @brief Map an output format name ("json", "f32", "i16") to SPOutputFormat.
+ *
+ * @param name Format name, as in CORE_SPECTRUM_FORMAT
+ * @param format Receives the format on success
+ * @return SP_SUCCESS, or SP_ERROR_INVALID_PARAMETER for an unknown name
+ */
+int signal_processor_parse_output_format(const char* name, SPOutputFormat* format);
+
 /**
  * @brief Retrieve a human-readable message for an error code.
  *
@@ -0,0 +1,80 @@
+/**
+ * @file parameter_internal.h
+ * @brief Spectrum helpers of parameter.c exposed for benchmarks.
+ * @ingroup signal_processor
+ *
+ * Not part of the public signal processor interface: callers outside the
+ * core and Bench/ should use process_signal_spectrum()/process_signal_psd().
+ */
+
+#ifndef SIGNAL_PROCESSOR_INTERNAL_H
+#define SIGNAL_PROCESSOR_INTERNAL_H
+
+#include <stdbool.h>
+#include "../Modules/parameter.h"
+#include "../Modules/band_plan.h"
+
+/**
+ * @brief Power statistics of one channel's bins (linear PSD units)
+ */
+typedef struct {
+    double median;
+    double max;
+    double mean;
+    double min;
+} ChannelStats;
+
+/**
+ * @brief Median of array[start, end) by selection (introselect) in scratch.
+ * @param scratch At least end - start elements, or NULL to allocate a copy
+ * @return Median value, or NAN on invalid range or allocation failure
+ */
+double calculate_median(const dsp_real_t* array, int start, int end, dsp_real_t* scratch);
+
+/**
+ * @brief Median, max, mean and min of every channel of a compiled plan.
+ *
+ * Each channel's bins are read once. Max, mean and min cover both range
+ * ends; the median covers [lower_index, upper_index), the half-open range
+ * calculate_median() is called with, and is NAN for a one-bin channel. It
+ * is selected in scratch, so nothing is allocated.
+ *
+ * @param psd Spectrum the plan was compiled for
+ * @param scratch At least as many elements as the widest channel
+ * @param stats One entry per channel of the plan
+ * @return false on invalid arguments or a plan not compiled
+ */
+bool calculate_channel_stats(const dsp_real_t* psd, const BandPlan* plan, dsp_real_t* scratch,
+                             ChannelStats* stats);
+
+/**
+ * @brief Swap the two halves of an FFT-ordered PSD in place so DC sits at length / 2.
+ * @return false on invalid length
+ */
+bool rearrange_welch_psd(dsp_real_t* psd, int length);
+
+/**
+ * @brief Overwrite the DC spike around center_index with neighbouring bins.
+ * @return false on invalid arguments
+ */
+bool apply_spectral_correction(dsp_real_t* psd, int length, int center_index, int correction_width);
+
+/**
+ * @brief Build the {"data": {...}} document published to the web interface.
+ *
+ * cJSON reference for spectrum_json_build(), which the processor uses to
+ * write the same document without the tree.
+ * @return New cJSON tree owned by the caller, or NULL on failure
+ */
+cJSON* create_signal_json(const double* f, const dsp_real_t* psd, int length,
+                          double calibration_factor, const double* canalization,
+                          const double* bandwidth, int canalization_length,
+                          int threshold, double noise_floor);
+
+/**
+ * @brief Print a cJSON tree to filename.
+ * @return SP_SUCCESS or an SPErrorCode
+ */
+int save_json_to_file(const cJSON* json_obj, const char* filename);
+
+#endif // SIGNAL_PROCESSOR_INTERNAL_H
@@ -0,0 +1,353 @@
+/**
+ * @file perf_stats.c
+ * @brief Log-linear latency histograms and the periodic stats file writer.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "perf_stats.h"
+
+/* Values below PERF_STATS_SUB_BUCKETS ns get one bucket each; above, every
+ * power of two [2^e, 2^(e+1)) is split in PERF_STATS_SUB_BUCKETS buckets */
+#define PERF_SUB_BITS 5
+#define PERF_STATS_BUCKETS (PERF_STATS_SUB_BUCKETS * (PERF_STATS_MAGNITUDES - PERF_SUB_BITS + 1))
+
+_Static_assert(PERF_STATS_SUB_BUCKETS == (1 << PERF_SUB_BITS), "PERF_SUB_BITS must match PERF_STATS_SUB_BUCKETS");
+
+typedef struct {
+    atomic_uint_fast64_t buckets[PERF_STATS_BUCKETS];
+    atomic_uint_fast64_t sum_ns;
+    atomic_uint_fast64_t max_ns;
+    atomic_uint_fast64_t interval_max_ns;
+} PerfHistogram;
+
+/* Plain copy of a histogram, for summaries and interval differences */
+typedef struct {
+    uint64_t buckets[PERF_STATS_BUCKETS];
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+} PerfSnapshot;
+
+static PerfHistogram histograms[PERF_STAGE_COUNT];
+
+/* Writer state: last dump, serialized by writer_lock */
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static PerfSnapshot previous[PERF_STAGE_COUNT];
+static uint64_t previous_dump_ns;
+static uint64_t start_ns;
+
+/* Background writer */
+static pthread_t dumper_thread;
+static pthread_mutex_t dumper_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dumper_cond = PTHREAD_COND_INITIALIZER;
+static bool dumper_running = false;
+static bool dumper_stop = false;
+static char* dumper_path = NULL;
+static unsigned dumper_period_s = 0;
+
+static const char* perf_stage_names[PERF_STAGE_COUNT] = {
+    "acquire",
+    "convert",
+    "welch",
+    "postprocess",
+    "detect",
+    "json_build",
+    "file_write"
+};
+
+static const char* perf_stats_error_messages[] = {
+    "Success",
+    "Invalid argument",
+    "Stats file could not be written",
+    "Stats writer thread could not be started"
+};
+
+const char* perf_stats_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(perf_stats_error_messages) / sizeof(perf_stats_error_messages[0]))) {
+        return perf_stats_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+const char* perf_stage_name(PerfStage stage) {
+    return (stage >= 0 && stage < PERF_STAGE_COUNT) ? perf_stage_names[stage] : "unknown";
+}
+
+uint64_t perf_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int perf_bucket_index(uint64_t value) {
+    if (value < PERF_STATS_SUB_BUCKETS) {
+        return (int)value;
+    }
+    int e = 63 - __builtin_clzll(value);
+    if (e >= PERF_STATS_MAGNITUDES) {
+        return PERF_STATS_BUCKETS - 1;
+    }
+    int shift = e - PERF_SUB_BITS;
+    int sub = (int)(value >> shift) - PERF_STATS_SUB_BUCKETS;
+    return PERF_STATS_SUB_BUCKETS * (shift + 1) + sub;
+}
+
+/* Midpoint of a bucket, the value reported for ranks that fall in it */
+static uint64_t perf_bucket_value(int index) {
+    if (index < PERF_STATS_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+    int shift = index / PERF_STATS_SUB_BUCKETS - 1;
+    uint64_t sub = (uint64_t)(index % PERF_STATS_SUB_BUCKETS + PERF_STATS_SUB_BUCKETS);
+    return (sub << shift) + ((1ull << shift) >> 1);
+}
+
+static void perf_atomic_max(atomic_uint_fast64_t* target, uint64_t value) {
+    uint_fast64_t current = atomic_load_explicit(target, memory_order_relaxed);
+    while (value > current &&
+           !atomic_compare_exchange_weak_explicit(target, &current, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void perf_stats_record(PerfStage stage, uint64_t duration_ns) {
+    if (stage < 0 || stage >= PERF_STAGE_COUNT) {
+        return;
+    }
+    PerfHistogram* h = &histograms[stage];
+    atomic_fetch_add_explicit(&h->buckets[perf_bucket_index(duration_ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_ns, duration_ns, memory_order_relaxed);
+    perf_atomic_max(&h->max_ns, duration_ns);
+    perf_atomic_max(&h->interval_max_ns, duration_ns);
+}
+
+static void perf_snapshot(PerfStage stage, PerfSnapshot* s) {
+    PerfHistogram* h = &histograms[stage];
+    s->count = 0;
+    for (int i = 0; i < PERF_STATS_BUCKETS; i++) {
+        s->buckets[i] = atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        s->count += s->buckets[i];   /* Consistent with the buckets even while recording */
+    }
+    s->sum_ns = atomic_load_explicit(&h->sum_ns, memory_order_relaxed);
+    s->max_ns = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+}
+
+static uint64_t perf_percentile(const PerfSnapshot* s, double q, uint64_t max_ns) {
+    uint64_t rank = (uint64_t)(q * s->count + 0.999999);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < PERF_STATS_BUCKETS; i++) {
+        seen += s->buckets[i];
+        if (seen >= rank) {
+            uint64_t value = perf_bucket_value(i);
+            return value < max_ns ? value : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+static void perf_summarize(const PerfSnapshot* s, uint64_t max_ns, PerfStageSummary* summary) {
+    memset(summary, 0, sizeof(*summary));
+    if (s->count == 0) {
+        return;
+    }
+    summary->count = s->count;
+    summary->mean_ns = (double)s->sum_ns / s->count;
+    summary->p50_ns = perf_percentile(s, 0.50, max_ns);
+    summary->p90_ns = perf_percentile(s, 0.90, max_ns);
+    summary->p99_ns = perf_percentile(s, 0.99, max_ns);
+    summary->p999_ns = perf_percentile(s, 0.999, max_ns);
+    summary->max_ns = max_ns;
+}
+
+void perf_stats_summary(PerfStage stage, PerfStageSummary* summary) {
+    if (stage < 0 || stage >= PERF_STAGE_COUNT) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+    PerfSnapshot* s = (PerfSnapshot*)malloc(sizeof(PerfSnapshot));
+    if (s == NULL) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+    perf_snapshot(stage, s);
+    perf_summarize(s, s->max_ns, summary);
+    free(s);
+}
+
+void perf_stats_reset(void) {
+    pthread_mutex_lock(&writer_lock);
+    for (int stage = 0; stage < PERF_STAGE_COUNT; stage++) {
+        PerfHistogram* h = &histograms[stage];
+        for (int i = 0; i < PERF_STATS_BUCKETS; i++) {
+            atomic_store_explicit(&h->buckets[i], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&h->sum_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&h->max_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&h->interval_max_ns, 0, memory_order_relaxed);
+    }
+    memset(previous, 0, sizeof(previous));
+    previous_dump_ns = 0;
+    pthread_mutex_unlock(&writer_lock);
+}
+
+static void perf_write_summary(FILE* file, const char* name, const PerfStageSummary* s) {
+    fprintf(file, "\"%s\": {\"count\": %llu, \"mean_us\": %.1f, \"p50_us\": %.1f, \"p90_us\": %.1f, "
+                  "\"p99_us\": %.1f, \"p999_us\": %.1f, \"max_us\": %.1f}",
+            name, (unsigned long long)s->count, s->mean_ns / 1e3, s->p50_ns / 1e3, s->p90_ns / 1e3,
+            s->p99_ns / 1e3, s->p999_ns / 1e3, s->max_ns / 1e3);
+}
+
+int perf_stats_write(const char* path) {
+    if (path == NULL) {
+        return PERF_STATS_ERROR_PARAM;
+    }
+
+    PerfSnapshot* current = (PerfSnapshot*)malloc(sizeof(PerfSnapshot));
+    PerfSnapshot* interval = (PerfSnapshot*)malloc(sizeof(PerfSnapshot));
+    size_t tmp_length = strlen(path) + 8;
+    char* tmp_path = (char*)malloc(tmp_length);
+    if (current == NULL || interval == NULL || tmp_path == NULL) {
+        free(current);
+        free(interval);
+        free(tmp_path);
+        return PERF_STATS_ERROR_FILE;
+    }
+    snprintf(tmp_path, tmp_length, "%s.tmp", path);
+
+    pthread_mutex_lock(&writer_lock);
+    uint64_t now = perf_now_ns();
+    if (start_ns == 0) start_ns = now;
+    if (previous_dump_ns == 0) previous_dump_ns = start_ns;
+
+    int result = PERF_STATS_SUCCESS;
+    FILE* file = fopen(tmp_path, "w");
+    if (file == NULL) {
+        result = PERF_STATS_ERROR_FILE;
+    } else {
+        fprintf(file, "{\n  \"timestamp\": %lld,\n  \"uptime_s\": %.1f,\n  \"interval_s\": %.1f,\n  \"stages\": {\n",
+                (long long)time(NULL), (now - start_ns) / 1e9, (now - previous_dump_ns) / 1e9);
+
+        for (int stage = 0; stage < PERF_STAGE_COUNT; stage++) {
+            PerfStageSummary total, recent;
+            perf_snapshot((PerfStage)stage, current);
+            perf_summarize(current, current->max_ns, &total);
+
+            interval->count = current->count - previous[stage].count;
+            interval->sum_ns = current->sum_ns - previous[stage].sum_ns;
+            for (int i = 0; i < PERF_STATS_BUCKETS; i++) {
+                interval->buckets[i] = current->buckets[i] - previous[stage].buckets[i];
+            }
+            uint64_t interval_max = atomic_exchange_explicit(&histograms[stage].interval_max_ns, 0,
+                                                             memory_order_relaxed);
+            perf_summarize(interval, interval_max, &recent);
+            previous[stage] = *current;
+
+            fprintf(file, "    \"%s\": {", perf_stage_names[stage]);
+            perf_write_summary(file, "total", &total);
+            fprintf(file, ", ");
+            perf_write_summary(file, "interval", &recent);
+            fprintf(file, "}%s\n", stage + 1 < PERF_STAGE_COUNT ? "," : "");
+        }
+        fprintf(file, "  }\n}\n");
+
+        if (fclose(file) != 0 || rename(tmp_path, path) != 0) {
+            result = PERF_STATS_ERROR_FILE;
+        }
+    }
+    previous_dump_ns = now;
+    pthread_mutex_unlock(&writer_lock);
+
+    free(current);
+    free(interval);
+    free(tmp_path);
+    return result;
+}
+
+static void* perf_dumper_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&dumper_lock);
+    while (!dumper_stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += dumper_period_s;
+        while (!dumper_stop &&
+               pthread_cond_timedwait(&dumper_cond, &dumper_lock, &deadline) == 0) {
+        }
+        if (dumper_stop) {
+            break;
+        }
+        pthread_mutex_unlock(&dumper_lock);
+        int result = perf_stats_write(dumper_path);
+        if (result != PERF_STATS_SUCCESS) {
+            fprintf(stderr, "[perf] %s: %s\n", dumper_path, perf_stats_error_string(result));
+        }
+        pthread_mutex_lock(&dumper_lock);
+    }
+    pthread_mutex_unlock(&dumper_lock);
+    return NULL;
+}
+
+int perf_stats_start(const char* path, unsigned period_s) {
+    if (path == NULL || period_s == 0) {
+        return PERF_STATS_ERROR_PARAM;
+    }
+
+    pthread_mutex_lock(&dumper_lock);
+    if (dumper_running) {
+        pthread_mutex_unlock(&dumper_lock);
+        return PERF_STATS_ERROR_PARAM;
+    }
+    dumper_path = strdup(path);
+    dumper_period_s = period_s;
+    dumper_stop = false;
+    if (dumper_path == NULL) {
+        pthread_mutex_unlock(&dumper_lock);
+        return PERF_STATS_ERROR_PARAM;
+    }
+
+    pthread_mutex_lock(&writer_lock);
+    if (start_ns == 0) start_ns = perf_now_ns();
+    pthread_mutex_unlock(&writer_lock);
+
+    if (pthread_create(&dumper_thread, NULL, perf_dumper_main, NULL) != 0) {
+        free(dumper_path);
+        dumper_path = NULL;
+        pthread_mutex_unlock(&dumper_lock);
+        return PERF_STATS_ERROR_THREAD;
+    }
+    dumper_running = true;
+    pthread_mutex_unlock(&dumper_lock);
+
+    printf("[perf] Writing stage latencies to %s every %u s\n", path, period_s);
+    return PERF_STATS_SUCCESS;
+}
+
+void perf_stats_stop(void) {
+    pthread_mutex_lock(&dumper_lock);
+    if (!dumper_running) {
+        pthread_mutex_unlock(&dumper_lock);
+        return;
+    }
+    dumper_stop = true;
+    pthread_cond_signal(&dumper_cond);
+    pthread_mutex_unlock(&dumper_lock);
+
+    pthread_join(dumper_thread, NULL);
+    perf_stats_write(dumper_path);
+
+    pthread_mutex_lock(&dumper_lock);
+    dumper_running = false;
+    free(dumper_path);
+    dumper_path = NULL;
+    pthread_mutex_unlock(&dumper_lock);
+}
@@ -0,0 +1,135 @@
+/**
+ * @file perf_stats.h
+ * @brief Wall-clock latency histograms for the stages of the hot path.
+ *
+ * Stages are timed with CLOCK_MONOTONIC spans and recorded into HDR-style
+ * log-linear histograms: every power-of-two range of nanoseconds is split in
+ * PERF_STATS_SUB_BUCKETS linear buckets, so any percentile is reported
+ * within 1 / PERF_STATS_SUB_BUCKETS (about 3%) of the true value from 1 ns
+ * to hours, in constant memory. Recording is a few relaxed atomic adds and
+ * is safe from any thread (acquisition, processing, Welch workers).
+ *
+ * A background writer can dump the histograms periodically to a JSON stats
+ * file, both cumulative and for the interval since the previous dump, so
+ * tail latency can be followed on a field unit without attaching a profiler.
+ *
+ * @code
+ * perf_stats_start("/var/run/bacn/perf_stats.json", 10);
+ * uint64_t t = perf_now_ns();
+ * ... work ...
+ * perf_stats_record(PERF_STAGE_DETECT, perf_now_ns() - t);
+ * perf_stats_stop();   // writes a final dump
+ * @endcode
+ */
+
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <stdint.h>
+
+/** @brief Linear buckets per power of two (precision 1/32) */
+#define PERF_STATS_SUB_BUCKETS 32
+
+/** @brief Powers of two covered, 1 ns .. 2^40 ns (about 18 minutes) */
+#define PERF_STATS_MAGNITUDES 41
+
+/**
+ * @brief Error codes returned by the stats writer
+ */
+typedef enum {
+    PERF_STATS_SUCCESS      =  0, /**< Success */
+    PERF_STATS_ERROR_PARAM  = -1, /**< Invalid argument or already running */
+    PERF_STATS_ERROR_FILE   = -2, /**< Stats file could not be written */
+    PERF_STATS_ERROR_THREAD = -3  /**< Writer thread could not be started */
+} PerfStatsErrorCode;
+
+/**
+ * @brief Timed stages of the acquisition and analysis path
+ */
+typedef enum {
+    PERF_STAGE_ACQUIRE = 0,  /**< One capture from the SDR backend */
+    PERF_STAGE_CONVERT,      /**< CS8 to complex conversion of one capture */
+    PERF_STAGE_WELCH,        /**< Windowed FFTs and accumulation of one Welch pass (all resolutions) */
+    PERF_STAGE_POSTPROCESS,  /**< FFT shift, DC correction and absolute axis of both resolutions */
+    PERF_STAGE_DETECT,       /**< Channel detection over the band plan */
+    PERF_STAGE_JSON_BUILD,   /**< Building the spectrum JSON document */
+    PERF_STAGE_FILE_WRITE,   /**< Serializing and writing the JSON file */
+    PERF_STAGE_COUNT
+} PerfStage;
+
+/**
+ * @brief Summary of one stage histogram
+ */
+typedef struct {
+    uint64_t count;   /**< Spans recorded */
+    double   mean_ns; /**< Mean duration */
+    uint64_t p50_ns;  /**< Median */
+    uint64_t p90_ns;  /**< 90th percentile */
+    uint64_t p99_ns;  /**< 99th percentile */
+    uint64_t p999_ns; /**< 99.9th percentile */
+    uint64_t max_ns;  /**< Longest span (exact) */
+} PerfStageSummary;
+
+/**
+ * @brief Monotonic wall clock in nanoseconds.
+ */
+uint64_t perf_now_ns(void);
+
+/**
+ * @brief Add one span to a stage histogram (any thread).
+ *
+ * @param stage Stage timed
+ * @param duration_ns Span length in nanoseconds
+ */
+void perf_stats_record(PerfStage stage, uint64_t duration_ns);
+
+/**
+ * @brief Summarize the cumulative histogram of a stage.
+ *
+ * @param stage Stage to summarize
+ * @param summary Destination
+ */
+void perf_stats_summary(PerfStage stage, PerfStageSummary* summary);
+
+/**
+ * @brief Clear every histogram.
+ */
+void perf_stats_reset(void);
+
+/**
+ * @brief Stable name of a stage, as used in the stats file.
+ */
+const char* perf_stage_name(PerfStage stage);
+
+/**
+ * @brief Write the cumulative and interval summaries of every stage to @p path.
+ *
+ * The file is written to a temporary name and renamed, so readers never see
+ * a partial document. The interval covers the spans recorded since the
+ * previous call.
+ *
+ * @param path Stats file
+ * @return PERF_STATS_SUCCESS or PERF_STATS_ERROR_FILE
+ */
+int perf_stats_write(const char* path);
+
+/**
+ * @brief Dump the stats to @p path every @p period_s seconds from a background thread.
+ *
+ * @param path Stats file (copied)
+ * @param period_s Seconds between dumps (at least 1)
+ * @return PERF_STATS_SUCCESS or a negative PerfStatsErrorCode
+ */
+int perf_stats_start(const char* path, unsigned period_s);
+
+/**
+ * @brief Stop the writer thread and write a final dump (no-op when not started).
+ */
+void perf_stats_stop(void);
+
+/**
+ * @brief Human-readable message for a PerfStatsErrorCode.
+ */
+const char* perf_stats_error_string(int error_code);
+
+#endif // PERF_STATS_H
@@ -0,0 +1,285 @@
+/**
+ * @file pipeline.c
+ * @brief Two-stage producer/consumer pipeline with a fixed buffer pool.
+ *
+ * Buffer indices move between a free stack and a filled FIFO under one
+ * mutex. Waits use a short timeout so a stop request raised from a signal
+ * handler (which may not touch pthread objects) is noticed promptly.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pipeline.h"
+#include "trace.h"
+
+/** @brief Poll interval for stop requests while waiting, in milliseconds */
+#define PIPELINE_POLL_MS 100
+
+struct Pipeline {
+    PipelineConfig          config;
+    PipelineBuffer*         buffers;
+
+    pthread_mutex_t         lock;
+    pthread_cond_t          buffer_freed;
+    pthread_cond_t          buffer_filled;
+    int*                    free_stack;
+    int                     free_count;
+    int*                    filled_fifo;     /**< Ring of num_buffers indices */
+    int                     filled_head;
+    int                     filled_count;
+
+    volatile sig_atomic_t*  running;
+    bool                    stop;
+    int                     error;
+    uint64_t                next_sequence;
+    PipelineStats           stats;
+};
+
+static const char* pipeline_error_messages[] = {
+    "Success",
+    "Invalid pipeline configuration",
+    "Buffer allocation failed",
+    "Acquisition thread could not be started",
+    "Acquisition stage failed",
+    "Processing stage failed"
+};
+
+const char* pipeline_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(pipeline_error_messages) / sizeof(pipeline_error_messages[0]))) {
+        return pipeline_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+Pipeline* pipeline_create(const PipelineConfig* config) {
+    if (!config || config->num_buffers < 2 || config->buffer_bytes == 0 ||
+        !config->acquire || !config->process) {
+        return NULL;
+    }
+
+    Pipeline* pipeline = (Pipeline*)calloc(1, sizeof(Pipeline));
+    if (!pipeline) {
+        return NULL;
+    }
+    pipeline->config = *config;
+    pthread_mutex_init(&pipeline->lock, NULL);
+    pthread_cond_init(&pipeline->buffer_freed, NULL);
+    pthread_cond_init(&pipeline->buffer_filled, NULL);
+
+    int n = config->num_buffers;
+    pipeline->buffers = (PipelineBuffer*)calloc(n, sizeof(PipelineBuffer));
+    pipeline->free_stack = (int*)malloc(n * sizeof(int));
+    pipeline->filled_fifo = (int*)malloc(n * sizeof(int));
+    if (!pipeline->buffers || !pipeline->free_stack || !pipeline->filled_fifo) {
+        pipeline_destroy(pipeline);
+        return NULL;
+    }
+
+    for (int i = 0; i < n; i++) {
+        pipeline->buffers[i].data = (int8_t*)malloc(config->buffer_bytes);
+        if (!pipeline->buffers[i].data) {
+            pipeline_destroy(pipeline);
+            return NULL;
+        }
+        pipeline->buffers[i].capacity = config->buffer_bytes;
+        pipeline->free_stack[i] = i;
+    }
+    pipeline->free_count = n;
+
+    return pipeline;
+}
+
+void pipeline_destroy(Pipeline* pipeline) {
+    if (!pipeline) return;
+
+    if (pipeline->buffers) {
+        for (int i = 0; i < pipeline->config.num_buffers; i++) {
+            free(pipeline->buffers[i].data);
+        }
+    }
+    pthread_cond_destroy(&pipeline->buffer_filled);
+    pthread_cond_destroy(&pipeline->buffer_freed);
+    pthread_mutex_destroy(&pipeline->lock);
+    free(pipeline->buffers);
+    free(pipeline->free_stack);
+    free(pipeline->filled_fifo);
+    free(pipeline);
+}
+
+void pipeline_get_stats(Pipeline* pipeline, PipelineStats* stats) {
+    pthread_mutex_lock(&pipeline->lock);
+    *stats = pipeline->stats;
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+/* Caller holds the lock. */
+static bool pipeline_should_stop(const Pipeline* pipeline) {
+    return pipeline->stop || (pipeline->running && !*pipeline->running);
+}
+
+/* Caller holds the lock. */
+static void pipeline_wait(Pipeline* pipeline, pthread_cond_t* cond) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += PIPELINE_POLL_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, &pipeline->lock, &deadline);
+}
+
+/* Caller holds the lock. */
+static void pipeline_fail(Pipeline* pipeline, int error) {
+    if (pipeline->error == PIPELINE_SUCCESS) {
+        pipeline->error = error;
+    }
+    pipeline->stop = true;
+    pthread_cond_broadcast(&pipeline->buffer_freed);
+    pthread_cond_broadcast(&pipeline->buffer_filled);
+}
+
+static void* pipeline_acquire_main(void* arg) {
+    Pipeline* pipeline = (Pipeline*)arg;
+    int n = pipeline->config.num_buffers;
+
+    trace_thread_name("acquisition");
+    for (;;) {
+        int index = -1;
+        bool waited = false;
+
+        pthread_mutex_lock(&pipeline->lock);
+        while (!pipeline_should_stop(pipeline)) {
+            if (pipeline->free_count > 0) {
+                index = pipeline->free_stack[--pipeline->free_count];
+                break;
+            }
+            if (pipeline->config.backpressure == PIPELINE_DROP_OLDEST && pipeline->filled_count > 1) {
+                /* Consumer is behind: overwrite the stalest capture, never the newest,
+                 * or the consumer would wait a whole acquisition after each step */
+                index = pipeline->filled_fifo[pipeline->filled_head];
+                pipeline->filled_head = (pipeline->filled_head + 1) % n;
+                pipeline->filled_count--;
+                pipeline->stats.dropped++;
+                break;
+            }
+            if (!waited) {
+                pipeline->stats.producer_waits++;
+                waited = true;
+                trace_begin("pipeline", "wait_free_buffer");
+            }
+            pipeline_wait(pipeline, &pipeline->buffer_freed);
+        }
+        if (waited) {
+            trace_end("pipeline", "wait_free_buffer");
+        }
+        if (index < 0) {
+            pthread_mutex_unlock(&pipeline->lock);
+            break;
+        }
+        PipelineBuffer* buffer = &pipeline->buffers[index];
+        buffer->sequence = pipeline->next_sequence++;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        buffer->length = 0;
+        trace_begin("pipeline", "acquire");
+        int result = pipeline->config.acquire(buffer, pipeline->config.user);
+        trace_end("pipeline", "acquire");
+
+        pthread_mutex_lock(&pipeline->lock);
+        if (result < 0) {
+            pipeline->free_stack[pipeline->free_count++] = index;
+            /* A capture cut short by a stop request is not a failure */
+            if (!pipeline_should_stop(pipeline)) {
+                pipeline_fail(pipeline, PIPELINE_ERROR_ACQUIRE);
+            }
+            pipeline->stop = true;
+            pthread_cond_broadcast(&pipeline->buffer_filled);
+            pthread_mutex_unlock(&pipeline->lock);
+            break;
+        }
+        pipeline->filled_fifo[(pipeline->filled_head + pipeline->filled_count) % n] = index;
+        pipeline->filled_count++;
+        pipeline->stats.acquired++;
+        pthread_cond_signal(&pipeline->buffer_filled);
+        pthread_mutex_unlock(&pipeline->lock);
+    }
+
+    return NULL;
+}
+
+int pipeline_run(Pipeline* pipeline, volatile sig_atomic_t* running) {
+    if (!pipeline) {
+        return PIPELINE_ERROR_PARAM;
+    }
+
+    int n = pipeline->config.num_buffers;
+    pthread_t producer;
+
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->running = running;
+    pipeline->stop = false;
+    pipeline->error = PIPELINE_SUCCESS;
+    pthread_mutex_unlock(&pipeline->lock);
+
+    if (pthread_create(&producer, NULL, pipeline_acquire_main, pipeline) != 0) {
+        return PIPELINE_ERROR_THREAD;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&pipeline->lock);
+        bool waited = pipeline->filled_count == 0 && !pipeline_should_stop(pipeline);
+        if (waited) {
+            trace_begin("pipeline", "wait_capture");
+        }
+        while (pipeline->filled_count == 0 && !pipeline_should_stop(pipeline)) {
+            pipeline_wait(pipeline, &pipeline->buffer_filled);
+        }
+        if (waited) {
+            trace_end("pipeline", "wait_capture");
+        }
+        if (pipeline_should_stop(pipeline)) {
+            pthread_mutex_unlock(&pipeline->lock);
+            break;
+        }
+        int index = pipeline->filled_fifo[pipeline->filled_head];
+        pipeline->filled_head = (pipeline->filled_head + 1) % n;
+        pipeline->filled_count--;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        trace_begin("pipeline", "process");
+        int result = pipeline->config.process(&pipeline->buffers[index], pipeline->config.user);
+        trace_end("pipeline", "process");
+
+        pthread_mutex_lock(&pipeline->lock);
+        pipeline->free_stack[pipeline->free_count++] = index;
+        pipeline->stats.processed++;
+        pthread_cond_signal(&pipeline->buffer_freed);
+        if (result < 0) {
+            pipeline_fail(pipeline, PIPELINE_ERROR_PROCESS);
+        }
+        pthread_mutex_unlock(&pipeline->lock);
+    }
+
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->stop = true;
+    pthread_cond_broadcast(&pipeline->buffer_freed);
+    pthread_mutex_unlock(&pipeline->lock);
+    pthread_join(producer, NULL);
+
+    /* Unprocessed captures go back to the pool for the next run */
+    pthread_mutex_lock(&pipeline->lock);
+    while (pipeline->filled_count > 0) {
+        pipeline->free_stack[pipeline->free_count++] = pipeline->filled_fifo[pipeline->filled_head];
+        pipeline->filled_head = (pipeline->filled_head + 1) % n;
+        pipeline->filled_count--;
+    }
+    int error = pipeline->error;
+    pthread_mutex_unlock(&pipeline->lock);
+
+    return error;
+}
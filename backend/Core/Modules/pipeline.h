@@ -0,0 +1,146 @@
+/**
+ * @file pipeline.h
+ * @brief Acquisition/processing pipeline over a pool of preallocated capture buffers.
+ *
+ * The acquisition stage runs on its own thread and fills free buffers; the
+ * processing stage runs on the thread that calls pipeline_run() and drains
+ * filled buffers in capture order. While buffer N is being analysed, buffer
+ * N+1 is already being captured, so the update rate is set by the slower of
+ * the two stages instead of their sum.
+ *
+ * When the processing stage falls behind and no buffer is free, the
+ * configured backpressure policy decides what the acquisition stage does:
+ * wait for the consumer (no capture is lost, the radio idles) or recycle the
+ * oldest capture that has not been processed yet (the display stays fresh,
+ * the skipped capture is counted as dropped). The newest filled capture is
+ * never recycled, so the consumer always has one ready when it finishes:
+ * dropping needs at least 3 buffers, and with 2 PIPELINE_DROP_OLDEST waits
+ * like PIPELINE_BLOCK.
+ *
+ * @code
+ * PipelineConfig cfg = { .num_buffers = 3, .buffer_bytes = 40000000,
+ *                        .backpressure = PIPELINE_DROP_OLDEST,
+ *                        .acquire = capture_cb, .process = analyse_cb, .user = &ctx };
+ * Pipeline* p = pipeline_create(&cfg);
+ * pipeline_run(p, &running);   // returns when running becomes 0 or a stage fails
+ * pipeline_destroy(p);
+ * @endcode
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Error codes returned by the pipeline
+ */
+typedef enum {
+    PIPELINE_SUCCESS        =  0, /**< Success / stopped on request */
+    PIPELINE_ERROR_PARAM    = -1, /**< Invalid configuration */
+    PIPELINE_ERROR_MEMORY   = -2, /**< Buffer allocation failed */
+    PIPELINE_ERROR_THREAD   = -3, /**< Acquisition thread could not be started */
+    PIPELINE_ERROR_ACQUIRE  = -4, /**< Acquisition callback failed */
+    PIPELINE_ERROR_PROCESS  = -5  /**< Processing callback failed */
+} PipelineErrorCode;
+
+/**
+ * @brief What the acquisition stage does when every buffer is in use
+ */
+typedef enum {
+    PIPELINE_BLOCK       = 0, /**< Wait until the processing stage releases a buffer */
+    PIPELINE_DROP_OLDEST = 1  /**< Reuse the oldest unprocessed capture (never the newest) and count it as dropped */
+} PipelineBackpressure;
+
+/**
+ * @brief One capture buffer of the pool
+ */
+typedef struct {
+    int8_t*  data;      /**< Interleaved CS8 bytes */
+    size_t   capacity;  /**< Allocated bytes */
+    size_t   length;    /**< Valid bytes, set by the acquisition callback */
+    uint64_t sequence;  /**< Capture number, increasing from 0 */
+} PipelineBuffer;
+
+/**
+ * @brief Fill @p buffer (set buffer->length). Return 0 on success, negative to stop.
+ */
+typedef int (*pipeline_acquire_fn)(PipelineBuffer* buffer, void* user);
+
+/**
+ * @brief Analyse @p buffer. Return 0 on success, negative to stop.
+ */
+typedef int (*pipeline_process_fn)(const PipelineBuffer* buffer, void* user);
+
+/**
+ * @brief Pipeline configuration, copied at creation time
+ */
+typedef struct {
+    int                  num_buffers;  /**< Pool size, at least 2 */
+    size_t               buffer_bytes; /**< Capacity of each buffer */
+    PipelineBackpressure backpressure; /**< Policy when no buffer is free */
+    pipeline_acquire_fn  acquire;      /**< Runs on the acquisition thread */
+    pipeline_process_fn  process;      /**< Runs on the pipeline_run() caller */
+    void*                user;         /**< Passed to both callbacks */
+} PipelineConfig;
+
+/**
+ * @brief Counters, updated while the pipeline runs
+ */
+typedef struct {
+    uint64_t acquired;        /**< Captures completed */
+    uint64_t processed;       /**< Captures analysed */
+    uint64_t dropped;         /**< Captures recycled unprocessed (PIPELINE_DROP_OLDEST) */
+    uint64_t producer_waits;  /**< Times acquisition waited for a buffer */
+} PipelineStats;
+
+/** @brief Opaque pipeline handle */
+typedef struct Pipeline Pipeline;
+
+/**
+ * @brief Allocate the buffer pool.
+ *
+ * @param config Pipeline configuration
+ * @return New pipeline, or NULL on invalid configuration or allocation failure
+ */
+Pipeline* pipeline_create(const PipelineConfig* config);
+
+/**
+ * @brief Run both stages until @p running becomes 0 or a callback fails.
+ *
+ * Starts the acquisition thread, processes buffers on the calling thread and
+ * joins the acquisition thread before returning. @p running may be cleared
+ * from a signal handler.
+ *
+ * @param pipeline Pipeline handle
+ * @param running Flag polled by both stages (NULL runs until a callback fails)
+ * @return PIPELINE_SUCCESS when stopped through @p running, otherwise a negative PipelineErrorCode
+ */
+int pipeline_run(Pipeline* pipeline, volatile sig_atomic_t* running);
+
+/**
+ * @brief Copy the current counters (safe from any thread).
+ *
+ * @param pipeline Pipeline handle
+ * @param stats Destination
+ */
+void pipeline_get_stats(Pipeline* pipeline, PipelineStats* stats);
+
+/**
+ * @brief Free the buffer pool (NULL is ignored). The pipeline must not be running.
+ *
+ * @param pipeline Pipeline handle
+ */
+void pipeline_destroy(Pipeline* pipeline);
+
+/**
+ * @brief Human-readable message for a PipelineErrorCode.
+ *
+ * @param error_code Code returned by a pipeline function
+ * @return Constant description string
+ */
+const char* pipeline_error_string(int error_code);
+
+#endif // PIPELINE_H
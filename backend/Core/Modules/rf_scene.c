@@ -0,0 +1,467 @@
+/**
+ * @file rf_scene.c
+ * @brief Table-driven synthesis of FM band scenes into CS8.
+ *
+ * Phases are kept as indices into one sine table of RF_SCENE_PERIOD
+ * entries: a carrier at bin k advances its index by k per sample and the FM
+ * term adds the rounded deviation, so rendering a table needs only integer
+ * adds and table lookups (phase quantization error below 1.2e-5 rad).
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "rf_scene.h"
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+/** @brief Complex samples in the noise table */
+#define RF_SCENE_NOISE_LEN (1 << 20)
+
+/** @brief Modulating tones per FM emitter (pilot + two programme tones) */
+#define RF_SCENE_MOD_TONES 3
+
+#define RF_SCENE_MASK (RF_SCENE_PERIOD - 1)
+
+typedef struct {
+    double   freq_hz;
+    double   amplitude;
+    double   mod_freq_hz[RF_SCENE_MOD_TONES];
+    double   mod_deviation_hz[RF_SCENE_MOD_TONES];
+    uint32_t mod_phase[RF_SCENE_MOD_TONES];
+    uint32_t carrier_phase;
+    /* Bursts only */
+    uint64_t period_samples;
+    uint64_t on_samples;
+    uint64_t offset_samples;
+} SceneEmitter;
+
+typedef struct {
+    bool     valid;
+    double   center_freq;
+    uint64_t last_use;
+    float*   base;                          /**< Continuous carriers, interleaved I/Q */
+    float*   burst[RF_SCENE_MAX_BURSTS];    /**< One table per in-band burst, NULL otherwise */
+    int      carriers_in_band;
+    int      bursts_in_band;
+} SceneTable;
+
+struct RFScene {
+    RFSceneConfig config;
+    SceneEmitter* carriers;
+    int           carrier_count;
+    SceneEmitter  bursts[RF_SCENE_MAX_BURSTS];
+    int           burst_count;
+
+    float*        sin_lut;      /**< sin(2 pi i / RF_SCENE_PERIOD) */
+    float*        noise;        /**< Gaussian, interleaved I/Q */
+    float*        scratch;      /**< Carriers plus active bursts for one chunk */
+
+    SceneTable    cache[RF_SCENE_TABLE_CACHE];
+    SceneTable*   tuned;
+    uint64_t      use_clock;
+
+    uint32_t      rng;
+    size_t        position;     /**< Index into the periodic tables */
+    uint64_t      sample_clock; /**< Samples generated since creation (burst timing) */
+};
+
+static const char* rf_scene_error_messages[] = {
+    "Success",
+    "Invalid scene configuration",
+    "Memory allocation failed",
+    "Channel plan could not be read"
+};
+
+const char* rf_scene_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(rf_scene_error_messages) / sizeof(rf_scene_error_messages[0]))) {
+        return rf_scene_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+void rf_scene_default_config(RFSceneConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->sample_rate = 20e6;
+    config->occupancy = 0.15;
+    config->carrier_level_min_db = -15.0;
+    config->carrier_level_max_db = 5.0;
+    config->fm_deviation_hz = 75e3;
+    config->noise_rms = 3.0;
+    config->dc_i = 1.5;
+    config->dc_q = -1.0;
+    config->iq_gain_db = 0.2;
+    config->iq_phase_deg = 1.0;
+    config->burst_count = 2;
+    config->burst_period_s = 0.05;
+    config->burst_duty = 0.2;
+    config->burst_level_db = 0.0;
+    config->seed = 1;
+}
+
+int rf_scene_load_channels(const char* path, double* channels_mhz, int max_channels) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "[scene] Unable to open channel plan %s\n", path);
+        return RF_SCENE_ERROR_FILE;
+    }
+
+    char line[128];
+    int count = 0;
+    /* First line is the "frequency,bandwidth" header */
+    if (fgets(line, sizeof(line), file) != NULL) {
+        while (count < max_channels && fgets(line, sizeof(line), file) != NULL) {
+            char* end = NULL;
+            double freq = strtod(line, &end);
+            if (end != line) {
+                channels_mhz[count++] = freq;
+            }
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static uint32_t scene_rand(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/* Uniform in [0, 1) */
+static double scene_uniform(uint32_t* state) {
+    return (scene_rand(state) >> 8) * (1.0 / 16777216.0);
+}
+
+static double scene_uniform_range(uint32_t* state, double lo, double hi) {
+    return lo + (hi - lo) * scene_uniform(state);
+}
+
+/* Amplitude for a level relative to the total noise power 2 * sigma^2 */
+static double scene_amplitude(const RFSceneConfig* config, double level_db) {
+    double reference = config->noise_rms > 0.0 ? config->noise_rms * sqrt(2.0) : 1.0;
+    return reference * pow(10.0, level_db / 20.0);
+}
+
+/* Pilot at 19 kHz with 10% of the deviation, two programme tones share the rest */
+static void scene_place_fm(SceneEmitter* e, const RFSceneConfig* config, uint32_t* rng,
+                           double freq_hz, double level_db) {
+    double deviation = config->fm_deviation_hz;
+    double split = scene_uniform_range(rng, 0.2, 0.8);
+
+    e->freq_hz = freq_hz;
+    e->amplitude = scene_amplitude(config, level_db);
+    e->mod_freq_hz[0] = 19e3;
+    e->mod_deviation_hz[0] = 0.1 * deviation;
+    e->mod_freq_hz[1] = scene_uniform_range(rng, 200.0, 3e3);
+    e->mod_deviation_hz[1] = 0.9 * deviation * split;
+    e->mod_freq_hz[2] = scene_uniform_range(rng, 3e3, 15e3);
+    e->mod_deviation_hz[2] = 0.9 * deviation * (1.0 - split);
+    for (int j = 0; j < RF_SCENE_MOD_TONES; j++) {
+        e->mod_phase[j] = scene_rand(rng) & RF_SCENE_MASK;
+    }
+    e->carrier_phase = scene_rand(rng) & RF_SCENE_MASK;
+}
+
+static void scene_free_table(SceneTable* table) {
+    free(table->base);
+    for (int b = 0; b < RF_SCENE_MAX_BURSTS; b++) {
+        free(table->burst[b]);
+    }
+    memset(table, 0, sizeof(*table));
+}
+
+void rf_scene_destroy(RFScene* scene) {
+    if (!scene) return;
+
+    for (int c = 0; c < RF_SCENE_TABLE_CACHE; c++) {
+        scene_free_table(&scene->cache[c]);
+    }
+    free(scene->carriers);
+    free(scene->sin_lut);
+    free(scene->noise);
+    free(scene->scratch);
+    free(scene);
+}
+
+RFScene* rf_scene_create(const RFSceneConfig* config) {
+    if (!config || config->sample_rate <= 0.0 || config->occupancy < 0.0 || config->occupancy > 1.0 ||
+        config->channel_count < 0 || config->channel_count > RF_SCENE_MAX_CHANNELS ||
+        (config->channel_count > 0 && !config->channels_mhz) ||
+        config->carrier_level_max_db < config->carrier_level_min_db || config->noise_rms < 0.0 ||
+        config->burst_count < 0 || config->burst_count > RF_SCENE_MAX_BURSTS ||
+        (config->burst_count > 0 && (config->burst_period_s <= 0.0 ||
+                                     config->burst_duty <= 0.0 || config->burst_duty > 1.0))) {
+        return NULL;
+    }
+
+    RFScene* scene = (RFScene*)calloc(1, sizeof(RFScene));
+    if (!scene) {
+        return NULL;
+    }
+    scene->config = *config;
+    scene->config.channels_mhz = NULL;     /* Not retained; emitters are copied below */
+    scene->rng = config->seed ? config->seed : 0x2545f491u;
+
+    scene->sin_lut = (float*)malloc(RF_SCENE_PERIOD * sizeof(float));
+    scene->noise = (float*)malloc(2 * (size_t)RF_SCENE_NOISE_LEN * sizeof(float));
+    scene->scratch = (float*)malloc(2 * RF_SCENE_CHUNK * sizeof(float));
+    scene->carriers = (SceneEmitter*)calloc(config->channel_count > 0 ? config->channel_count : 1,
+                                            sizeof(SceneEmitter));
+    if (!scene->sin_lut || !scene->noise || !scene->scratch || !scene->carriers) {
+        rf_scene_destroy(scene);
+        return NULL;
+    }
+
+    for (int i = 0; i < RF_SCENE_PERIOD; i++) {
+        scene->sin_lut[i] = (float)sin(2.0 * PI * i / RF_SCENE_PERIOD);
+    }
+
+    /* Box-Muller into the noise table */
+    for (size_t i = 0; i < RF_SCENE_NOISE_LEN; i++) {
+        double u1 = scene_uniform(&scene->rng);
+        double u2 = scene_uniform(&scene->rng);
+        double r = config->noise_rms * sqrt(-2.0 * log(1.0 - u1));
+        scene->noise[2 * i]     = (float)(r * cos(2.0 * PI * u2));
+        scene->noise[2 * i + 1] = (float)(r * sin(2.0 * PI * u2));
+    }
+
+    /* Occupied channels carry a continuous station; the rest can host bursts */
+    bool* occupied = (bool*)calloc(config->channel_count > 0 ? config->channel_count : 1, sizeof(bool));
+    if (!occupied) {
+        rf_scene_destroy(scene);
+        return NULL;
+    }
+    for (int c = 0; c < config->channel_count; c++) {
+        if (scene_uniform(&scene->rng) < config->occupancy) {
+            double level = scene_uniform_range(&scene->rng, config->carrier_level_min_db,
+                                               config->carrier_level_max_db);
+            scene_place_fm(&scene->carriers[scene->carrier_count++], config, &scene->rng,
+                           config->channels_mhz[c] * 1e6, level);
+            occupied[c] = true;
+        }
+    }
+
+    for (int b = 0; b < config->burst_count && config->channel_count > 0; b++) {
+        int c = (int)(scene_rand(&scene->rng) % config->channel_count);
+        for (int tries = 0; tries < config->channel_count && occupied[c]; tries++) {
+            c = (c + 1) % config->channel_count;
+        }
+        occupied[c] = true;
+
+        SceneEmitter* e = &scene->bursts[scene->burst_count++];
+        scene_place_fm(e, config, &scene->rng, config->channels_mhz[c] * 1e6, config->burst_level_db);
+        /* Each emitter keys with its own period, 0.5x .. 1.5x the configured one */
+        double period = config->burst_period_s * scene_uniform_range(&scene->rng, 0.5, 1.5);
+        e->period_samples = (uint64_t)(period * config->sample_rate);
+        if (e->period_samples < 1) e->period_samples = 1;
+        e->on_samples = (uint64_t)(e->period_samples * config->burst_duty);
+        e->offset_samples = scene_rand(&scene->rng) % e->period_samples;
+    }
+    free(occupied);
+
+    return scene;
+}
+
+/* Add one FM emitter, as seen from center_freq, into an interleaved table */
+static void scene_render(const RFScene* scene, const SceneEmitter* e, double center_freq, float* table) {
+    const float* lut = scene->sin_lut;
+    double df = scene->config.sample_rate / RF_SCENE_PERIOD;
+    float amplitude = (float)e->amplitude;
+
+    uint32_t step = (uint32_t)(llround((e->freq_hz - center_freq) / df) & RF_SCENE_MASK);
+    uint32_t mod_step[RF_SCENE_MOD_TONES];
+    double mod_scale[RF_SCENE_MOD_TONES];
+    uint32_t mod_phase[RF_SCENE_MOD_TONES];
+    for (int j = 0; j < RF_SCENE_MOD_TONES; j++) {
+        long k = lround(e->mod_freq_hz[j] / df);
+        if (k < 1) k = 1;
+        mod_step[j] = (uint32_t)k;
+        /* beta = deviation / f_mod, expressed in table indices */
+        mod_scale[j] = e->mod_deviation_hz[j] / (k * df) * RF_SCENE_PERIOD / (2.0 * PI);
+        mod_phase[j] = e->mod_phase[j];
+    }
+
+    uint32_t phase = e->carrier_phase;
+    for (int n = 0; n < RF_SCENE_PERIOD; n++) {
+        double deviation = 0.0;
+        for (int j = 0; j < RF_SCENE_MOD_TONES; j++) {
+            deviation += mod_scale[j] * lut[mod_phase[j]];
+            mod_phase[j] = (mod_phase[j] + mod_step[j]) & RF_SCENE_MASK;
+        }
+        uint32_t index = (uint32_t)(phase + (int64_t)llround(deviation)) & RF_SCENE_MASK;
+        table[2 * n]     += amplitude * lut[(index + RF_SCENE_PERIOD / 4) & RF_SCENE_MASK];
+        table[2 * n + 1] += amplitude * lut[index];
+        phase = (phase + step) & RF_SCENE_MASK;
+    }
+}
+
+/* Receiver IQ imbalance: Q' = g * (Q cos(phi) - I sin(phi)) */
+static void scene_impair(const RFScene* scene, float* table) {
+    double g = pow(10.0, scene->config.iq_gain_db / 20.0);
+    double phi = scene->config.iq_phase_deg * PI / 180.0;
+    float qq = (float)(g * cos(phi));
+    float qi = (float)(-g * sin(phi));
+
+    for (int n = 0; n < RF_SCENE_PERIOD; n++) {
+        float i = table[2 * n];
+        float q = table[2 * n + 1];
+        table[2 * n + 1] = qq * q + qi * i;
+    }
+}
+
+static bool scene_in_band(const RFScene* scene, const SceneEmitter* e, double center_freq) {
+    /* Keep the FM sidebands inside the receiver bandwidth */
+    double half = scene->config.sample_rate / 2 - 2 * scene->config.fm_deviation_hz;
+    return fabs(e->freq_hz - center_freq) < half;
+}
+
+static int scene_build(RFScene* scene, SceneTable* table, double center_freq) {
+    size_t bytes = 2 * (size_t)RF_SCENE_PERIOD * sizeof(float);
+
+    table->base = (float*)calloc(1, bytes);
+    if (!table->base) {
+        return RF_SCENE_ERROR_MEMORY;
+    }
+    for (int c = 0; c < scene->carrier_count; c++) {
+        if (scene_in_band(scene, &scene->carriers[c], center_freq)) {
+            scene_render(scene, &scene->carriers[c], center_freq, table->base);
+            table->carriers_in_band++;
+        }
+    }
+    scene_impair(scene, table->base);
+
+    float peak = 0.0f;
+    for (int n = 0; n < 2 * RF_SCENE_PERIOD; n++) {
+        float v = fabsf(table->base[n]);
+        if (v > peak) peak = v;
+    }
+
+    for (int b = 0; b < scene->burst_count; b++) {
+        if (!scene_in_band(scene, &scene->bursts[b], center_freq)) {
+            continue;
+        }
+        table->burst[b] = (float*)calloc(1, bytes);
+        if (!table->burst[b]) {
+            return RF_SCENE_ERROR_MEMORY;
+        }
+        scene_render(scene, &scene->bursts[b], center_freq, table->burst[b]);
+        scene_impair(scene, table->burst[b]);
+        peak += (float)scene->bursts[b].amplitude;
+        table->bursts_in_band++;
+    }
+
+    double headroom = peak + 4.0 * scene->config.noise_rms +
+                      fmax(fabs(scene->config.dc_i), fabs(scene->config.dc_q));
+    if (headroom > 127.0) {
+        fprintf(stderr, "[scene] Peak %.0f counts at %.3f MHz: output will clip\n", headroom, center_freq / 1e6);
+    }
+
+    table->center_freq = center_freq;
+    table->valid = true;
+    return RF_SCENE_SUCCESS;
+}
+
+int rf_scene_tune(RFScene* scene, double center_freq) {
+    if (!scene) {
+        return RF_SCENE_ERROR_PARAM;
+    }
+
+    SceneTable* victim = &scene->cache[0];
+    for (int c = 0; c < RF_SCENE_TABLE_CACHE; c++) {
+        SceneTable* table = &scene->cache[c];
+        if (table->valid && table->center_freq == center_freq) {
+            table->last_use = ++scene->use_clock;
+            scene->tuned = table;
+            return RF_SCENE_SUCCESS;
+        }
+        if (!table->valid || (victim->valid && table->last_use < victim->last_use)) {
+            victim = table;
+        }
+    }
+
+    scene_free_table(victim);
+    int result = scene_build(scene, victim, center_freq);
+    if (result != RF_SCENE_SUCCESS) {
+        scene_free_table(victim);
+        scene->tuned = NULL;
+        return result;
+    }
+    victim->last_use = ++scene->use_clock;
+    scene->tuned = victim;
+    return RF_SCENE_SUCCESS;
+}
+
+void rf_scene_in_band(const RFScene* scene, int* carriers, int* bursts) {
+    if (carriers) *carriers = scene->tuned ? scene->tuned->carriers_in_band : 0;
+    if (bursts) *bursts = scene->tuned ? scene->tuned->bursts_in_band : 0;
+}
+
+/* out = round(clamp(signal + noise + dc)) for count interleaved pairs */
+static void scene_quantize(const float* signal, const float* noise, float dc_i, float dc_q,
+                           int8_t* out, size_t count) {
+    for (size_t n = 0; n < 2 * count; n += 2) {
+        float i = signal[n] + noise[n] + dc_i;
+        float q = signal[n + 1] + noise[n + 1] + dc_q;
+        i = i > 127.0f ? 127.0f : (i < -128.0f ? -128.0f : i);
+        q = q > 127.0f ? 127.0f : (q < -128.0f ? -128.0f : q);
+        out[n]     = (int8_t)(int)(i + (i < 0.0f ? -0.5f : 0.5f));
+        out[n + 1] = (int8_t)(int)(q + (q < 0.0f ? -0.5f : 0.5f));
+    }
+}
+
+int rf_scene_generate(RFScene* scene, int8_t* out, size_t num_samples) {
+    if (!scene || !scene->tuned || (!out && num_samples > 0)) {
+        return RF_SCENE_ERROR_PARAM;
+    }
+
+    const SceneTable* table = scene->tuned;
+    float dc_i = (float)scene->config.dc_i;
+    float dc_q = (float)scene->config.dc_q;
+
+    while (num_samples > 0) {
+        size_t count = num_samples < RF_SCENE_CHUNK ? num_samples : RF_SCENE_CHUNK;
+        if (count > RF_SCENE_PERIOD - scene->position) {
+            count = RF_SCENE_PERIOD - scene->position;
+        }
+
+        const float* signal = table->base + 2 * scene->position;
+        bool mixed = false;
+        for (int b = 0; b < scene->burst_count; b++) {
+            const SceneEmitter* e = &scene->bursts[b];
+            if (!table->burst[b] ||
+                (scene->sample_clock + e->offset_samples) % e->period_samples >= e->on_samples) {
+                continue;
+            }
+            if (!mixed) {
+                memcpy(scene->scratch, signal, 2 * count * sizeof(float));
+                signal = scene->scratch;
+                mixed = true;
+            }
+            const float* burst = table->burst[b] + 2 * scene->position;
+            for (size_t n = 0; n < 2 * count; n++) {
+                scene->scratch[n] += burst[n];
+            }
+        }
+
+        /* A fresh window of the noise table for every chunk */
+        size_t offset = scene_rand(&scene->rng) % (RF_SCENE_NOISE_LEN - RF_SCENE_CHUNK);
+        scene_quantize(signal, scene->noise + 2 * offset, dc_i, dc_q, out, count);
+
+        scene->position = (scene->position + count) & RF_SCENE_MASK;
+        scene->sample_clock += count;
+        out += 2 * count;
+        num_samples -= count;
+    }
+
+    return RF_SCENE_SUCCESS;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file rf_scene.h
+ * @brief Synthetic RF scenes rendered as CS8 captures at memory speed.
+ *
+ * A scene is a set of emitters at absolute frequencies plus receiver
+ * impairments, seen through a receiver tuned to one centre frequency:
+ *
+ * - continuous wideband-FM carriers on a subset of the channel plan
+ *   (e.g. bands/VHF1.csv), each with its own level and programme tones;
+ * - bursty emitters that key on and off with a period and duty cycle;
+ * - a Gaussian noise floor, a DC offset and IQ gain/phase imbalance.
+ *
+ * Rendering is table driven so large corpora are cheap to produce. When the
+ * scene is tuned, every in-band emitter is synthesized once into a periodic
+ * table of RF_SCENE_PERIOD samples (frequencies snapped to fs / period, so
+ * the table loops seamlessly); generation then only adds the tables, a
+ * window of a precomputed noise table at a random offset and the DC offset,
+ * and quantizes to int8. Burst edges fall on RF_SCENE_CHUNK boundaries.
+ * Tables are cached per centre frequency, so sweeps revisit LOs for free.
+ *
+ * Output is interleaved int8 I/Q, the format getSamples() writes.
+ *
+ * @code
+ * RFSceneConfig cfg;
+ * rf_scene_default_config(&cfg);
+ * double channels[RF_SCENE_MAX_CHANNELS];
+ * cfg.channel_count = rf_scene_load_channels("bands/VHF1.csv", channels, RF_SCENE_MAX_CHANNELS);
+ * cfg.channels_mhz = channels;
+ * RFScene* scene = rf_scene_create(&cfg);
+ * rf_scene_tune(scene, 98e6);
+ * rf_scene_generate(scene, buffer, num_samples);   // continues where the last call stopped
+ * rf_scene_destroy(scene);
+ * @endcode
+ */
+
+#ifndef RF_SCENE_H
+#define RF_SCENE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Length of the periodic emitter tables, in samples (power of two) */
+#define RF_SCENE_PERIOD (1 << 18)
+
+/** @brief Granularity of noise windows and burst gating, in samples */
+#define RF_SCENE_CHUNK 4096
+
+/** @brief Largest channel plan accepted */
+#define RF_SCENE_MAX_CHANNELS 1024
+
+/** @brief Largest number of bursty emitters */
+#define RF_SCENE_MAX_BURSTS 8
+
+/** @brief Tuned centre frequencies kept in the table cache */
+#define RF_SCENE_TABLE_CACHE 8
+
+/**
+ * @brief Error codes returned by the scene generator
+ */
+typedef enum {
+    RF_SCENE_SUCCESS      =  0, /**< Success */
+    RF_SCENE_ERROR_PARAM  = -1, /**< Invalid configuration or argument */
+    RF_SCENE_ERROR_MEMORY = -2, /**< Allocation failed */
+    RF_SCENE_ERROR_FILE   = -3  /**< Channel plan could not be read */
+} RFSceneErrorCode;
+
+/**
+ * @brief Scene description, copied at creation time
+ */
+typedef struct {
+    double        sample_rate;          /**< Receiver sample rate in Hz */
+    const double* channels_mhz;         /**< Channel centres in MHz (may be NULL) */
+    int           channel_count;        /**< Entries in channels_mhz */
+    double        occupancy;            /**< Fraction of channels carrying a station (0..1) */
+    double        carrier_level_min_db; /**< Carrier power relative to total noise power, lowest */
+    double        carrier_level_max_db; /**< Highest carrier level */
+    double        fm_deviation_hz;      /**< Peak FM deviation of every carrier */
+    double        noise_rms;            /**< Noise standard deviation per axis, in int8 counts */
+    double        dc_i;                 /**< DC offset on I, in counts */
+    double        dc_q;                 /**< DC offset on Q, in counts */
+    double        iq_gain_db;           /**< Q gain relative to I */
+    double        iq_phase_deg;         /**< Quadrature phase error */
+    int           burst_count;          /**< Bursty emitters (0 .. RF_SCENE_MAX_BURSTS) */
+    double        burst_period_s;       /**< Mean keying period */
+    double        burst_duty;           /**< Fraction of each period the emitter is on (0..1] */
+    double        burst_level_db;       /**< Burst level relative to total noise power */
+    uint32_t      seed;                 /**< Seed for emitter placement and noise (0 = fixed default) */
+} RFSceneConfig;
+
+/** @brief Opaque scene handle */
+typedef struct RFScene RFScene;
+
+/**
+ * @brief Fill @p config with a plausible urban FM band.
+ *
+ * @param config Destination
+ */
+void rf_scene_default_config(RFSceneConfig* config);
+
+/**
+ * @brief Read the channel centres of a "frequency,bandwidth" CSV (header line skipped).
+ *
+ * @param path CSV file, e.g. bands/VHF1.csv
+ * @param channels_mhz Destination for the centres in MHz
+ * @param max_channels Capacity of @p channels_mhz
+ * @return Number of channels read, or RF_SCENE_ERROR_FILE
+ */
+int rf_scene_load_channels(const char* path, double* channels_mhz, int max_channels);
+
+/**
+ * @brief Place the emitters and build the noise table.
+ *
+ * @param config Scene description
+ * @return New scene, or NULL on invalid configuration or allocation failure
+ */
+RFScene* rf_scene_create(const RFSceneConfig* config);
+
+/**
+ * @brief Release the scene (NULL is ignored).
+ *
+ * @param scene Scene handle
+ */
+void rf_scene_destroy(RFScene* scene);
+
+/**
+ * @brief Tune the receiver; builds the emitter tables unless cached.
+ *
+ * @param scene Scene handle
+ * @param center_freq LO frequency in Hz
+ * @return RF_SCENE_SUCCESS or a negative RFSceneErrorCode
+ */
+int rf_scene_tune(RFScene* scene, double center_freq);
+
+/**
+ * @brief Render the next @p num_samples I/Q pairs of the tuned scene.
+ *
+ * @param scene Scene handle (tuned)
+ * @param out Interleaved int8 I/Q, 2 * num_samples bytes
+ * @param num_samples Number of I/Q pairs
+ * @return RF_SCENE_SUCCESS or RF_SCENE_ERROR_PARAM when not tuned
+ */
+int rf_scene_generate(RFScene* scene, int8_t* out, size_t num_samples);
+
+/**
+ * @brief Number of continuous carriers and bursts inside the tuned band.
+ *
+ * @param scene Scene handle
+ * @param carriers Continuous carriers in band, or NULL
+ * @param bursts Bursty emitters in band, or NULL
+ */
+void rf_scene_in_band(const RFScene* scene, int* carriers, int* bursts);
+
+/**
+ * @brief Human-readable message for an RFSceneErrorCode.
+ *
+ * @param error_code Code returned by a scene function
+ * @return Constant description string
+ */
+const char* rf_scene_error_string(int error_code);
+
+#endif // RF_SCENE_H
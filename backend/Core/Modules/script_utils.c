@@ -145,6 +145,30 @@ void get_paths(env_path_t *paths) {
         fclose(fp);
         exit(EXIT_PATH_READ);
     }
+    // Optional keys; the environment wins over .env, as in common/path_handler.js
+    const char *format = getenv("CORE_SPECTRUM_FORMAT");
+    if (format != NULL && format[0] != '\0') {
+        snprintf(paths->core_spectrum_format, sizeof(paths->core_spectrum_format), "%s", format);
+    } else if (parse_env_key_internal(fp, "CORE_SPECTRUM_FORMAT", paths->core_spectrum_format,
+                                      sizeof(paths->core_spectrum_format)) ||
+               paths->core_spectrum_format[0] == '\0') {
+        strcpy(paths->core_spectrum_format, "json");
+    }
+    char slots[16] = "";
+    const char *ring = getenv("CORE_SPECTRUM_RING_SLOTS");
+    if (ring != NULL && ring[0] != '\0') {
+        snprintf(slots, sizeof(slots), "%s", ring);
+    } else if (parse_env_key_internal(fp, "CORE_SPECTRUM_RING_SLOTS", slots, sizeof(slots))) {
+        slots[0] = '\0';
+    }
+    paths->core_spectrum_ring_slots = (int)strtol(slots, NULL, 10);
+    const char *ring_path = getenv("CORE_SPECTRUM_RING_PATH");
+    if (ring_path != NULL && ring_path[0] != '\0') {
+        snprintf(paths->core_spectrum_ring_path, sizeof(paths->core_spectrum_ring_path), "%s", ring_path);
+    } else if (parse_env_key_internal(fp, "CORE_SPECTRUM_RING_PATH", paths->core_spectrum_ring_path,
+                                      sizeof(paths->core_spectrum_ring_path))) {
+        paths->core_spectrum_ring_path[0] = '\0';
+    }
     fclose(fp);
 }
 
@@ -22,19 +22,26 @@ typedef enum {
     EXIT_PATH_READ = 2
 } error_handler_t;
 
-// Holds application directory paths from the .env file
+// Holds application directory paths (and the spectrum output format) from the .env file
 typedef struct {
     char root_path[PATH_MAX + 1];
     char core_samples_path[PATH_MAX + 1];
     char core_json_path[PATH_MAX + 1];
     char core_bands_path[PATH_MAX + 1];
+    char core_spectrum_format[16];  // Optional CORE_SPECTRUM_FORMAT, "json" when absent
+    int core_spectrum_ring_slots;   // Optional CORE_SPECTRUM_RING_SLOTS, 0 (no ring) when absent
+    char core_spectrum_ring_path[PATH_MAX + 1];  // Optional CORE_SPECTRUM_RING_PATH, "" when absent
 } env_path_t;
 
 /**
  * @brief Locate and parse the .env file to populate required paths.
  *
  * Searches for “.env” in the executable’s directory and up to two parent levels.
- * Extracts ROOT_PATH, CORE_SAMPLES_PATH, CORE_JSON_PATH, and CORE_BANDS_PATH.
+ * Extracts ROOT_PATH, CORE_SAMPLES_PATH, CORE_JSON_PATH, and CORE_BANDS_PATH,
+ * plus the optional CORE_SPECTRUM_FORMAT (json, f32 or i16; default json), which
+ * the environment variable of the same name overrides. CORE_SPECTRUM_RING_SLOTS
+ * (frames kept in the shared-memory ring, 0 = none) and CORE_SPECTRUM_RING_PATH
+ * (the ring file, empty when absent) are read the same way.
  * On failure (file not found or missing key), prints an error and exits with EXIT_PATH_READ.
  *
  * @param paths Pointer to an env_path_t struct to receive the parsed paths.
@@ -0,0 +1,213 @@
+/**
+ * @file spectrum_frame.c
+ * @brief Binary spectrum frame encoder and writer.
+ * @ingroup signal_processor
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "spectrum_frame.h"
+#include "spectrum_json.h"
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+static const char* spectrum_frame_error_messages[] = {
+    "Success",
+    "Invalid argument",
+    "Memory allocation failed",
+    "Output file could not be written"
+};
+
+const char* spectrum_frame_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(spectrum_frame_error_messages) / sizeof(spectrum_frame_error_messages[0]))) {
+        return spectrum_frame_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+/* Little-endian stores, independent of the host byte order */
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void put_f64(uint8_t* p, double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u64(p, bits);
+}
+
+static void put_label(uint8_t* p, const char* text) {
+    memset(p, 0, 8);
+    memcpy(p, text, strnlen(text, 8));
+}
+
+/* dB to centi-dB, saturated; NaN becomes the INT16_MIN marker */
+static int16_t centi_db(double db) {
+    if (isnan(db)) {
+        return INT16_MIN;
+    }
+    double c = nearbyint(db * 100.0);
+    if (c > INT16_MAX) return INT16_MAX;
+    if (c < -INT16_MAX) return -INT16_MAX;
+    return (int16_t)c;
+}
+
+void spectrum_frame_init(SpectrumFrame* frame) {
+    memset(frame, 0, sizeof(*frame));
+}
+
+void spectrum_frame_free(SpectrumFrame* frame) {
+    if (frame == NULL) {
+        return;
+    }
+    free(frame->data);
+    free(frame->db);
+    frame->data = NULL;
+    frame->db = NULL;
+    frame->length = 0;
+    frame->capacity = 0;
+    frame->db_capacity = 0;
+}
+
+size_t spectrum_frame_size(int length, SpectrumFrameEncoding encoding) {
+    if (length <= 0) {
+        return 0;
+    }
+    switch (encoding) {
+        case SPECTRUM_FRAME_F32:
+            return SPECTRUM_FRAME_HEADER_SIZE + (size_t)length * sizeof(float);
+        case SPECTRUM_FRAME_I16:
+            return SPECTRUM_FRAME_HEADER_SIZE + (size_t)length * sizeof(int16_t);
+        default:
+            return 0;
+    }
+}
+
+/* Grow the dB work buffer; only spectra larger than any seen before allocate */
+static int spectrum_frame_reserve_db(SpectrumFrame* frame, int length) {
+    if (length > frame->db_capacity) {
+        double* db = (double*)realloc(frame->db, length * sizeof(double));
+        if (db == NULL) {
+            return SPECTRUM_FRAME_ERROR_MEMORY;
+        }
+        frame->db = db;
+        frame->db_capacity = length;
+    }
+    return SPECTRUM_FRAME_SUCCESS;
+}
+
+int spectrum_frame_encode(SpectrumFrame* frame, uint8_t* out, size_t capacity, const double* f,
+                          const dsp_real_t* psd, int length, double calibration_factor,
+                          SpectrumFrameEncoding encoding, size_t* written) {
+    size_t size = spectrum_frame_size(length, encoding);
+    if (frame == NULL || out == NULL || f == NULL || psd == NULL || written == NULL ||
+        size == 0 || size > capacity) {
+        return SPECTRUM_FRAME_ERROR_PARAM;
+    }
+    int result = spectrum_frame_reserve_db(frame, length);
+    if (result != SPECTRUM_FRAME_SUCCESS) {
+        return result;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t timestamp_us = (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+
+    put_u32(out + 0, SPECTRUM_FRAME_MAGIC);
+    put_u16(out + 4, SPECTRUM_FRAME_VERSION);
+    put_u16(out + 6, SPECTRUM_FRAME_HEADER_SIZE);
+    put_u16(out + 8, (uint16_t)encoding);
+    put_u16(out + 10, 0);
+    put_u32(out + 12, (uint32_t)length);
+    put_u64(out + 16, frame->sequence);
+    put_u64(out + 24, timestamp_us);
+    put_f64(out + 32, f[0]);
+    put_f64(out + 40, f[length - 1]);
+    put_f64(out + 48, length > 1 ? (f[length - 1] - f[0]) / (length - 1) : 0.0);
+    put_label(out + 56, "MHz");
+    put_label(out + 64, "VHF");
+    put_label(out + 72, "RMER");
+
+    /* Same dB values as the JSON document */
+    spectrum_db_convert(psd, frame->db, length, calibration_factor);
+
+    uint8_t* payload = out + SPECTRUM_FRAME_HEADER_SIZE;
+    if (encoding == SPECTRUM_FRAME_F32) {
+        for (int i = 0; i < length; i++) {
+            float value = (float)frame->db[i];
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            put_u32(payload + 4 * i, bits);
+        }
+    } else {
+        for (int i = 0; i < length; i++) {
+            put_u16(payload + 2 * i, (uint16_t)centi_db(frame->db[i]));
+        }
+    }
+
+    frame->sequence++;
+    *written = size;
+    return SPECTRUM_FRAME_SUCCESS;
+}
+
+int spectrum_frame_build(SpectrumFrame* frame, const double* f, const dsp_real_t* psd, int length,
+                         double calibration_factor, SpectrumFrameEncoding encoding) {
+    size_t size = spectrum_frame_size(length, encoding);
+    if (frame == NULL || size == 0) {
+        return SPECTRUM_FRAME_ERROR_PARAM;
+    }
+    if (size > frame->capacity) {
+        uint8_t* data = (uint8_t*)realloc(frame->data, size);
+        if (data == NULL) {
+            return SPECTRUM_FRAME_ERROR_MEMORY;
+        }
+        frame->data = data;
+        frame->capacity = size;
+    }
+    return spectrum_frame_encode(frame, frame->data, frame->capacity, f, psd, length,
+                                 calibration_factor, encoding, &frame->length);
+}
+
+int spectrum_frame_write(const SpectrumFrame* frame, const char* path) {
+    if (frame == NULL || frame->data == NULL || frame->length == 0 || path == NULL) {
+        return SPECTRUM_FRAME_ERROR_PARAM;
+    }
+
+    char tmp_path[PATH_MAX + 8];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        return SPECTRUM_FRAME_ERROR_PARAM;
+    }
+
+    FILE* file = fopen(tmp_path, "wb");
+    if (file == NULL) {
+        return SPECTRUM_FRAME_ERROR_FILE;
+    }
+    size_t written = fwrite(frame->data, 1, frame->length, file);
+    int closed = fclose(file);
+    if (written != frame->length || closed != 0 || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return SPECTRUM_FRAME_ERROR_FILE;
+    }
+    return SPECTRUM_FRAME_SUCCESS;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file spectrum_frame.h
+ * @brief Compact binary frame for the published spectrum (alternative to the JSON document).
+ * @ingroup signal_processor
+ *
+ * A frame is a fixed 80-byte header followed by one value per bin. All
+ * fields are little-endian; the payload starts 8-byte aligned.
+ *
+ * | Offset | Type     | Field                                              |
+ * |--------|----------|----------------------------------------------------|
+ * | 0      | u32      | magic, "SPFR" (SPECTRUM_FRAME_MAGIC)               |
+ * | 4      | u16      | version (SPECTRUM_FRAME_VERSION)                   |
+ * | 6      | u16      | header size in bytes (payload offset)              |
+ * | 8      | u16      | payload encoding (SpectrumFrameEncoding)           |
+ * | 10     | u16      | flags, 0                                           |
+ * | 12     | u32      | bins                                               |
+ * | 16     | u64      | sequence number, +1 per frame built                |
+ * | 24     | u64      | timestamp, µs since the Unix epoch                 |
+ * | 32     | f64      | fmin: frequency of bin 0                           |
+ * | 40     | f64      | fmax: frequency of the last bin                    |
+ * | 48     | f64      | df: bin spacing, f[i] = fmin + i * df              |
+ * | 56     | char[8]  | units of fmin/fmax/df ("MHz"), NUL-padded          |
+ * | 64     | char[8]  | band ("VHF"), NUL-padded                           |
+ * | 72     | char[8]  | measure ("RMER"), NUL-padded                       |
+ * | 80     | payload  | bins values, dB with the calibration applied       |
+ *
+ * Payload encodings:
+ * - SPECTRUM_FRAME_F32: float32 dB (NaN/inf as produced by log10).
+ * - SPECTRUM_FRAME_I16: int16 centi-dB, rounded and saturated to
+ *   ±32767 (±327.67 dB); INT16_MIN marks a bin without a value (NaN).
+ *
+ * 4096 bins take 16 KB (f32) or 8 KB (i16) instead of ~70 KB of JSON text.
+ * The frequency axis is uniform in every acquisition mode, so it travels as
+ * three numbers instead of one per bin.
+ *
+ * spectrum_frame_write() writes a temporary file and renames it over the
+ * destination, so a reader opening the path always sees a whole frame.
+ */
+
+#ifndef SPECTRUM_FRAME_H
+#define SPECTRUM_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dsp_precision.h"
+
+/** @brief "SPFR" read as a little-endian u32 */
+#define SPECTRUM_FRAME_MAGIC       0x52465053u
+#define SPECTRUM_FRAME_VERSION     1
+#define SPECTRUM_FRAME_HEADER_SIZE 80
+
+/**
+ * @brief Payload encodings (header offset 8)
+ */
+typedef enum {
+    SPECTRUM_FRAME_F32 = 1, /**< float32 dB */
+    SPECTRUM_FRAME_I16 = 2  /**< int16 centi-dB */
+} SpectrumFrameEncoding;
+
+/**
+ * @brief Error codes returned by the frame functions
+ */
+typedef enum {
+    SPECTRUM_FRAME_SUCCESS      =  0, /**< Success */
+    SPECTRUM_FRAME_ERROR_PARAM  = -1, /**< Invalid argument */
+    SPECTRUM_FRAME_ERROR_MEMORY = -2, /**< Allocation failure */
+    SPECTRUM_FRAME_ERROR_FILE   = -3  /**< Output file could not be written */
+} SpectrumFrameErrorCode;
+
+/**
+ * @brief Frame encoder: the last frame built, its work buffers and the sequence counter
+ */
+typedef struct {
+    uint8_t* data;        /**< Header + payload of the last frame */
+    size_t   length;      /**< Bytes in data */
+    size_t   capacity;    /**< Bytes allocated for data */
+    double*  db;          /**< dB values of the last build */
+    int      db_capacity; /**< Elements allocated for db */
+    uint64_t sequence;    /**< Sequence number of the next frame */
+} SpectrumFrame;
+
+/**
+ * @brief Start with empty buffers and sequence 0.
+ */
+void spectrum_frame_init(SpectrumFrame* frame);
+
+/**
+ * @brief Release the buffers.
+ */
+void spectrum_frame_free(SpectrumFrame* frame);
+
+/**
+ * @brief Encode one spectrum into frame->data.
+ *
+ * @param frame Encoder
+ * @param f Frequencies in MHz, uniformly spaced and ascending
+ * @param psd PSD in linear units
+ * @param length Number of bins
+ * @param calibration_factor Offset in dB added to every PSD bin
+ * @param encoding Payload encoding
+ * @return SPECTRUM_FRAME_SUCCESS or a negative SpectrumFrameErrorCode
+ */
+int spectrum_frame_build(SpectrumFrame* frame, const double* f, const dsp_real_t* psd, int length,
+                         double calibration_factor, SpectrumFrameEncoding encoding);
+
+/**
+ * @brief Encode one spectrum into a caller buffer (e.g. a shared-memory ring slot).
+ *
+ * Same frame as spectrum_frame_build(); @p frame only provides the dB work
+ * buffer and the sequence counter.
+ *
+ * @param out Destination, at least spectrum_frame_size(length, encoding) bytes
+ * @param capacity Bytes available at out
+ * @param written Receives the frame size in bytes
+ * @return SPECTRUM_FRAME_SUCCESS or a negative SpectrumFrameErrorCode
+ */
+int spectrum_frame_encode(SpectrumFrame* frame, uint8_t* out, size_t capacity, const double* f,
+                          const dsp_real_t* psd, int length, double calibration_factor,
+                          SpectrumFrameEncoding encoding, size_t* written);
+
+/**
+ * @brief Bytes of a frame of @p length bins (header included), 0 for an invalid encoding.
+ */
+size_t spectrum_frame_size(int length, SpectrumFrameEncoding encoding);
+
+/**
+ * @brief Replace @p path with the last built frame (write to path.tmp, then rename).
+ *
+ * @return SPECTRUM_FRAME_SUCCESS or SPECTRUM_FRAME_ERROR_FILE
+ */
+int spectrum_frame_write(const SpectrumFrame* frame, const char* path);
+
+/**
+ * @brief Human-readable message for a SpectrumFrameErrorCode.
+ */
+const char* spectrum_frame_error_string(int error_code);
+
+#endif // SPECTRUM_FRAME_H
@@ -0,0 +1,309 @@
+/**
+ * @file spectrum_json.c
+ * @brief dB conversion, fixed-point number formatting and the spectrum document writer.
+ * @ingroup signal_processor
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spectrum_json.h"
+
+#if defined(__GNUC__)
+    #define SPECTRUM_HAVE_VECTOR_EXT 1
+#else
+    #define SPECTRUM_HAVE_VECTOR_EXT 0
+#endif
+
+/* 10 * log10(2): dB per octave of power */
+#define DB_PER_LOG2 3.0102999566398119521
+/* 1 / ln(2) */
+#define LOG2_E 1.4426950408889634074
+
+#define DOUBLE_MANTISSA_MASK 0x000fffffffffffffLL
+#define DOUBLE_ONE_BITS      0x3ff0000000000000LL
+/* Bits of 1.5 * 2^52: adding a small signed integer to them gives 1.5 * 2^52 + that integer */
+#define DOUBLE_MAGIC_BITS    0x4338000000000000LL
+#define DOUBLE_MAGIC         6755399441055744.0
+
+/* Document text around the two vectors, as cJSON_Print() formats it */
+static const char spectrum_json_head[] =
+    "{\n"
+    "\t\"data\":\t{\n"
+    "\t\t\"band\":\t\"VHF\",\n"
+    "\t\t\"fmin\":\t\"88\",\n"
+    "\t\t\"fmax\":\t\"108\",\n"
+    "\t\t\"units\":\t\"MHz\",\n"
+    "\t\t\"measure\":\t\"RMER\",\n"
+    "\t\t\"vectors\":\t{\n"
+    "\t\t\t\"Pxx\":\t[";
+static const char spectrum_json_middle[] =
+    "],\n"
+    "\t\t\t\"f\":\t[";
+static const char spectrum_json_tail[] =
+    "]\n"
+    "\t\t},\n"
+    "\t\t\"parameters\":\t[]\n"
+    "\t}\n"
+    "}";
+
+static const char* spectrum_json_error_messages[] = {
+    "Success",
+    "Invalid argument",
+    "Memory allocation failed",
+    "Output file could not be written"
+};
+
+const char* spectrum_json_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(spectrum_json_error_messages) / sizeof(spectrum_json_error_messages[0]))) {
+        return spectrum_json_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+/* ----------------------------------------------------------------------- */
+/* dB conversion                                                            */
+/* ----------------------------------------------------------------------- */
+
+/*
+ * log2(x) for a normal, positive, finite x: x = 2^e * m with m folded into
+ * [sqrt(1/2), sqrt(2)), ln(m) = 2 atanh(t) with t = (m - 1) / (m + 1) and
+ * |t| <= 0.1716, truncated after t^7. The first dropped term bounds the
+ * error of ln(m) by 3e-8, i.e. 1.3e-7 dB.
+ */
+static double log2_scalar(double x) {
+    int64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int64_t exponent = ((bits >> 52) & 0x7ff) - 1023;
+    bits = (bits & DOUBLE_MANTISSA_MASK) | DOUBLE_ONE_BITS;
+
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m > M_SQRT2) {
+        m *= 0.5;
+        exponent++;
+    }
+    double t = (m - 1.0) / (m + 1.0);
+    double t2 = t * t;
+    double ln_m = t * (2.0 + t2 * (2.0 / 3.0 + t2 * (2.0 / 5.0 + t2 * (2.0 / 7.0))));
+    return (double)exponent + ln_m * LOG2_E;
+}
+
+/* Inputs the approximation does not cover: zero, negative, subnormal, infinite, NaN */
+static int db_needs_libm(double x) {
+    return !(x >= DBL_MIN && x <= DBL_MAX);
+}
+
+#if SPECTRUM_HAVE_VECTOR_EXT
+typedef double  v4f64 __attribute__((vector_size(32)));
+typedef int64_t v4i64 __attribute__((vector_size(32)));
+#endif
+
+void spectrum_db_convert(const dsp_real_t* psd, double* db, int length, double offset) {
+    int i = 0;
+
+#if SPECTRUM_HAVE_VECTOR_EXT
+    for (; i + 4 <= length; i += 4) {
+        /* log2_scalar() on four lanes; lowered to SSE2/AVX2 (or NEON) by the compiler */
+        v4f64 x = { psd[i], psd[i + 1], psd[i + 2], psd[i + 3] };
+        v4i64 bits = (v4i64)x;
+        v4i64 exponent = ((bits >> 52) & 0x7ff) - 1023;
+        v4f64 m = (v4f64)((bits & DOUBLE_MANTISSA_MASK) | DOUBLE_ONE_BITS);
+
+        /* Lanes above sqrt(2): halve m, one more octave (the mask is -1 there) */
+        v4i64 fold = (v4i64)(m > M_SQRT2);
+        m = (v4f64)(((v4i64)(m * 0.5) & fold) | ((v4i64)m & ~fold));
+        exponent -= fold;
+
+        v4f64 t = (m - 1.0) / (m + 1.0);
+        v4f64 t2 = t * t;
+        v4f64 ln_m = t * (2.0 + t2 * (2.0 / 3.0 + t2 * (2.0 / 5.0 + t2 * (2.0 / 7.0))));
+
+        /* int64 -> double without a 64-bit convert instruction: |exponent| < 2^51 */
+        v4f64 e = (v4f64)(exponent + DOUBLE_MAGIC_BITS) - DOUBLE_MAGIC;
+        v4f64 y = (e + ln_m * LOG2_E) * DB_PER_LOG2 + offset;
+        memcpy(db + i, &y, sizeof(y));
+
+        v4i64 bad = (x < DBL_MIN) | (x > DBL_MAX) | (x != x);
+        if (bad[0] | bad[1] | bad[2] | bad[3]) {
+            for (int k = i; k < i + 4; k++) {
+                if (db_needs_libm(psd[k])) {
+                    db[k] = 10.0 * log10(psd[k]) + offset;
+                }
+            }
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        double x = psd[i];
+        db[i] = db_needs_libm(x) ? 10.0 * log10(x) + offset
+                                 : log2_scalar(x) * DB_PER_LOG2 + offset;
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+/* Number formatting                                                        */
+/* ----------------------------------------------------------------------- */
+
+size_t spectrum_format_fixed3(double value, char* out) {
+    if (!isfinite(value)) {
+        memcpy(out, "null", 5);
+        return 4;
+    }
+
+    double scaled = value * 1000.0;
+    if (fabs(scaled) >= 9.0e15) {
+        /* Beyond any frequency or level; no exact integer thousandths */
+        return (size_t)snprintf(out, SPECTRUM_NUMBER_MAX, "%1.15g", value);
+    }
+
+    /*
+     * Round half to even on the exact value, like "%.3f". The product is
+     * only ambiguous when it lands exactly on a half: the fma residual then
+     * tells on which side the exact product lies.
+     */
+    double rounded = nearbyint(scaled);
+    if (fabs(scaled - trunc(scaled)) == 0.5) {
+        double residual = fma(value, 1000.0, -scaled);
+        if (residual > 0.0) {
+            rounded = floor(scaled) + 1.0;
+        } else if (residual < 0.0) {
+            rounded = floor(scaled);
+        }
+    }
+
+    int64_t thousandths = (int64_t)rounded;
+    char* p = out;
+    if (thousandths < 0) {
+        *p++ = '-';
+        thousandths = -thousandths;
+    }
+    uint64_t integer = (uint64_t)thousandths / 1000;
+    unsigned fraction = (unsigned)((uint64_t)thousandths % 1000);
+
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + integer % 10);
+        integer /= 10;
+    } while (integer != 0);
+    while (count > 0) {
+        *p++ = digits[--count];
+    }
+
+    /* Up to three decimals, trailing zeros dropped */
+    if (fraction != 0) {
+        *p++ = '.';
+        *p++ = (char)('0' + fraction / 100);
+        if (fraction % 100 != 0) {
+            *p++ = (char)('0' + fraction / 10 % 10);
+            if (fraction % 10 != 0) {
+                *p++ = (char)('0' + fraction % 10);
+            }
+        }
+    }
+    *p = '\0';
+    return (size_t)(p - out);
+}
+
+/* ----------------------------------------------------------------------- */
+/* Document                                                                 */
+/* ----------------------------------------------------------------------- */
+
+void spectrum_json_init(SpectrumJson* json) {
+    memset(json, 0, sizeof(*json));
+}
+
+void spectrum_json_free(SpectrumJson* json) {
+    if (json == NULL) {
+        return;
+    }
+    free(json->data);
+    free(json->db);
+    memset(json, 0, sizeof(*json));
+}
+
+/* Size both buffers for a spectrum of length bins; only growth allocates */
+static int spectrum_json_reserve(SpectrumJson* json, int length) {
+    if (length > json->db_capacity) {
+        double* db = (double*)realloc(json->db, length * sizeof(double));
+        if (db == NULL) {
+            return SPECTRUM_JSON_ERROR_MEMORY;
+        }
+        json->db = db;
+        json->db_capacity = length;
+    }
+
+    /* Every number plus its ", " separator, for both vectors */
+    size_t needed = sizeof(spectrum_json_head) + sizeof(spectrum_json_middle) + sizeof(spectrum_json_tail) +
+                    2 * (size_t)length * (SPECTRUM_NUMBER_MAX + 2);
+    if (needed > json->capacity) {
+        char* data = (char*)realloc(json->data, needed);
+        if (data == NULL) {
+            return SPECTRUM_JSON_ERROR_MEMORY;
+        }
+        json->data = data;
+        json->capacity = needed;
+    }
+    return SPECTRUM_JSON_SUCCESS;
+}
+
+static char* spectrum_json_append(char* p, const char* text, size_t length) {
+    memcpy(p, text, length);
+    return p + length;
+}
+
+/* Comma-separated fixed3 values, cJSON array style */
+static char* spectrum_json_append_numbers(char* p, const double* values, int length) {
+    for (int i = 0; i < length; i++) {
+        if (i > 0) {
+            *p++ = ',';
+            *p++ = ' ';
+        }
+        p += spectrum_format_fixed3(values[i], p);
+    }
+    return p;
+}
+
+int spectrum_json_build(SpectrumJson* json, const double* f, const dsp_real_t* psd, int length,
+                        double calibration_factor) {
+    if (json == NULL || f == NULL || psd == NULL || length <= 0) {
+        return SPECTRUM_JSON_ERROR_PARAM;
+    }
+    int result = spectrum_json_reserve(json, length);
+    if (result != SPECTRUM_JSON_SUCCESS) {
+        return result;
+    }
+
+    spectrum_db_convert(psd, json->db, length, calibration_factor);
+
+    char* p = json->data;
+    p = spectrum_json_append(p, spectrum_json_head, sizeof(spectrum_json_head) - 1);
+    p = spectrum_json_append_numbers(p, json->db, length);
+    p = spectrum_json_append(p, spectrum_json_middle, sizeof(spectrum_json_middle) - 1);
+    p = spectrum_json_append_numbers(p, f, length);
+    p = spectrum_json_append(p, spectrum_json_tail, sizeof(spectrum_json_tail) - 1);
+    *p = '\0';
+    json->length = (size_t)(p - json->data);
+    return SPECTRUM_JSON_SUCCESS;
+}
+
+int spectrum_json_write(const SpectrumJson* json, const char* path) {
+    if (json == NULL || json->data == NULL || path == NULL) {
+        return SPECTRUM_JSON_ERROR_PARAM;
+    }
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return SPECTRUM_JSON_ERROR_FILE;
+    }
+    size_t written = fwrite(json->data, 1, json->length, file);
+    int closed = fclose(file);
+    return (written == json->length && closed == 0) ? SPECTRUM_JSON_SUCCESS : SPECTRUM_JSON_ERROR_FILE;
+}
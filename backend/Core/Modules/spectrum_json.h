@@ -0,0 +1,111 @@
+/**
+ * @file spectrum_json.h
+ * @brief Direct serializer for the spectrum document published to the web interface.
+ * @ingroup signal_processor
+ *
+ * Writes the same {"data": {...}} document as create_signal_json() followed
+ * by cJSON_Print(), byte for byte in layout, without building a cJSON tree:
+ *
+ * - PSD bins are converted to dB by spectrum_db_convert(), a vectorized
+ *   log2 approximation (exponent extraction plus an odd polynomial in
+ *   (m - 1) / (m + 1)) with an absolute error below 2e-7 dB; zero, negative,
+ *   subnormal and non-finite bins take the libm path.
+ * - Every number is rounded to 3 decimals and printed by an integer
+ *   formatter, with the digits cJSON would print for the rounded value
+ *   (trailing zeros dropped, "null" for non-finite values).
+ * - The text goes into a buffer owned by the serializer and reused by every
+ *   call, so steady-state cycles allocate nothing.
+ *
+ * Frequencies are rounded exactly as "%.3f" does. Because of the dB
+ * approximation, a PSD value within 2e-7 dB of a rounding boundary can
+ * differ from the libm result by 0.001 dB in the last digit.
+ *
+ * @code
+ * SpectrumJson json;
+ * spectrum_json_init(&json);
+ * spectrum_json_build(&json, f, psd, 4096, calibration);
+ * spectrum_json_write(&json, "JSON/0");
+ * spectrum_json_free(&json);
+ * @endcode
+ */
+
+#ifndef SPECTRUM_JSON_H
+#define SPECTRUM_JSON_H
+
+#include <stddef.h>
+#include "dsp_precision.h"
+
+/** @brief Longest number spectrum_format_fixed3() writes, including the terminator */
+#define SPECTRUM_NUMBER_MAX 32
+
+/**
+ * @brief Error codes returned by the serializer
+ */
+typedef enum {
+    SPECTRUM_JSON_SUCCESS      =  0, /**< Success */
+    SPECTRUM_JSON_ERROR_PARAM  = -1, /**< Invalid argument */
+    SPECTRUM_JSON_ERROR_MEMORY = -2, /**< Allocation failure */
+    SPECTRUM_JSON_ERROR_FILE   = -3  /**< Output file could not be written */
+} SpectrumJsonErrorCode;
+
+/**
+ * @brief Serializer state: the document of the last build and its work buffers
+ */
+typedef struct {
+    char*   data;        /**< Document text (NUL-terminated) */
+    size_t  length;      /**< Bytes in data, terminator excluded */
+    size_t  capacity;    /**< Bytes allocated for data */
+    double* db;          /**< dB values of the last build */
+    int     db_capacity; /**< Elements allocated for db */
+} SpectrumJson;
+
+/**
+ * @brief Start with empty buffers; they grow on the first build.
+ */
+void spectrum_json_init(SpectrumJson* json);
+
+/**
+ * @brief Release the buffers.
+ */
+void spectrum_json_free(SpectrumJson* json);
+
+/**
+ * @brief Serialize one spectrum into json->data.
+ *
+ * @param json Serializer
+ * @param f Frequencies in MHz
+ * @param psd PSD in linear units
+ * @param length Number of bins
+ * @param calibration_factor Offset in dB added to every PSD bin
+ * @return SPECTRUM_JSON_SUCCESS or a negative SpectrumJsonErrorCode
+ */
+int spectrum_json_build(SpectrumJson* json, const double* f, const dsp_real_t* psd, int length,
+                        double calibration_factor);
+
+/**
+ * @brief Write the last built document to @p path (truncating it).
+ *
+ * @return SPECTRUM_JSON_SUCCESS or SPECTRUM_JSON_ERROR_FILE
+ */
+int spectrum_json_write(const SpectrumJson* json, const char* path);
+
+/**
+ * @brief db[i] = 10 * log10(psd[i]) + offset, vectorized (see the file comment for the error bound).
+ */
+void spectrum_db_convert(const dsp_real_t* psd, double* db, int length, double offset);
+
+/**
+ * @brief Print @p value rounded to 3 decimals the way the spectrum document does.
+ *
+ * @param value Number to print
+ * @param out At least SPECTRUM_NUMBER_MAX bytes; NUL-terminated on return
+ * @return Characters written, terminator excluded
+ */
+size_t spectrum_format_fixed3(double value, char* out);
+
+/**
+ * @brief Human-readable message for a SpectrumJsonErrorCode.
+ */
+const char* spectrum_json_error_string(int error_code);
+
+#endif // SPECTRUM_JSON_H
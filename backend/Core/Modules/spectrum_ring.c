@@ -0,0 +1,284 @@
+/**
+ * @file spectrum_ring.c
+ * @brief Memory-mapped spectrum ring with per-slot seqlocks.
+ * @ingroup signal_processor
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "spectrum_ring.h"
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+/* The header and slot words are shared as native integers */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "spectrum_ring: the ring layout is little-endian"
+#endif
+
+#define SPECTRUM_RING_ALIGN 64
+
+typedef struct {
+    uint32_t         magic;
+    uint16_t         version;
+    uint16_t         header_size;
+    uint32_t         slot_count;
+    uint32_t         slot_size;
+    _Atomic uint64_t published;
+    uint8_t          reserved[SPECTRUM_RING_HEADER_SIZE - 24];
+} RingHeader;
+
+typedef struct {
+    _Atomic uint64_t seq;
+    uint32_t         length;
+    uint32_t         reserved;
+} RingSlot;
+
+_Static_assert(sizeof(RingHeader) == SPECTRUM_RING_HEADER_SIZE, "ring header layout");
+_Static_assert(sizeof(RingSlot) == SPECTRUM_RING_SLOT_HEADER, "ring slot layout");
+
+struct SpectrumRing {
+    uint8_t*    base;        /**< Mapping of the whole file */
+    size_t      size;
+    RingHeader* header;
+    bool        writer;
+    uint64_t    next;        /**< Writer: number of the frame being or next to be written */
+};
+
+static const char* spectrum_ring_error_messages[] = {
+    "Success",
+    "Invalid argument",
+    "Memory allocation failed",
+    "Ring file could not be created or mapped",
+    "Not a spectrum ring of this version",
+    "Frame not available"
+};
+
+const char* spectrum_ring_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(spectrum_ring_error_messages) / sizeof(spectrum_ring_error_messages[0]))) {
+        return spectrum_ring_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+static SpectrumRing* ring_fail(int* error, int code) {
+    if (error != NULL) {
+        *error = code;
+    }
+    return NULL;
+}
+
+static RingSlot* ring_slot(const SpectrumRing* ring, uint64_t frame_number) {
+    uint64_t index = frame_number % ring->header->slot_count;
+    return (RingSlot*)(ring->base + ring->header->header_size + index * ring->header->slot_size);
+}
+
+SpectrumRing* spectrum_ring_create(const char* path, int slot_count, size_t frame_capacity,
+                                   uint64_t first_frame, int* error) {
+    if (path == NULL || slot_count < 2 || frame_capacity == 0) {
+        return ring_fail(error, SPECTRUM_RING_ERROR_PARAM);
+    }
+    size_t slot_size = (SPECTRUM_RING_SLOT_HEADER + frame_capacity + SPECTRUM_RING_ALIGN - 1) &
+                       ~(size_t)(SPECTRUM_RING_ALIGN - 1);
+    if (slot_size > UINT32_MAX) {
+        return ring_fail(error, SPECTRUM_RING_ERROR_PARAM);
+    }
+    size_t size = SPECTRUM_RING_HEADER_SIZE + (size_t)slot_count * slot_size;
+
+    /*
+     * Built under a temporary name and renamed into place: readers that
+     * still map a previous ring keep a valid (if stale) mapping instead of
+     * faulting on a truncated file.
+     */
+    char tmp_path[PATH_MAX + 8];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        return ring_fail(error, SPECTRUM_RING_ERROR_PARAM);
+    }
+    int fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[ring] Cannot create %s: %s\n", tmp_path, strerror(errno));
+        return ring_fail(error, SPECTRUM_RING_ERROR_FILE);
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        fprintf(stderr, "[ring] Cannot size %s: %s\n", tmp_path, strerror(errno));
+        close(fd);
+        unlink(tmp_path);
+        return ring_fail(error, SPECTRUM_RING_ERROR_FILE);
+    }
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "[ring] Cannot map %s: %s\n", tmp_path, strerror(errno));
+        unlink(tmp_path);
+        return ring_fail(error, SPECTRUM_RING_ERROR_FILE);
+    }
+
+    SpectrumRing* ring = (SpectrumRing*)calloc(1, sizeof(SpectrumRing));
+    if (ring == NULL) {
+        munmap(base, size);
+        unlink(tmp_path);
+        return ring_fail(error, SPECTRUM_RING_ERROR_MEMORY);
+    }
+    ring->base = (uint8_t*)base;
+    ring->size = size;
+    ring->header = (RingHeader*)base;
+    ring->writer = true;
+    ring->next = first_frame;
+
+    /* Slots are zero (seq 0 matches no frame) after ftruncate */
+    ring->header->magic = SPECTRUM_RING_MAGIC;
+    ring->header->version = SPECTRUM_RING_VERSION;
+    ring->header->header_size = SPECTRUM_RING_HEADER_SIZE;
+    ring->header->slot_count = (uint32_t)slot_count;
+    ring->header->slot_size = (uint32_t)slot_size;
+    atomic_store_explicit(&ring->header->published, first_frame, memory_order_release);
+
+    if (rename(tmp_path, path) != 0) {
+        fprintf(stderr, "[ring] Cannot rename %s to %s: %s\n", tmp_path, path, strerror(errno));
+        spectrum_ring_close(ring);
+        unlink(tmp_path);
+        return ring_fail(error, SPECTRUM_RING_ERROR_FILE);
+    }
+    if (error != NULL) {
+        *error = SPECTRUM_RING_SUCCESS;
+    }
+    return ring;
+}
+
+SpectrumRing* spectrum_ring_open(const char* path, int* error) {
+    if (path == NULL) {
+        return ring_fail(error, SPECTRUM_RING_ERROR_PARAM);
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return ring_fail(error, SPECTRUM_RING_ERROR_FILE);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SPECTRUM_RING_HEADER_SIZE) {
+        close(fd);
+        return ring_fail(error, SPECTRUM_RING_ERROR_FORMAT);
+    }
+    size_t size = (size_t)st.st_size;
+    void* base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return ring_fail(error, SPECTRUM_RING_ERROR_FILE);
+    }
+
+    const RingHeader* header = (const RingHeader*)base;
+    if (header->magic != SPECTRUM_RING_MAGIC || header->version != SPECTRUM_RING_VERSION ||
+        header->header_size < SPECTRUM_RING_HEADER_SIZE || header->slot_count < 2 ||
+        header->slot_size <= SPECTRUM_RING_SLOT_HEADER ||
+        size < header->header_size + (size_t)header->slot_count * header->slot_size) {
+        munmap(base, size);
+        return ring_fail(error, SPECTRUM_RING_ERROR_FORMAT);
+    }
+
+    SpectrumRing* ring = (SpectrumRing*)calloc(1, sizeof(SpectrumRing));
+    if (ring == NULL) {
+        munmap(base, size);
+        return ring_fail(error, SPECTRUM_RING_ERROR_MEMORY);
+    }
+    ring->base = (uint8_t*)base;
+    ring->size = size;
+    ring->header = (RingHeader*)base;
+    ring->writer = false;
+    if (error != NULL) {
+        *error = SPECTRUM_RING_SUCCESS;
+    }
+    return ring;
+}
+
+void spectrum_ring_close(SpectrumRing* ring) {
+    if (ring == NULL) {
+        return;
+    }
+    munmap(ring->base, ring->size);
+    free(ring);
+}
+
+uint8_t* spectrum_ring_begin(SpectrumRing* ring, size_t* capacity) {
+    if (ring == NULL || !ring->writer || capacity == NULL) {
+        return NULL;
+    }
+    RingSlot* slot = ring_slot(ring, ring->next);
+
+    /* Odd: readers of this slot back off until the commit */
+    atomic_store_explicit(&slot->seq, 2 * ring->next + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    *capacity = ring->header->slot_size - SPECTRUM_RING_SLOT_HEADER;
+    return (uint8_t*)slot + SPECTRUM_RING_SLOT_HEADER;
+}
+
+int spectrum_ring_commit(SpectrumRing* ring, size_t length) {
+    if (ring == NULL || !ring->writer || length > ring->header->slot_size - SPECTRUM_RING_SLOT_HEADER) {
+        return SPECTRUM_RING_ERROR_PARAM;
+    }
+    RingSlot* slot = ring_slot(ring, ring->next);
+    slot->length = (uint32_t)length;
+
+    /* Frame and length before the even seq, the seq before the published count */
+    atomic_store_explicit(&slot->seq, 2 * ring->next + 2, memory_order_release);
+    ring->next++;
+    atomic_store_explicit(&ring->header->published, ring->next, memory_order_release);
+    return SPECTRUM_RING_SUCCESS;
+}
+
+uint64_t spectrum_ring_published(const SpectrumRing* ring) {
+    if (ring == NULL) {
+        return 0;
+    }
+    return atomic_load_explicit(&ring->header->published, memory_order_acquire);
+}
+
+int spectrum_ring_slot_count(const SpectrumRing* ring) {
+    return ring != NULL ? (int)ring->header->slot_count : 0;
+}
+
+size_t spectrum_ring_frame_capacity(const SpectrumRing* ring) {
+    return ring != NULL ? ring->header->slot_size - SPECTRUM_RING_SLOT_HEADER : 0;
+}
+
+int spectrum_ring_read(const SpectrumRing* ring, uint64_t frame_number, uint8_t* out, size_t capacity,
+                       size_t* length) {
+    if (ring == NULL || out == NULL || length == NULL) {
+        return SPECTRUM_RING_ERROR_PARAM;
+    }
+    RingSlot* slot = ring_slot(ring, frame_number);
+    uint64_t expected = 2 * frame_number + 2;
+
+    uint64_t before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (before != expected) {
+        return SPECTRUM_RING_ERROR_STALE;
+    }
+    size_t frame_length = slot->length;
+    if (frame_length > ring->header->slot_size - SPECTRUM_RING_SLOT_HEADER) {
+        return SPECTRUM_RING_ERROR_STALE;
+    }
+    if (frame_length > capacity) {
+        return SPECTRUM_RING_ERROR_PARAM;
+    }
+    memcpy(out, (const uint8_t*)slot + SPECTRUM_RING_SLOT_HEADER, frame_length);
+
+    /* The copy is only good if the writer did not enter the slot meanwhile */
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t after = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    if (after != before) {
+        return SPECTRUM_RING_ERROR_STALE;
+    }
+    *length = frame_length;
+    return SPECTRUM_RING_SUCCESS;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file spectrum_ring.h
+ * @brief Memory-mapped ring of spectrum frames shared with the web server.
+ * @ingroup signal_processor
+ *
+ * Replaces rewriting one output file per cycle: the core maps a file of N
+ * fixed-size slots and encodes every frame (spectrum_frame.h) straight into
+ * the next slot. Readers (the Node server with pread(), or another process
+ * with mmap()) take the latest frame or the last N frames without locking
+ * the writer out, and a half-written or overwritten slot is always detected.
+ *
+ * File layout, little-endian, slots 64-byte aligned:
+ *
+ * | Offset | Type | Field                                                 |
+ * |--------|------|-------------------------------------------------------|
+ * | 0      | u32  | magic, "SPRG" (SPECTRUM_RING_MAGIC)                   |
+ * | 4      | u16  | version (SPECTRUM_RING_VERSION)                       |
+ * | 6      | u16  | header size (offset of slot 0)                        |
+ * | 8      | u32  | slot count N                                          |
+ * | 12     | u32  | slot size in bytes                                    |
+ * | 16     | u64  | published: frames committed so far                    |
+ *
+ * Slot i starts at header size + i * slot size:
+ *
+ * | Offset | Type | Field                                                 |
+ * |--------|------|-------------------------------------------------------|
+ * | 0      | u64  | seq: 2k+1 while frame k is written, 2k+2 once done    |
+ * | 8      | u32  | frame length in bytes                                 |
+ * | 16     | ...  | frame k (spectrum_frame.h layout)                     |
+ *
+ * Frame k always goes to slot k % N, so the seq of a slot is a seqlock that
+ * also names the frame it holds. To read frame k (the latest is
+ * published - 1, the oldest still available published - N):
+ *
+ * 1. s1 = seq of slot k % N; give up if s1 != 2k + 2 (not written yet,
+ *    being rewritten, or already replaced by frame k + N)
+ * 2. copy the length and the frame
+ * 3. s2 = seq again; the copy is valid only if s2 == s1
+ *
+ * There is a single writer; any number of readers, which never write.
+ */
+
+#ifndef SPECTRUM_RING_H
+#define SPECTRUM_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief "SPRG" read as a little-endian u32 */
+#define SPECTRUM_RING_MAGIC         0x47525053u
+#define SPECTRUM_RING_VERSION       1
+#define SPECTRUM_RING_HEADER_SIZE   64
+#define SPECTRUM_RING_SLOT_HEADER   16
+
+/**
+ * @brief Error codes returned by the ring functions
+ */
+typedef enum {
+    SPECTRUM_RING_SUCCESS      =  0, /**< Success */
+    SPECTRUM_RING_ERROR_PARAM  = -1, /**< Invalid argument */
+    SPECTRUM_RING_ERROR_MEMORY = -2, /**< Allocation failure */
+    SPECTRUM_RING_ERROR_FILE   = -3, /**< Ring file could not be created, sized or mapped */
+    SPECTRUM_RING_ERROR_FORMAT = -4, /**< File is not a ring of this version */
+    SPECTRUM_RING_ERROR_STALE  = -5  /**< Frame not published yet, or overwritten */
+} SpectrumRingErrorCode;
+
+/**
+ * @brief Opaque handle on a mapped ring (writer or reader)
+ */
+typedef struct SpectrumRing SpectrumRing;
+
+/**
+ * @brief Create (or truncate) the ring file and map it for writing.
+ *
+ * @param path Ring file; best on a tmpfs (e.g. /dev/shm) so pages are never written back
+ * @param slot_count Number of frames kept (N >= 2)
+ * @param frame_capacity Largest frame in bytes a slot must hold
+ * @param first_frame Number given to the first frame committed (0 for a new ring,
+ *        or the previous ring's published count to keep numbers increasing when resizing)
+ * @param error Receives the SpectrumRingErrorCode on failure (may be NULL)
+ * @return New writer handle, or NULL on failure
+ */
+SpectrumRing* spectrum_ring_create(const char* path, int slot_count, size_t frame_capacity,
+                                   uint64_t first_frame, int* error);
+
+/**
+ * @brief Map an existing ring read-only.
+ *
+ * @param error Receives the SpectrumRingErrorCode on failure (may be NULL)
+ * @return New reader handle, or NULL on failure
+ */
+SpectrumRing* spectrum_ring_open(const char* path, int* error);
+
+/**
+ * @brief Unmap and close the ring (NULL is a no-op). The file stays in place.
+ */
+void spectrum_ring_close(SpectrumRing* ring);
+
+/**
+ * @brief Writer: slot for the next frame, marked as being written.
+ *
+ * Encode the frame directly at the returned address, then call
+ * spectrum_ring_commit(). Readers skip the slot until then.
+ *
+ * @param capacity Receives the bytes available in the slot
+ * @return Frame area of the slot, or NULL for a reader handle
+ */
+uint8_t* spectrum_ring_begin(SpectrumRing* ring, size_t* capacity);
+
+/**
+ * @brief Writer: publish the frame started by spectrum_ring_begin().
+ *
+ * @param length Bytes of the frame (<= the slot capacity)
+ * @return SPECTRUM_RING_SUCCESS or SPECTRUM_RING_ERROR_PARAM
+ */
+int spectrum_ring_commit(SpectrumRing* ring, size_t length);
+
+/**
+ * @brief Number of frames committed so far (the latest is this - 1).
+ */
+uint64_t spectrum_ring_published(const SpectrumRing* ring);
+
+/**
+ * @brief Slot count and largest frame a slot holds.
+ */
+int spectrum_ring_slot_count(const SpectrumRing* ring);
+size_t spectrum_ring_frame_capacity(const SpectrumRing* ring);
+
+/**
+ * @brief Copy frame @p frame_number out of the ring, with the seqlock check.
+ *
+ * @param out Destination
+ * @param capacity Bytes available at out
+ * @param length Receives the frame length
+ * @return SPECTRUM_RING_SUCCESS, SPECTRUM_RING_ERROR_STALE if the frame is
+ *         not (or no longer) in the ring or was being rewritten during the
+ *         copy, SPECTRUM_RING_ERROR_PARAM if out is too small
+ */
+int spectrum_ring_read(const SpectrumRing* ring, uint64_t frame_number, uint8_t* out, size_t capacity,
+                       size_t* length);
+
+/**
+ * @brief Human-readable message for a SpectrumRingErrorCode.
+ */
+const char* spectrum_ring_error_string(int error_code);
+
+#endif // SPECTRUM_RING_H
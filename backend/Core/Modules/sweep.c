@@ -0,0 +1,310 @@
+/**
+ * @file sweep.c
+ * @brief Window planning, trimming and stitching for wideband sweeps.
+ *
+ * All bookkeeping is done in integer bins. LOs sit on the grid of the
+ * coarsest resolution (df_c = fs / N_min), and every other segment length is
+ * a multiple of N_min, so the LO offset of a window is an integer number of
+ * bins at every resolution. Window bins are addressed by their signed offset
+ * o from the LO; the engine returns raw FFT order, where offset o lives at
+ * index (o + N) % N.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "CS8toIQ.h"
+#include "sweep.h"
+
+typedef struct {
+    int         segment_length;
+    int         ratio;          /**< segment_length / N_min */
+    double      df;             /**< Bin width in Hz */
+    int         bins;           /**< Output bins */
+    int         keep_min;       /**< Smallest |offset| kept (DC exclusion) */
+    int         keep_max;       /**< Largest |offset| kept (band-edge trim) */
+    double*     sum;            /**< Linear power summed over windows */
+    uint16_t*   hits;           /**< Windows that contributed to each bin */
+    double*     f_window;       /**< Engine frequency output (unused, required) */
+    dsp_real_t* P_window;       /**< Engine PSD of the current window */
+} SweepResolution;
+
+struct Sweep {
+    SweepConfig     config;
+    WelchEngine*    engine;
+    SweepResolution res[SWEEP_MAX_RESOLUTIONS];
+    int             window_count;
+    int*            window_offset;  /**< LO of each window in coarse bins above lo_freq */
+    uint64_t*       window_center;  /**< LO of each window in Hz */
+    int8_t*         capture;        /**< Buffer used by sweep_run() */
+    size_t          capture_bytes;
+};
+
+static const char* sweep_error_messages[] = {
+    "Success",
+    "Invalid sweep configuration",
+    "Memory allocation failed",
+    "Window capture failed",
+    "Window PSD failed",
+    "Sweep does not cover the whole band"
+};
+
+const char* sweep_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(sweep_error_messages) / sizeof(sweep_error_messages[0]))) {
+        return sweep_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+void sweep_destroy(Sweep* sweep) {
+    if (!sweep) return;
+
+    for (int r = 0; r < SWEEP_MAX_RESOLUTIONS; r++) {
+        free(sweep->res[r].sum);
+        free(sweep->res[r].hits);
+        free(sweep->res[r].f_window);
+        free(sweep->res[r].P_window);
+    }
+    free(sweep->window_offset);
+    free(sweep->window_center);
+    free(sweep->capture);
+    free(sweep);
+}
+
+Sweep* sweep_create(const SweepConfig* config, WelchEngine* engine) {
+    if (!config || !engine || config->sample_rate <= 0.0 ||
+        config->hi_freq <= config->lo_freq ||
+        config->resolution_count < 1 || config->resolution_count > SWEEP_MAX_RESOLUTIONS ||
+        config->usable_fraction <= 0.0 || config->usable_fraction > 1.0 ||
+        config->dc_exclusion_hz < 0.0 || config->samples_per_window == 0) {
+        return NULL;
+    }
+
+    int count = config->resolution_count;
+    int n_min = 0;
+    for (int r = 0; r < count; r++) {
+        int n = config->segment_lengths[r];
+        if (n < 4 || n % 2 != 0 || (size_t)n > config->samples_per_window) {
+            return NULL;
+        }
+        if (n_min == 0 || n < n_min) n_min = n;
+    }
+    for (int r = 0; r < count; r++) {
+        if (config->segment_lengths[r] % n_min != 0) {
+            fprintf(stderr, "[sweep] segment length %d is not a multiple of %d\n",
+                    config->segment_lengths[r], n_min);
+            return NULL;
+        }
+    }
+
+    double fs = config->sample_rate;
+    double usable = config->usable_fraction * fs;
+    double dc = config->dc_exclusion_hz;
+
+    /* Half-widths on the coarse grid */
+    double df_c = fs / n_min;
+    int keep_max_c = (int)floor(usable / 2 / df_c);
+    if (keep_max_c > n_min / 2 - 1) keep_max_c = n_min / 2 - 1;
+    int keep_min_c = (int)ceil(dc / 2 / df_c);
+    if (keep_min_c < 1) keep_min_c = 1;
+
+    /*
+     * Step between LOs. Each window keeps offsets [keep_min, keep_max] on both
+     * sides; a step of keep_max - keep_min makes the neighbours' kept bands
+     * meet, and a step of at least 2 * keep_min puts every DC notch inside
+     * a neighbour's kept band.
+     */
+    int step_c = keep_max_c - keep_min_c;
+    if (step_c < 2 * keep_min_c) {
+        fprintf(stderr, "[sweep] DC exclusion of %.0f Hz too wide for a usable band of %.0f Hz\n",
+                dc, usable);
+        return NULL;
+    }
+
+    int bins_c = (int)floor((config->hi_freq - config->lo_freq) / df_c);
+    int first_c = keep_max_c;
+    int windows = 2;
+    if (bins_c - first_c - keep_max_c > step_c) {
+        windows = 1 + (bins_c - first_c - keep_max_c + step_c - 1) / step_c;
+    }
+
+    Sweep* sweep = (Sweep*)calloc(1, sizeof(Sweep));
+    if (!sweep) {
+        return NULL;
+    }
+    sweep->config = *config;
+    sweep->engine = engine;
+    sweep->window_count = windows;
+
+    sweep->window_offset = (int*)malloc(windows * sizeof(int));
+    sweep->window_center = (uint64_t*)malloc(windows * sizeof(uint64_t));
+    if (!sweep->window_offset || !sweep->window_center) {
+        sweep_destroy(sweep);
+        return NULL;
+    }
+    for (int w = 0; w < windows; w++) {
+        sweep->window_offset[w] = first_c + w * step_c;
+        sweep->window_center[w] = (uint64_t)llround(config->lo_freq + sweep->window_offset[w] * df_c);
+    }
+
+    for (int r = 0; r < count; r++) {
+        SweepResolution* res = &sweep->res[r];
+        int n = config->segment_lengths[r];
+
+        res->segment_length = n;
+        res->ratio = n / n_min;
+        res->df = fs / n;
+        res->bins = bins_c * res->ratio;
+        res->keep_max = (int)floor(usable / 2 / res->df);
+        if (res->keep_max > n / 2 - 1) res->keep_max = n / 2 - 1;
+        res->keep_min = (int)ceil(dc / 2 / res->df);
+        if (res->keep_min < 1) res->keep_min = 1;
+
+        res->sum      = (double*)calloc(res->bins, sizeof(double));
+        res->hits     = (uint16_t*)calloc(res->bins, sizeof(uint16_t));
+        res->f_window = (double*)malloc(n * sizeof(double));
+        res->P_window = (dsp_real_t*)malloc(n * sizeof(dsp_real_t));
+        if (!res->sum || !res->hits || !res->f_window || !res->P_window) {
+            sweep_destroy(sweep);
+            return NULL;
+        }
+        if (welch_engine_prepare(engine, n) != WELCH_SUCCESS) {
+            sweep_destroy(sweep);
+            return NULL;
+        }
+    }
+
+    printf("[sweep] %.3f-%.3f MHz in %d windows, LO step %.3f MHz\n",
+           config->lo_freq / 1e6, (config->lo_freq + bins_c * df_c) / 1e6,
+           windows, step_c * df_c / 1e6);
+
+    return sweep;
+}
+
+int sweep_window_count(const Sweep* sweep) {
+    return sweep->window_count;
+}
+
+uint64_t sweep_window_center(const Sweep* sweep, int index) {
+    return sweep->window_center[index];
+}
+
+int sweep_bin_count(const Sweep* sweep, int resolution) {
+    return sweep->res[resolution].bins;
+}
+
+void sweep_begin(Sweep* sweep) {
+    for (int r = 0; r < sweep->config.resolution_count; r++) {
+        SweepResolution* res = &sweep->res[r];
+        memset(res->sum, 0, res->bins * sizeof(double));
+        memset(res->hits, 0, res->bins * sizeof(uint16_t));
+    }
+}
+
+/* Fold the kept offsets [from, to] of one window into the output grid. */
+static void sweep_stitch(SweepResolution* res, int lo_bin, int from, int to) {
+    int n = res->segment_length;
+
+    if (lo_bin + from < 0) from = -lo_bin;
+    if (lo_bin + to >= res->bins) to = res->bins - 1 - lo_bin;
+
+    for (int o = from; o <= to; o++) {
+        int j = lo_bin + o;
+        res->sum[j] += (double)res->P_window[(o + n) % n];
+        res->hits[j]++;
+    }
+}
+
+int sweep_add_window(Sweep* sweep, int index, const int8_t* raw, size_t num_samples) {
+    if (!sweep || !raw || index < 0 || index >= sweep->window_count) {
+        return SWEEP_ERROR_PARAM;
+    }
+
+    int count = sweep->config.resolution_count;
+    WelchResolution outputs[SWEEP_MAX_RESOLUTIONS];
+    for (int r = 0; r < count; r++) {
+        outputs[r].segment_length = sweep->res[r].segment_length;
+        outputs[r].f_out = sweep->res[r].f_window;
+        outputs[r].P_welch_out = sweep->res[r].P_window;
+    }
+
+    CS8_IQ_Context ctx;
+    if (cs8_iq_init_memory_context(&ctx, raw, num_samples) != CS8_IQ_SUCCESS) {
+        return SWEEP_ERROR_PARAM;
+    }
+    int result = welch_engine_psd_multi(sweep->engine, &ctx, outputs, count);
+    cs8_iq_close_context(&ctx);
+    if (result != WELCH_SUCCESS) {
+        fprintf(stderr, "[sweep] window %d: %s\n", index, welch_engine_error_string(result));
+        return SWEEP_ERROR_WELCH;
+    }
+
+    for (int r = 0; r < count; r++) {
+        SweepResolution* res = &sweep->res[r];
+        int lo_bin = sweep->window_offset[index] * res->ratio;
+
+        sweep_stitch(res, lo_bin, -res->keep_max, -res->keep_min);
+        sweep_stitch(res, lo_bin, res->keep_min, res->keep_max);
+    }
+
+    return SWEEP_SUCCESS;
+}
+
+int sweep_run(Sweep* sweep, sweep_capture_fn capture, void* user) {
+    if (!sweep || !capture) {
+        return SWEEP_ERROR_PARAM;
+    }
+
+    size_t capacity = 2 * sweep->config.samples_per_window;
+    if (!sweep->capture) {
+        sweep->capture = (int8_t*)malloc(capacity);
+        if (!sweep->capture) {
+            return SWEEP_ERROR_MEMORY;
+        }
+        sweep->capture_bytes = capacity;
+    }
+
+    sweep_begin(sweep);
+    for (int w = 0; w < sweep->window_count; w++) {
+        size_t length = 0;
+        if (capture(sweep->window_center[w], sweep->capture, capacity, &length, user) != 0) {
+            fprintf(stderr, "[sweep] capture at %.3f MHz failed\n", sweep->window_center[w] / 1e6);
+            return SWEEP_ERROR_CAPTURE;
+        }
+        int result = sweep_add_window(sweep, w, sweep->capture, length / 2);
+        if (result != SWEEP_SUCCESS) {
+            return result;
+        }
+    }
+
+    return SWEEP_SUCCESS;
+}
+
+int sweep_result(const Sweep* sweep, int resolution, double* f_mhz, dsp_real_t* P_out) {
+    if (!sweep || !P_out || resolution < 0 || resolution >= sweep->config.resolution_count) {
+        return SWEEP_ERROR_PARAM;
+    }
+
+    const SweepResolution* res = &sweep->res[resolution];
+    bool covered = true;
+
+    for (int j = 0; j < res->bins; j++) {
+        if (res->hits[j] > 0) {
+            P_out[j] = (dsp_real_t)(res->sum[j] / res->hits[j]);
+        } else {
+            P_out[j] = 0;
+            covered = false;
+        }
+    }
+    if (f_mhz) {
+        for (int j = 0; j < res->bins; j++) {
+            f_mhz[j] = (sweep->config.lo_freq + j * res->df) / 1e6;
+        }
+    }
+
+    return covered ? SWEEP_SUCCESS : SWEEP_ERROR_COVERAGE;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file sweep.h
+ * @brief Wideband sweep: retune across windows, analyse each one, stitch one spectrum.
+ *
+ * A single 20 MHz capture is only trustworthy away from its band edges
+ * (anti-aliasing roll-off) and away from its centre (LO leakage / DC spike).
+ * The sweep engine plans a set of LO frequencies across [lo_freq, hi_freq]
+ * so that every output bin falls inside the usable part of at least one
+ * window and outside the DC notch of it:
+ *
+ * - each window keeps usable_fraction * fs around its LO, minus
+ *   dc_exclusion_hz around the LO itself;
+ * - consecutive LOs are (usable - dc) / 2 apart, so the DC notch of every
+ *   window lies in the kept region of its neighbour;
+ * - bins covered by several windows are averaged in linear power.
+ *
+ * LOs are placed on the grid of the coarsest resolution, so window bins map
+ * onto output bins by an integer offset at every resolution, with no
+ * interpolation.
+ *
+ * @code
+ * SweepConfig cfg = { .lo_freq = 88e6, .hi_freq = 108e6, .sample_rate = 20e6,
+ *                     .segment_lengths = { 32768, 4096 }, .resolution_count = 2,
+ *                     .usable_fraction = 0.75, .dc_exclusion_hz = 100e3,
+ *                     .samples_per_window = 1 << 22 };
+ * Sweep* sweep = sweep_create(&cfg, engine);
+ * sweep_run(sweep, capture_at, &device);        // retune, capture, analyse, stitch
+ * sweep_result(sweep, 0, f_mhz, psd);           // one stitched spectrum per resolution
+ * @endcode
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp_precision.h"
+#include "welch_engine.h"
+
+/** @brief Maximum number of resolutions stitched by one sweep */
+#define SWEEP_MAX_RESOLUTIONS 4
+
+/** @brief Default fraction of each window kept after band-edge trimming */
+#define SWEEP_DEFAULT_USABLE_FRACTION 0.75
+
+/** @brief Default width cut around each window's LO, in Hz */
+#define SWEEP_DEFAULT_DC_EXCLUSION_HZ 100e3
+
+/**
+ * @brief Error codes returned by the sweep engine
+ */
+typedef enum {
+    SWEEP_SUCCESS        =  0, /**< Success */
+    SWEEP_ERROR_PARAM    = -1, /**< Invalid configuration or argument */
+    SWEEP_ERROR_MEMORY   = -2, /**< Allocation failed */
+    SWEEP_ERROR_CAPTURE  = -3, /**< Capture callback failed */
+    SWEEP_ERROR_WELCH    = -4, /**< PSD of a window failed */
+    SWEEP_ERROR_COVERAGE = -5  /**< Some output bin was not covered by any window */
+} SweepErrorCode;
+
+/**
+ * @brief Sweep configuration, copied at creation time
+ */
+typedef struct {
+    double lo_freq;                                 /**< Lower edge of the stitched spectrum in Hz */
+    double hi_freq;                                 /**< Upper edge in Hz */
+    double sample_rate;                             /**< Capture sample rate in Hz */
+    int    segment_lengths[SWEEP_MAX_RESOLUTIONS];  /**< Welch segment length per resolution */
+    int    resolution_count;                        /**< Number of resolutions (1 .. SWEEP_MAX_RESOLUTIONS) */
+    double usable_fraction;                         /**< Fraction of fs kept per window (0 < x ≤ 1) */
+    double dc_exclusion_hz;                         /**< Width cut around each LO */
+    size_t samples_per_window;                      /**< I/Q pairs captured per window */
+} SweepConfig;
+
+/**
+ * @brief Tune to @p center_freq and capture up to @p capacity bytes into @p dst.
+ *
+ * @return 0 on success (with *length set), negative on failure
+ */
+typedef int (*sweep_capture_fn)(uint64_t center_freq, int8_t* dst, size_t capacity,
+                                size_t* length, void* user);
+
+/** @brief Opaque sweep handle */
+typedef struct Sweep Sweep;
+
+/**
+ * @brief Plan the LO frequencies and allocate the stitching buffers.
+ *
+ * @param config Sweep configuration
+ * @param engine Welch engine used for every window (not owned)
+ * @return New sweep, or NULL on invalid configuration or allocation failure
+ */
+Sweep* sweep_create(const SweepConfig* config, WelchEngine* engine);
+
+/**
+ * @brief Release the sweep (NULL is ignored).
+ *
+ * @param sweep Sweep handle
+ */
+void sweep_destroy(Sweep* sweep);
+
+/**
+ * @brief Number of tuned windows in one sweep.
+ *
+ * @param sweep Sweep handle
+ * @return Window count
+ */
+int sweep_window_count(const Sweep* sweep);
+
+/**
+ * @brief LO frequency of window @p index, in Hz.
+ *
+ * @param sweep Sweep handle
+ * @param index Window index, 0 .. sweep_window_count() - 1
+ * @return Centre frequency
+ */
+uint64_t sweep_window_center(const Sweep* sweep, int index);
+
+/**
+ * @brief Number of output bins of resolution @p resolution.
+ *
+ * @param sweep Sweep handle
+ * @param resolution Resolution index
+ * @return Bin count of the stitched spectrum
+ */
+int sweep_bin_count(const Sweep* sweep, int resolution);
+
+/**
+ * @brief Clear the stitching accumulators before a new sweep.
+ *
+ * @param sweep Sweep handle
+ */
+void sweep_begin(Sweep* sweep);
+
+/**
+ * @brief Analyse one captured window and stitch its trimmed PSDs.
+ *
+ * @param sweep Sweep handle
+ * @param index Window index the capture was tuned for
+ * @param raw Interleaved CS8 bytes
+ * @param num_samples Number of I/Q pairs
+ * @return SWEEP_SUCCESS or a negative SweepErrorCode
+ */
+int sweep_add_window(Sweep* sweep, int index, const int8_t* raw, size_t num_samples);
+
+/**
+ * @brief Capture and analyse every window in order, starting a new sweep.
+ *
+ * Each window is analysed as soon as its capture completes, before the
+ * next retune.
+ *
+ * @param sweep Sweep handle
+ * @param capture Tune-and-capture callback
+ * @param user Passed to @p capture
+ * @return SWEEP_SUCCESS or a negative SweepErrorCode
+ */
+int sweep_run(Sweep* sweep, sweep_capture_fn capture, void* user);
+
+/**
+ * @brief Stitched spectrum of one resolution.
+ *
+ * @param sweep Sweep handle
+ * @param resolution Resolution index
+ * @param f_mhz Ascending absolute frequencies in MHz (sweep_bin_count() values), or NULL
+ * @param P_out Averaged PSD (sweep_bin_count() values)
+ * @return SWEEP_SUCCESS or SWEEP_ERROR_COVERAGE when windows are missing
+ */
+int sweep_result(const Sweep* sweep, int resolution, double* f_mhz, dsp_real_t* P_out);
+
+/**
+ * @brief Human-readable message for a SweepErrorCode.
+ *
+ * @param error_code Code returned by a sweep function
+ * @return Constant description string
+ */
+const char* sweep_error_string(int error_code);
+
+#endif // SWEEP_H
@@ -0,0 +1,157 @@
+/**
+ * @file thread_pool.c
+ * @brief Fork/join worker pool built on pthread mutex/condition variables.
+ *
+ * A generation counter announces new work: workers sleep until it changes,
+ * run the task with their index, and the last one to finish wakes the
+ * caller. The caller always participates as worker 0.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "thread_pool.h"
+#include "trace.h"
+
+typedef struct {
+    ThreadPool* pool;
+    int         index;
+} ThreadPoolWorker;
+
+struct ThreadPool {
+    int                 num_workers;  /**< Including the calling thread */
+    pthread_t*          threads;      /**< num_workers - 1 background threads */
+    ThreadPoolWorker*   workers;
+    pthread_mutex_t     lock;
+    pthread_cond_t      work_ready;
+    pthread_cond_t      work_done;
+    unsigned long       generation;   /**< Incremented for every run */
+    int                 pending;      /**< Background workers still running the task */
+    bool                shutdown;
+    thread_pool_task_fn task;
+    void*               arg;
+};
+
+int thread_pool_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+static void* thread_pool_worker_main(void* param) {
+    ThreadPoolWorker* worker = (ThreadPoolWorker*)param;
+    ThreadPool* pool = worker->pool;
+    unsigned long seen = 0;
+
+    trace_thread_name("pool worker");
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        thread_pool_task_fn task = pool->task;
+        void* arg = pool->arg;
+        pthread_mutex_unlock(&pool->lock);
+
+        task(arg, worker->index, pool->num_workers);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+ThreadPool* thread_pool_create(int num_workers) {
+    if (num_workers <= 0) {
+        num_workers = thread_pool_cpu_count();
+    }
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->num_workers = num_workers;
+
+    if (num_workers > 1) {
+        pool->threads = (pthread_t*)calloc(num_workers - 1, sizeof(pthread_t));
+        pool->workers = (ThreadPoolWorker*)calloc(num_workers - 1, sizeof(ThreadPoolWorker));
+        if (!pool->threads || !pool->workers) {
+            free(pool->threads);
+            free(pool->workers);
+            free(pool);
+            return NULL;
+        }
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    for (int i = 0; i < num_workers - 1; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i + 1;
+        if (pthread_create(&pool->threads[i], NULL, thread_pool_worker_main, &pool->workers[i]) != 0) {
+            /* Keep the threads that did start; shrink the pool accordingly */
+            pool->num_workers = i + 1;
+            break;
+        }
+    }
+
+    return pool;
+}
+
+void thread_pool_run(ThreadPool* pool, thread_pool_task_fn task, void* arg) {
+    if (!pool || pool->num_workers == 1) {
+        task(arg, 0, 1);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->pending = pool->num_workers - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    task(arg, 0, pool->num_workers);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int thread_pool_size(const ThreadPool* pool) {
+    return pool ? pool->num_workers : 1;
+}
+
+void thread_pool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->num_workers - 1; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file thread_pool.h
+ * @brief Minimal fork/join worker pool for data-parallel DSP stages.
+ *
+ * The pool keeps its threads alive between calls, so dispatching a stage
+ * costs a condition-variable wake-up instead of a pthread_create(). Every
+ * call to thread_pool_run() executes the same task on all workers (the
+ * calling thread acts as worker 0) and returns once all of them finished.
+ * Work partitioning is left to the task, which receives its worker index.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/**
+ * @brief Task executed by every worker of a thread_pool_run() call.
+ *
+ * @param arg          User argument passed to thread_pool_run()
+ * @param worker_index Index of the executing worker, 0 .. worker_count-1
+ * @param worker_count Total number of workers taking part
+ */
+typedef void (*thread_pool_task_fn)(void* arg, int worker_index, int worker_count);
+
+/** @brief Opaque pool handle */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief Create a pool with @p num_workers workers in total.
+ *
+ * num_workers - 1 threads are spawned; the caller of thread_pool_run() is
+ * the remaining worker. Values <= 0 select the number of online CPUs.
+ *
+ * @param num_workers Total worker count including the calling thread
+ * @return New pool, or NULL on failure
+ */
+ThreadPool* thread_pool_create(int num_workers);
+
+/**
+ * @brief Run @p task on every worker and wait for all of them.
+ *
+ * Not reentrant: one run at a time per pool.
+ *
+ * @param pool Pool handle
+ * @param task Function executed by each worker
+ * @param arg  Argument forwarded to @p task
+ */
+void thread_pool_run(ThreadPool* pool, thread_pool_task_fn task, void* arg);
+
+/**
+ * @brief Total number of workers, including the calling thread.
+ *
+ * @param pool Pool handle (NULL counts as a single worker)
+ * @return Worker count
+ */
+int thread_pool_size(const ThreadPool* pool);
+
+/**
+ * @brief Stop and join all worker threads and free the pool.
+ *
+ * @param pool Pool handle (NULL is ignored)
+ */
+void thread_pool_destroy(ThreadPool* pool);
+
+/**
+ * @brief Number of online CPUs, at least 1.
+ *
+ * @return CPU count reported by sysconf()
+ */
+int thread_pool_cpu_count(void);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,295 @@
+/**
+ * @file trace.c
+ * @brief Per-thread event buffers and the Chrome trace-event writer.
+ *
+ * Buffers are never freed while the process runs: a thread keeps its buffer
+ * in thread-local storage and may outlive a trace_stop()/trace_start() pair,
+ * and a buffer must outlive its thread so events of exited workers can still
+ * be written. When a thread exits its buffer is released and the next thread
+ * with the same name appends to it, so short-lived threads started once per
+ * capture (the SDR feeder) share one track instead of adding one each.
+ * Restarting reuses the buffers with their counts reset.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+typedef struct {
+    uint64_t    ts_ns;
+    const char* category;
+    const char* name;
+    char        phase;      /**< 'B' or 'E' */
+} TraceEvent;
+
+typedef struct TraceBuffer {
+    struct TraceBuffer* next;       /**< Registry link, written once under registry_lock */
+    int                 tid;        /**< Track number in the trace */
+    const char*         thread_name;
+    bool                in_use;     /**< Owned by a live thread */
+    unsigned            generation; /**< trace_start() this buffer was sized for */
+    TraceEvent*         events;
+    size_t              capacity;
+    atomic_size_t       count;      /**< Published with release after each event */
+    atomic_size_t       dropped;
+} TraceBuffer;
+
+static atomic_bool trace_on = false;
+static atomic_uint trace_generation = 0;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceBuffer* registry = NULL;
+static int next_tid = 1;
+static char* trace_path = NULL;
+static size_t trace_capacity = TRACE_DEFAULT_EVENTS;
+static uint64_t trace_origin_ns = 0;
+
+static _Thread_local TraceBuffer* thread_buffer = NULL;
+static _Thread_local const char* thread_label = NULL;
+
+static pthread_once_t exit_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t exit_key;
+
+static const char* trace_error_messages[] = {
+    "Success",
+    "Invalid argument or tracer state",
+    "Trace file could not be written"
+};
+
+const char* trace_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(trace_error_messages) / sizeof(trace_error_messages[0]))) {
+        return trace_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+static uint64_t trace_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool trace_enabled(void) {
+    return atomic_load_explicit(&trace_on, memory_order_relaxed);
+}
+
+/* Thread exit: hand the buffer over to the next thread of the same name */
+static void trace_release_buffer(void* arg) {
+    TraceBuffer* buffer = (TraceBuffer*)arg;
+    pthread_mutex_lock(&registry_lock);
+    buffer->in_use = false;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static void trace_create_exit_key(void) {
+    pthread_key_create(&exit_key, trace_release_buffer);
+}
+
+/* Released buffer with the calling thread's name, or a new one (registry_lock held) */
+static TraceBuffer* trace_acquire_buffer(void) {
+    if (thread_label != NULL) {
+        for (TraceBuffer* buffer = registry; buffer != NULL; buffer = buffer->next) {
+            if (!buffer->in_use && buffer->thread_name != NULL &&
+                strcmp(buffer->thread_name, thread_label) == 0) {
+                buffer->in_use = true;
+                return buffer;
+            }
+        }
+    }
+
+    TraceBuffer* buffer = (TraceBuffer*)calloc(1, sizeof(TraceBuffer));
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->tid = next_tid++;
+    buffer->thread_name = thread_label;
+    buffer->in_use = true;
+    buffer->next = registry;
+    registry = buffer;
+    return buffer;
+}
+
+/* Buffer of the calling thread for the current generation, registering it on first use */
+static TraceBuffer* trace_thread_buffer(void) {
+    unsigned generation = atomic_load_explicit(&trace_generation, memory_order_acquire);
+    TraceBuffer* buffer = thread_buffer;
+
+    if (buffer != NULL && buffer->generation == generation) {
+        return buffer;
+    }
+
+    pthread_once(&exit_key_once, trace_create_exit_key);
+    pthread_mutex_lock(&registry_lock);
+    if (buffer == NULL) {
+        buffer = trace_acquire_buffer();
+        if (buffer == NULL) {
+            pthread_mutex_unlock(&registry_lock);
+            return NULL;
+        }
+        thread_buffer = buffer;
+        pthread_setspecific(exit_key, buffer);
+    }
+    /* First event since trace_start(): size for this run, start empty */
+    if (buffer->generation != generation) {
+        if (buffer->capacity != trace_capacity) {
+            free(buffer->events);
+            buffer->events = (TraceEvent*)malloc(trace_capacity * sizeof(TraceEvent));
+            buffer->capacity = buffer->events != NULL ? trace_capacity : 0;
+        }
+        atomic_store_explicit(&buffer->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&buffer->dropped, 0, memory_order_relaxed);
+        buffer->generation = generation;
+    }
+    if (thread_label != NULL) {
+        buffer->thread_name = thread_label;
+    }
+    pthread_mutex_unlock(&registry_lock);
+    return buffer;
+}
+
+static void trace_record(char phase, const char* category, const char* name) {
+    if (!atomic_load_explicit(&trace_on, memory_order_relaxed)) {
+        return;
+    }
+    TraceBuffer* buffer = trace_thread_buffer();
+    if (buffer == NULL) {
+        return;
+    }
+
+    /* Only this thread writes count, so a relaxed read is exact */
+    size_t n = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    if (n >= buffer->capacity) {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    TraceEvent* event = &buffer->events[n];
+    event->ts_ns = trace_now_ns();
+    event->category = category;
+    event->name = name;
+    event->phase = phase;
+    atomic_store_explicit(&buffer->count, n + 1, memory_order_release);
+}
+
+void trace_begin(const char* category, const char* name) {
+    trace_record('B', category, name);
+}
+
+void trace_end(const char* category, const char* name) {
+    trace_record('E', category, name);
+}
+
+void trace_thread_name(const char* name) {
+    thread_label = name;
+    if (thread_buffer != NULL) {
+        pthread_mutex_lock(&registry_lock);
+        thread_buffer->thread_name = name;
+        pthread_mutex_unlock(&registry_lock);
+    }
+}
+
+int trace_start(const char* path, size_t events_per_thread) {
+    if (path == NULL) {
+        return TRACE_ERROR_PARAM;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    if (atomic_load(&trace_on)) {
+        pthread_mutex_unlock(&registry_lock);
+        return TRACE_ERROR_PARAM;
+    }
+    char* copy = strdup(path);
+    if (copy == NULL) {
+        pthread_mutex_unlock(&registry_lock);
+        return TRACE_ERROR_PARAM;
+    }
+    free(trace_path);
+    trace_path = copy;
+    trace_capacity = events_per_thread > 0 ? events_per_thread : TRACE_DEFAULT_EVENTS;
+    trace_origin_ns = trace_now_ns();
+    /* Buffers from a previous run are reset lazily by their threads */
+    atomic_fetch_add_explicit(&trace_generation, 1, memory_order_release);
+    atomic_store(&trace_on, true);
+    pthread_mutex_unlock(&registry_lock);
+
+    printf("[trace] Recording to %s (%zu events per thread)\n", path, trace_capacity);
+    return TRACE_SUCCESS;
+}
+
+static void trace_write_string(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* p = text ? text : ""; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*p, file);
+    }
+    fputc('"', file);
+}
+
+int trace_stop(void) {
+    if (!atomic_exchange(&trace_on, false)) {
+        return TRACE_SUCCESS;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    unsigned generation = atomic_load(&trace_generation);
+    FILE* file = fopen(trace_path, "w");
+    if (file == NULL) {
+        pthread_mutex_unlock(&registry_lock);
+        fprintf(stderr, "[trace] Unable to write %s\n", trace_path);
+        return TRACE_ERROR_FILE;
+    }
+
+    int pid = (int)getpid();
+    size_t total = 0, dropped = 0;
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+    for (TraceBuffer* buffer = registry; buffer != NULL; buffer = buffer->next) {
+        if (buffer->generation != generation) {
+            continue;   /* No event from this thread in this run */
+        }
+        size_t count = atomic_load_explicit(&buffer->count, memory_order_acquire);
+        total += count;
+        dropped += atomic_load_explicit(&buffer->dropped, memory_order_relaxed);
+
+        fprintf(file, "%s{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": %d, \"tid\": %d, \"args\": {\"name\": ",
+                first ? "" : ",\n", pid, buffer->tid);
+        if (buffer->thread_name != NULL) {
+            trace_write_string(file, buffer->thread_name);
+        } else {
+            fprintf(file, "\"thread %d\"", buffer->tid);
+        }
+        fprintf(file, "}}");
+        first = false;
+
+        for (size_t i = 0; i < count; i++) {
+            const TraceEvent* event = &buffer->events[i];
+            fprintf(file, ",\n{\"ph\": \"%c\", \"cat\": ", event->phase);
+            trace_write_string(file, event->category);
+            fprintf(file, ", \"name\": ");
+            trace_write_string(file, event->name);
+            fprintf(file, ", \"pid\": %d, \"tid\": %d, \"ts\": %.3f}",
+                    pid, buffer->tid, (event->ts_ns - trace_origin_ns) / 1e3);
+        }
+    }
+
+    fprintf(file, "\n], \"otherData\": {\"events\": %zu, \"dropped_events\": %zu}}\n", total, dropped);
+    int result = fclose(file) == 0 ? TRACE_SUCCESS : TRACE_ERROR_FILE;
+    pthread_mutex_unlock(&registry_lock);
+
+    printf("[trace] Wrote %zu events to %s", total, trace_path);
+    if (dropped > 0) {
+        printf(" (%zu dropped: buffers full)", dropped);
+    }
+    printf("\n");
+    return result;
+}
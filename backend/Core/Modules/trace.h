@@ -0,0 +1,95 @@
+/**
+ * @file trace.h
+ * @brief Optional timeline tracing exported as Chrome trace-event JSON.
+ *
+ * When tracing is started, trace_begin()/trace_end() append timestamped
+ * events to a buffer owned by the calling thread: no locks and no shared
+ * cache lines on the hot path, one relaxed load when tracing is off. Each
+ * thread's buffer is registered once, on its first event. trace_stop()
+ * writes every buffer to a JSON file that chrome://tracing and
+ * ui.perfetto.dev open directly, one track per thread, so overlapped
+ * acquisition, queue waits and Welch worker utilization show up on a
+ * timeline.
+ *
+ * A full buffer drops further events of that thread (counted in the file)
+ * rather than wrapping, so the trace always starts at trace_start().
+ *
+ * @code
+ * trace_start("/tmp/bacn.trace.json", TRACE_DEFAULT_EVENTS);
+ * trace_thread_name("acquisition");
+ * trace_begin("sdr", "capture");
+ * ...
+ * trace_end("sdr", "capture");
+ * trace_stop();
+ * @endcode
+ *
+ * Category, name and thread-name strings are stored by pointer and must
+ * outlive trace_stop() (string literals).
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @brief Default events per thread buffer (24 bytes each) */
+#define TRACE_DEFAULT_EVENTS (1 << 18)
+
+/**
+ * @brief Error codes returned by the tracer
+ */
+typedef enum {
+    TRACE_SUCCESS        =  0, /**< Success */
+    TRACE_ERROR_PARAM    = -1, /**< Invalid argument, or already/not started */
+    TRACE_ERROR_FILE     = -2  /**< Trace file could not be written */
+} TraceErrorCode;
+
+/**
+ * @brief Start recording; events are written to @p path by trace_stop().
+ *
+ * @param path Output file (copied)
+ * @param events_per_thread Capacity of each thread buffer (0 = TRACE_DEFAULT_EVENTS)
+ * @return TRACE_SUCCESS or TRACE_ERROR_PARAM
+ */
+int trace_start(const char* path, size_t events_per_thread);
+
+/**
+ * @brief Stop recording and write the Chrome trace file (no-op when not started).
+ *
+ * Threads may still be running; events they record while the file is being
+ * written are not included.
+ *
+ * @return TRACE_SUCCESS, or TRACE_ERROR_FILE
+ */
+int trace_stop(void);
+
+/**
+ * @brief Whether events are being recorded.
+ */
+bool trace_enabled(void);
+
+/**
+ * @brief Open a span on the calling thread.
+ *
+ * @param category Grouping shown by the viewer, e.g. "sdr", "welch"
+ * @param name Span name; must match the trace_end() call
+ */
+void trace_begin(const char* category, const char* name);
+
+/**
+ * @brief Close the innermost span opened by trace_begin() on this thread.
+ */
+void trace_end(const char* category, const char* name);
+
+/**
+ * @brief Label the calling thread's track (may be called before trace_start()).
+ */
+void trace_thread_name(const char* name);
+
+/**
+ * @brief Human-readable message for a TraceErrorCode.
+ */
+const char* trace_error_string(int error_code);
+
+#endif // TRACE_H
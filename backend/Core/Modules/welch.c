@@ -5,6 +5,10 @@
  * Implements Welch’s method: splits the signal into overlapping segments,
  * applies a Hamming window, performs FFT on each segment, averages the periodograms,
  * and outputs PSD values with associated frequencies.
+ *
+ * The CS8 streaming estimators are thin wrappers over a one-shot WelchEngine
+ * (welch_engine.c) and run at the precision selected in dsp_precision.h;
+ * welch_psd_complex() keeps its double-precision interface.
  */
 
 #include <stdio.h>
@@ -52,8 +56,11 @@ void welch_psd_complex(complex double* signal, size_t N_signal, double fs,
     int K = ((int)N_signal - segment_length) / step + 1;
     size_t psd_size = segment_length;
 
-    /* Allocate and prepare the window */
-    double window[segment_length];
+    /* Allocate and prepare the window (heap: a 32768-point VLA is 256 KB of stack) */
+    double* window = fftw_alloc_real(segment_length);
+    if (!window) {
+        return;
+    }
     generate_hamming_window(window, segment_length);
 
     /* Compute window normalization factor */
@@ -107,4 +114,79 @@ void welch_psd_complex(complex double* signal, size_t N_signal, double fs,
     fftw_destroy_plan(plan);
     fftw_free(segment);
     fftw_free(X_k);
+    fftw_free(window);
+}
+
+
+/* One-shot engine for the stand-alone streaming entry points below. */
+static WelchEngine* welch_create_oneshot_engine(double fs, double overlap) {
+    WelchEngineConfig config = {
+        .fs = fs,
+        .overlap = overlap,
+        .planning = WELCH_PLAN_ESTIMATE,
+        .wisdom_path = NULL
+    };
+    return welch_engine_create(&config);
+}
+
+/**
+ * @brief Compute the PSD of raw CS8 data using Welch's method.
+ *
+ * Convenience wrapper that plans with FFTW_ESTIMATE for a single call. Code
+ * that runs every cycle should keep a WelchEngine instead (see welch_engine.h).
+ *
+ * @param raw_data       Interleaved I/Q bytes (2 * N_signal bytes).
+ * @param N_signal       Number of I/Q samples.
+ * @param fs             Sampling rate in Hz.
+ * @param segment_length Number of samples per segment.
+ * @param overlap        Fractional overlap between segments (0 ≤ overlap < 1).
+ * @param f_out          Output array for frequency bins (length = segment_length).
+ * @param P_welch_out    Output array for PSD values (length = segment_length).
+ * @return WELCH_SUCCESS, or a negative WelchErrorCode.
+ */
+int welch_psd_cs8(const int8_t* raw_data, size_t N_signal, double fs,
+                  int segment_length, double overlap,
+                  double* f_out, dsp_real_t* P_welch_out) {
+    WelchEngine* engine = welch_create_oneshot_engine(fs, overlap);
+    if (!engine) {
+        return WELCH_ERROR_PARAM;
+    }
+
+    int result = welch_engine_psd_cs8(engine, raw_data, N_signal, segment_length, f_out, P_welch_out);
+    if (result == WELCH_SUCCESS) {
+        printf("[welch] PSD computation complete.\n");
+    }
+
+    welch_engine_destroy(engine);
+    return result;
+}
+
+/**
+ * @brief Compute the PSD of an opened CS8 capture using Welch's method.
+ *
+ * Convenience wrapper around welch_engine_psd_context() with a one-shot
+ * FFTW_ESTIMATE engine.
+ *
+ * @param ctx            Initialized CS8 context (rewound before use).
+ * @param fs             Sampling rate in Hz.
+ * @param segment_length Number of samples per segment.
+ * @param overlap        Fractional overlap between segments (0 ≤ overlap < 1).
+ * @param f_out          Output array for frequency bins (length = segment_length).
+ * @param P_welch_out    Output array for PSD values (length = segment_length).
+ * @return WELCH_SUCCESS, or a negative WelchErrorCode.
+ */
+int welch_psd_cs8_context(CS8_IQ_Context* ctx, double fs, int segment_length,
+                          double overlap, double* f_out, dsp_real_t* P_welch_out) {
+    WelchEngine* engine = welch_create_oneshot_engine(fs, overlap);
+    if (!engine) {
+        return WELCH_ERROR_PARAM;
+    }
+
+    int result = welch_engine_psd_context(engine, ctx, segment_length, f_out, P_welch_out);
+    if (result == WELCH_SUCCESS) {
+        printf("[welch] PSD computation complete.\n");
+    }
+
+    welch_engine_destroy(engine);
+    return result;
 }
@@ -10,8 +10,13 @@
 #define WELCH_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <complex.h>
 
+#include "CS8toIQ.h"
+#include "dsp_precision.h"
+#include "welch_engine.h"
+
 #define PI 3.14159265358979323846
 
 /**
@@ -55,4 +60,47 @@ void generate_hamming_window(double* window, int segment_length);
 void welch_psd_complex(complex double* signal, size_t N_signal, double fs,
                        int segment_length, double overlap, double* f_out, double* P_welch_out);
 
+/**
+ * @brief Compute the PSD of a raw CS8 capture using Welch's method.
+ *
+ * Same estimator as welch_psd_complex(), but reads interleaved int8 I/Q pairs
+ * directly (e.g. a memory-mapped capture) and converts each segment into the
+ * FFT input buffer on the fly. Peak memory is bounded by segment_length,
+ * not by the capture length. Runs at the precision selected in dsp_precision.h.
+ *
+ * @param raw_data Pointer to interleaved I/Q bytes (2 * N_signal bytes).
+ * @param N_signal Number of I/Q samples in raw_data.
+ * @param fs Sampling frequency.
+ * @param segment_length Length of each segment.
+ * @param overlap Overlap factor between segments (range: 0 to 1).
+ * @param f_out Output array for frequency bins (must be of size segment_length).
+ * @param P_welch_out Output array for the PSD values (must be of size segment_length).
+ * @return WELCH_SUCCESS on success, negative WelchErrorCode on failure.
+ *
+ * @note Plans with FFTW_ESTIMATE on every call; use a WelchEngine in loops.
+ */
+int welch_psd_cs8(const int8_t* raw_data, size_t N_signal, double fs,
+                  int segment_length, double overlap, double* f_out, dsp_real_t* P_welch_out);
+
+/**
+ * @brief Compute the PSD of a capture opened with cs8_iq_init_context().
+ *
+ * Convenience wrapper around welch_engine_psd_context() with a one-shot
+ * FFTW_ESTIMATE engine, so it accepts memory-mapped and file-backed contexts
+ * alike. The context is rewound first, so several passes can share it.
+ *
+ * @param ctx Initialized CS8 context.
+ * @param fs Sampling frequency.
+ * @param segment_length Length of each segment.
+ * @param overlap Overlap factor between segments (range: 0 to 1).
+ * @param f_out Output array for frequency bins (must be of size segment_length).
+ * @param P_welch_out Output array for the PSD values (must be of size segment_length).
+ * @return WELCH_SUCCESS on success, negative WelchErrorCode on failure.
+ *
+ * @note Plans with FFTW_ESTIMATE on every call; use a WelchEngine (and
+ *       welch_engine_psd_multi() for several resolutions) in loops.
+ */
+int welch_psd_cs8_context(CS8_IQ_Context* ctx, double fs, int segment_length,
+                          double overlap, double* f_out, dsp_real_t* P_welch_out);
+
 #endif // WELCH_H
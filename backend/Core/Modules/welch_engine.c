@@ -0,0 +1,637 @@
+/**
+ * @file welch_engine.c
+ * @brief Persistent Welch PSD engine: plan cache, aligned buffers, windows, wisdom.
+ *
+ * Every resource whose size depends only on the segment length lives in a
+ * cache entry created by welch_engine_prepare(). The per-cycle entry points
+ * only look the entry up and stream samples through it, so no planning,
+ * allocation or window generation happens in the processing loop.
+ *
+ * Parallel passes give each worker a contiguous range of segments, its own
+ * aligned FFT buffers (executed through fftw_execute_dft on the shared plan,
+ * which FFTW allows from several threads) and its own accumulator. Partial
+ * PSDs are summed in worker order afterwards, making the result depend only
+ * on the thread count, never on scheduling.
+ *
+ * Captures opened through a CS8_IQ_Context are streamed block by block:
+ * each block is converted to complex samples once into a shared stream
+ * buffer, every requested resolution consumes the segments that became
+ * complete, and only the tail still needed by an unfinished segment is
+ * carried over to the next block.
+ *
+ * Short segments are windowed M at a time into one contiguous buffer and
+ * transformed by a single fftw_plan_many_dft() call. Power is accumulated
+ * element-wise into an interleaved (re², im²) buffer with vector-extension
+ * code; the pairs are folded and scaled once per pass, in the reduction.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+#include <fftw3.h>
+
+#include "welch.h"
+#include "welch_engine.h"
+#include "thread_pool.h"
+#include "perf_stats.h"
+#include "trace.h"
+
+/**
+ * @brief Per-worker buffers for one segment length
+ */
+typedef struct {
+    dsp_complex_t*  in;             /**< Windowed FFT input, batch segments back to back (aligned) */
+    dsp_complex_t*  out;            /**< FFT output, same layout (aligned) */
+    dsp_real_t*     acc;            /**< Partial interleaved (re², im²) accumulator, 2 * segment_length */
+} WelchWorkspace;
+
+/**
+ * @brief Everything cached for one segment length
+ */
+typedef struct {
+    int             segment_length; /**< FFT size (0 marks an unused slot) */
+    int             step;           /**< Hop between consecutive segments */
+    dsp_real_t      scale;          /**< 1 / (fs * U) periodogram scaling */
+    dsp_real_t*     window;         /**< Hamming window */
+    WelchWorkspace* ws;             /**< One workspace per worker */
+    int             ws_count;
+    int             batch;          /**< Segments per batched transform (1 = unbatched) */
+    DSP_FFTW(plan)  plan;           /**< Planned on ws[0], executed on every workspace */
+    DSP_FFTW(plan)  batch_plan;     /**< plan_many_dft over batch segments, or NULL */
+} WelchPlanEntry;
+
+struct WelchEngine {
+    double          fs;
+    double          overlap;
+    unsigned        plan_flags;
+    char*           wisdom_path;
+    ThreadPool*     pool;           /**< NULL when running serially */
+    int             num_workers;
+    int             plan_count;
+    WelchPlanEntry  plans[WELCH_ENGINE_MAX_PLANS];
+    dsp_complex_t*  stream_iq;      /**< Converted carry + block for streamed passes */
+    int8_t*         stream_raw;     /**< Raw block read from file-backed captures */
+    size_t          stream_block;   /**< Samples converted per block */
+};
+
+/**
+ * @brief Arguments of one parallel segment pass
+ */
+typedef struct {
+    WelchPlanEntry* entry;
+    const int8_t*   raw;            /**< First byte of segment 0 */
+    size_t          K;              /**< Number of segments */
+} WelchSegmentJob;
+
+/**
+ * @brief Arguments of one block of a streamed multi-resolution pass
+ */
+typedef struct {
+    WelchPlanEntry*      entries[WELCH_ENGINE_MAX_PLANS];
+    int                  count;
+    const dsp_complex_t* iq;        /**< Converted samples; iq[0] is sample iq_start */
+    size_t               iq_start;
+    size_t               k_begin[WELCH_ENGINE_MAX_PLANS]; /**< First segment completed by this block */
+    size_t               k_end[WELCH_ENGINE_MAX_PLANS];   /**< One past the last one */
+} WelchBlockJob;
+
+static const char* welch_error_messages[] = {
+    "Success",
+    "Invalid parameter",
+    "Memory allocation failed",
+    "FFT planning failed",
+    "Input shorter than one segment or unreadable",
+    "Wisdom file could not be written"
+};
+
+const char* welch_engine_error_string(int error_code) {
+    int index = -error_code;
+    if (index >= 0 && index < (int)(sizeof(welch_error_messages) / sizeof(welch_error_messages[0]))) {
+        return welch_error_messages[index];
+    }
+    return "Unknown error";
+}
+
+static void welch_plan_entry_free(WelchPlanEntry* entry) {
+    if (entry->plan) DSP_FFTW(destroy_plan)(entry->plan);
+    if (entry->batch_plan) DSP_FFTW(destroy_plan)(entry->batch_plan);
+    DSP_FFTW(free)(entry->window);
+    for (int w = 0; w < entry->ws_count; w++) {
+        DSP_FFTW(free)(entry->ws[w].in);
+        DSP_FFTW(free)(entry->ws[w].out);
+        DSP_FFTW(free)(entry->ws[w].acc);
+    }
+    free(entry->ws);
+    memset(entry, 0, sizeof(*entry));
+}
+
+WelchEngine* welch_engine_create(const WelchEngineConfig* config) {
+    if (!config || config->fs <= 0.0 || config->overlap < 0.0 || config->overlap >= 1.0) {
+        return NULL;
+    }
+
+    WelchEngine* engine = (WelchEngine*)calloc(1, sizeof(WelchEngine));
+    if (!engine) {
+        return NULL;
+    }
+
+    engine->fs = config->fs;
+    engine->overlap = config->overlap;
+    switch (config->planning) {
+        case WELCH_PLAN_PATIENT:  engine->plan_flags = FFTW_PATIENT;  break;
+        case WELCH_PLAN_MEASURE:  engine->plan_flags = FFTW_MEASURE;  break;
+        default:                  engine->plan_flags = FFTW_ESTIMATE; break;
+    }
+
+    engine->num_workers = 1;
+    if (config->num_threads > 1 || config->num_threads == WELCH_THREADS_AUTO) {
+        engine->pool = thread_pool_create(config->num_threads > 1 ? config->num_threads : 0);
+        if (!engine->pool) {
+            free(engine);
+            return NULL;
+        }
+        engine->num_workers = thread_pool_size(engine->pool);
+    }
+
+    if (config->wisdom_path) {
+        engine->wisdom_path = strdup(config->wisdom_path);
+        if (!engine->wisdom_path) {
+            thread_pool_destroy(engine->pool);
+            free(engine);
+            return NULL;
+        }
+        /* A missing file is normal on first start; planning will create it */
+        if (DSP_FFTW(import_wisdom_from_filename)(engine->wisdom_path)) {
+            printf("[welch] Loaded FFTW wisdom from %s\n", engine->wisdom_path);
+        }
+    }
+
+    return engine;
+}
+
+void welch_engine_destroy(WelchEngine* engine) {
+    if (!engine) return;
+
+    for (int i = 0; i < engine->plan_count; i++) {
+        welch_plan_entry_free(&engine->plans[i]);
+    }
+    DSP_FFTW(free)(engine->stream_iq);
+    free(engine->stream_raw);
+    thread_pool_destroy(engine->pool);
+    free(engine->wisdom_path);
+    free(engine);
+}
+
+int welch_engine_thread_count(const WelchEngine* engine) {
+    return engine ? engine->num_workers : 1;
+}
+
+double welch_engine_sample_rate(const WelchEngine* engine) {
+    return engine ? engine->fs : 0.0;
+}
+
+int welch_engine_save_wisdom(WelchEngine* engine) {
+    if (!engine) {
+        return WELCH_ERROR_PARAM;
+    }
+    if (!engine->wisdom_path) {
+        return WELCH_SUCCESS;
+    }
+    if (!DSP_FFTW(export_wisdom_to_filename)(engine->wisdom_path)) {
+        fprintf(stderr, "[welch] Could not write FFTW wisdom to %s\n", engine->wisdom_path);
+        return WELCH_ERROR_WISDOM;
+    }
+    return WELCH_SUCCESS;
+}
+
+static WelchPlanEntry* welch_engine_find(WelchEngine* engine, int segment_length) {
+    for (int i = 0; i < engine->plan_count; i++) {
+        if (engine->plans[i].segment_length == segment_length) {
+            return &engine->plans[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Size the stream buffers for segments up to segment_length. A block holds at
+ * least one segment, and at most segment_length - 1 samples are carried over.
+ */
+static int welch_engine_reserve_stream(WelchEngine* engine, int segment_length) {
+    size_t block = WELCH_ENGINE_BLOCK_SAMPLES;
+    if (block < (size_t)segment_length) block = segment_length;
+    if (engine->stream_iq && block <= engine->stream_block) {
+        return WELCH_SUCCESS;
+    }
+
+    dsp_complex_t* iq = DSP_FFTW(alloc_complex)(2 * block);
+    int8_t* raw = (int8_t*)malloc(2 * block);
+    if (!iq || !raw) {
+        DSP_FFTW(free)(iq);
+        free(raw);
+        return WELCH_ERROR_MEMORY;
+    }
+
+    DSP_FFTW(free)(engine->stream_iq);
+    free(engine->stream_raw);
+    engine->stream_iq = iq;
+    engine->stream_raw = raw;
+    engine->stream_block = block;
+    return WELCH_SUCCESS;
+}
+
+/*
+ * Segments per batched transform. Batching pays off for short segments, where
+ * per-call overhead dominates; the length must keep every batch slot aligned
+ * like the start of the buffer.
+ */
+static int welch_batch_size(int segment_length) {
+    if (segment_length % 8 != 0 || segment_length > WELCH_ENGINE_BATCH_SAMPLES / 2) {
+        return 1;
+    }
+    return WELCH_ENGINE_BATCH_SAMPLES / segment_length;
+}
+
+int welch_engine_prepare(WelchEngine* engine, int segment_length) {
+    if (!engine || segment_length <= 1) {
+        return WELCH_ERROR_PARAM;
+    }
+    if (welch_engine_find(engine, segment_length)) {
+        return WELCH_SUCCESS;
+    }
+    if (engine->plan_count >= WELCH_ENGINE_MAX_PLANS) {
+        return WELCH_ERROR_PLAN;
+    }
+
+    WelchPlanEntry* entry = &engine->plans[engine->plan_count];
+    memset(entry, 0, sizeof(*entry));
+
+    entry->step = (int)(segment_length * (1.0 - engine->overlap));
+    if (entry->step < 1) entry->step = 1;
+
+    if (welch_engine_reserve_stream(engine, segment_length) != WELCH_SUCCESS) {
+        return WELCH_ERROR_MEMORY;
+    }
+
+    entry->window = DSP_FFTW(alloc_real)(segment_length);
+    entry->ws     = (WelchWorkspace*)calloc(engine->num_workers, sizeof(WelchWorkspace));
+    if (!entry->window || !entry->ws) {
+        welch_plan_entry_free(entry);
+        return WELCH_ERROR_MEMORY;
+    }
+    entry->ws_count = engine->num_workers;
+    entry->batch = welch_batch_size(segment_length);
+    for (int w = 0; w < entry->ws_count; w++) {
+        entry->ws[w].in  = DSP_FFTW(alloc_complex)((size_t)entry->batch * segment_length);
+        entry->ws[w].out = DSP_FFTW(alloc_complex)((size_t)entry->batch * segment_length);
+        entry->ws[w].acc = DSP_FFTW(alloc_real)(2 * (size_t)segment_length);
+        if (!entry->ws[w].in || !entry->ws[w].out || !entry->ws[w].acc) {
+            welch_plan_entry_free(entry);
+            return WELCH_ERROR_MEMORY;
+        }
+    }
+
+    /* Window and normalization are computed in double, then stored at DSP precision */
+    double U = 0.0;
+    for (int n = 0; n < segment_length; n++) {
+        double w = 0.54 - 0.46 * cos((2.0 * PI * n) / (segment_length - 1));
+        entry->window[n] = (dsp_real_t)w;
+        U += w * w;
+    }
+    U /= segment_length;
+    entry->scale = (dsp_real_t)(1.0 / (engine->fs * U));
+
+    /* MEASURE/PATIENT overwrite the buffers while timing; nothing is in them yet */
+    entry->plan = DSP_FFTW(plan_dft_1d)(segment_length, entry->ws[0].in, entry->ws[0].out,
+                                        FFTW_FORWARD, engine->plan_flags);
+    if (!entry->plan) {
+        welch_plan_entry_free(entry);
+        return WELCH_ERROR_PLAN;
+    }
+
+    if (entry->batch > 1) {
+        int dims[1] = { segment_length };
+        entry->batch_plan = DSP_FFTW(plan_many_dft)(1, dims, entry->batch,
+                                                    entry->ws[0].in, NULL, 1, segment_length,
+                                                    entry->ws[0].out, NULL, 1, segment_length,
+                                                    FFTW_FORWARD, engine->plan_flags);
+        if (!entry->batch_plan) {
+            entry->batch = 1;  /* Not fatal: fall back to one transform per segment */
+        }
+    }
+
+    entry->segment_length = segment_length;
+    engine->plan_count++;
+
+    if (engine->plan_flags != FFTW_ESTIMATE) {
+        welch_engine_save_wisdom(engine);
+    }
+    return WELCH_SUCCESS;
+}
+
+static int welch_engine_entry(WelchEngine* engine, int segment_length, WelchPlanEntry** entry) {
+    int result = welch_engine_prepare(engine, segment_length);
+    if (result != WELCH_SUCCESS) {
+        return result;
+    }
+    *entry = welch_engine_find(engine, segment_length);
+    return WELCH_SUCCESS;
+}
+
+/*
+ * acc[j] += X[j]² over 2 * n interleaved values. Folding re² + im² is left to
+ * the reduction, so this loop is purely element-wise and maps onto SIMD
+ * registers without shuffles.
+ */
+static void welch_power_accumulate(const dsp_real_t* restrict X, dsp_real_t* restrict acc, size_t n2) {
+    size_t j = 0;
+#if defined(__GNUC__)
+    typedef dsp_real_t welch_vec_t __attribute__((vector_size(32), aligned(sizeof(dsp_real_t))));
+    const size_t lanes = sizeof(welch_vec_t) / sizeof(dsp_real_t);
+    for (; j + lanes <= n2; j += lanes) {
+        welch_vec_t x = *(const welch_vec_t*)(X + j);
+        *(welch_vec_t*)(acc + j) += x * x;
+    }
+#endif
+    for (; j < n2; j++) {
+        acc[j] += X[j] * X[j];
+    }
+}
+
+/* Transform the first count windowed segments in ws->in and add their power to ws->acc. */
+static void welch_entry_transform(const WelchPlanEntry* entry, WelchWorkspace* ws, int count) {
+    size_t n = entry->segment_length;
+
+    if (count == entry->batch && entry->batch_plan) {
+        DSP_FFTW(execute_dft)(entry->batch_plan, ws->in, ws->out);
+    } else {
+        for (int j = 0; j < count; j++) {
+            DSP_FFTW(execute_dft)(entry->plan, ws->in + j * n, ws->out + j * n);
+        }
+    }
+
+    for (int j = 0; j < count; j++) {
+        welch_power_accumulate((const dsp_real_t*)(ws->out + j * n), ws->acc, 2 * n);
+    }
+}
+
+/* Convert one segment of raw I/Q bytes into dst and window it. */
+static void welch_window_raw(const WelchPlanEntry* entry, dsp_complex_t* dst, const int8_t* raw) {
+    int n = entry->segment_length;
+
+    cs8_to_dsp_convert(raw, 2 * (size_t)n, dst, n);
+    for (int i = 0; i < n; i++) {
+        dst[i] *= entry->window[i];
+    }
+}
+
+/* Window one already converted segment into dst. */
+static void welch_window_iq(const WelchPlanEntry* entry, dsp_complex_t* dst, const dsp_complex_t* iq) {
+    int n = entry->segment_length;
+
+    for (int i = 0; i < n; i++) {
+        dst[i] = iq[i] * entry->window[i];
+    }
+}
+
+/*
+ * Process segments first .. last-1 into the worker's accumulator, batch at a
+ * time. Segment k starts at raw + 2 * k * step, or at iq + k * step - iq_start
+ * when iq is given.
+ */
+static void welch_entry_run(const WelchPlanEntry* entry, WelchWorkspace* ws,
+                            const int8_t* raw, const dsp_complex_t* iq, size_t iq_start,
+                            size_t first, size_t last) {
+    size_t n = entry->segment_length;
+
+    for (size_t k = first; k < last; k += entry->batch) {
+        int count = (last - k < (size_t)entry->batch) ? (int)(last - k) : entry->batch;
+        for (int j = 0; j < count; j++) {
+            size_t start = (k + j) * entry->step;
+            if (iq) {
+                welch_window_iq(entry, ws->in + j * n, iq + (start - iq_start));
+            } else {
+                welch_window_raw(entry, ws->in + j * n, raw + 2 * start);
+            }
+        }
+        welch_entry_transform(entry, ws, count);
+    }
+}
+
+/* Fold the per-worker (re², im²) accumulators in worker order into P_welch_out. */
+static void welch_entry_reduce(const WelchPlanEntry* entry, dsp_real_t* P_welch_out) {
+    int n = entry->segment_length;
+
+    for (int i = 0; i < n; i++) {
+        P_welch_out[i] = entry->ws[0].acc[2 * i] + entry->ws[0].acc[2 * i + 1];
+    }
+    for (int w = 1; w < entry->ws_count; w++) {
+        const dsp_real_t* acc = entry->ws[w].acc;
+        for (int i = 0; i < n; i++) {
+            P_welch_out[i] += acc[2 * i] + acc[2 * i + 1];
+        }
+    }
+}
+
+/* Average the accumulated periodograms and fill the frequency axis. */
+static void welch_entry_finalize(const WelchPlanEntry* entry, size_t K, double fs,
+                                 double* f_out, dsp_real_t* P_welch_out) {
+    int n = entry->segment_length;
+    dsp_real_t norm = entry->scale / (dsp_real_t)K;
+    for (int i = 0; i < n; i++) {
+        P_welch_out[i] *= norm;
+    }
+
+    double df = fs / n;
+    for (int i = 0; i < n; i++) {
+        f_out[i] = -fs / 2 + i * df;
+    }
+}
+
+/* Worker body: accumulate a contiguous range of segments into the worker's own buffer. */
+static void welch_segment_task(void* arg, int worker_index, int worker_count) {
+    WelchSegmentJob* job = (WelchSegmentJob*)arg;
+    const WelchPlanEntry* entry = job->entry;
+    WelchWorkspace* ws = &entry->ws[worker_index];
+
+    size_t first = job->K * worker_index / worker_count;
+    size_t last  = job->K * (worker_index + 1) / worker_count;
+
+    memset(ws->acc, 0, 2 * entry->segment_length * sizeof(dsp_real_t));
+    welch_entry_run(entry, ws, job->raw, NULL, 0, first, last);
+}
+
+int welch_engine_psd_cs8(WelchEngine* engine, const int8_t* raw_data, size_t N_signal,
+                         int segment_length, double* f_out, dsp_real_t* P_welch_out) {
+    if (!engine || !raw_data || !f_out || !P_welch_out) {
+        return WELCH_ERROR_PARAM;
+    }
+    if (N_signal < (size_t)segment_length) {
+        return WELCH_ERROR_INPUT;
+    }
+
+    WelchPlanEntry* entry = NULL;
+    int result = welch_engine_entry(engine, segment_length, &entry);
+    if (result != WELCH_SUCCESS) {
+        return result;
+    }
+
+    WelchSegmentJob job = {
+        .entry = entry,
+        .raw = raw_data,
+        .K = (N_signal - segment_length) / entry->step + 1
+    };
+    thread_pool_run(engine->pool, welch_segment_task, &job);
+
+    welch_entry_reduce(entry, P_welch_out);
+    welch_entry_finalize(entry, job.K, engine->fs, f_out, P_welch_out);
+    return WELCH_SUCCESS;
+}
+
+/* Worker body: each resolution's segments completed by the block are split into contiguous ranges. */
+static void welch_block_task(void* arg, int worker_index, int worker_count) {
+    WelchBlockJob* job = (WelchBlockJob*)arg;
+
+    trace_begin("welch", "welch_block");
+    for (int r = 0; r < job->count; r++) {
+        const WelchPlanEntry* entry = job->entries[r];
+        WelchWorkspace* ws = &entry->ws[worker_index];
+        size_t n = job->k_end[r] - job->k_begin[r];
+        size_t first = job->k_begin[r] + n * worker_index / worker_count;
+        size_t last  = job->k_begin[r] + n * (worker_index + 1) / worker_count;
+
+        welch_entry_run(entry, ws, NULL, job->iq, job->iq_start, first, last);
+    }
+    trace_end("welch", "welch_block");
+}
+
+/* Next raw block of a capture: mapped captures are used in place, files are read into the engine buffer. */
+static int welch_stream_next_block(WelchEngine* engine, CS8_IQ_Context* ctx,
+                                   const int8_t** raw, size_t* got) {
+    if (ctx->use_mmap) {
+        size_t remaining = (ctx->file_size - ctx->processed_bytes) / 2;
+        *got = remaining < engine->stream_block ? remaining : engine->stream_block;
+        *raw = (const int8_t*)ctx->mapped_memory + ctx->processed_bytes;
+        ctx->processed_bytes += 2 * *got;
+        return CS8_IQ_SUCCESS;
+    }
+
+    *raw = engine->stream_raw;
+    int result = cs8_iq_read_raw(ctx, engine->stream_raw, engine->stream_block, got);
+    return result < 0 ? result : CS8_IQ_SUCCESS;
+}
+
+int welch_engine_psd_multi(WelchEngine* engine, CS8_IQ_Context* ctx,
+                           WelchResolution* resolutions, int count) {
+    if (!engine || !ctx || !resolutions || count <= 0 || count > WELCH_ENGINE_MAX_PLANS) {
+        return WELCH_ERROR_PARAM;
+    }
+
+    size_t N_signal = ctx->file_size / 2;
+    WelchBlockJob job = { .count = count };
+    size_t K[WELCH_ENGINE_MAX_PLANS];
+
+    for (int r = 0; r < count; r++) {
+        if (!resolutions[r].f_out || !resolutions[r].P_welch_out) {
+            return WELCH_ERROR_PARAM;
+        }
+        for (int q = 0; q < r; q++) {
+            if (resolutions[q].segment_length == resolutions[r].segment_length) {
+                return WELCH_ERROR_PARAM;  /* Would share one accumulator */
+            }
+        }
+        if (N_signal < (size_t)resolutions[r].segment_length) {
+            return WELCH_ERROR_INPUT;
+        }
+        int result = welch_engine_entry(engine, resolutions[r].segment_length, &job.entries[r]);
+        if (result != WELCH_SUCCESS) {
+            return result;
+        }
+        K[r] = (N_signal - resolutions[r].segment_length) / job.entries[r]->step + 1;
+        job.k_end[r] = 0;
+        for (int w = 0; w < job.entries[r]->ws_count; w++) {
+            memset(job.entries[r]->ws[w].acc, 0, 2 * resolutions[r].segment_length * sizeof(dsp_real_t));
+        }
+    }
+
+    if (cs8_iq_rewind_context(ctx) != CS8_IQ_SUCCESS) {
+        return WELCH_ERROR_INPUT;
+    }
+
+    /* Reading + conversion is timed per block; the rest of the pass is the Welch stage */
+    trace_begin("welch", "welch_pass");
+    uint64_t pass_start = perf_now_ns();
+    uint64_t convert_ns = 0;
+    dsp_complex_t* iq = engine->stream_iq;
+    size_t iq_start = 0;  /* Absolute index of iq[0] */
+    size_t iq_len = 0;    /* Converted samples held in iq */
+
+    while (iq_start + iq_len < N_signal) {
+        const int8_t* raw = NULL;
+        size_t got = 0;
+        uint64_t convert_start = perf_now_ns();
+        trace_begin("welch", "convert");
+        if (welch_stream_next_block(engine, ctx, &raw, &got) != CS8_IQ_SUCCESS || got == 0) {
+            trace_end("welch", "convert");
+            trace_end("welch", "welch_pass");
+            return WELCH_ERROR_INPUT;
+        }
+        cs8_to_dsp_convert(raw, 2 * got, iq + iq_len, got);
+        trace_end("welch", "convert");
+        convert_ns += perf_now_ns() - convert_start;
+        iq_len += got;
+
+        /* Segments of every resolution that now lie entirely inside the buffer */
+        size_t iq_end = iq_start + iq_len;
+        bool any = false;
+        for (int r = 0; r < count; r++) {
+            const WelchPlanEntry* entry = job.entries[r];
+            job.k_begin[r] = job.k_end[r];
+            job.k_end[r] = iq_end < (size_t)entry->segment_length ? 0
+                         : (iq_end - entry->segment_length) / entry->step + 1;
+            if (job.k_end[r] > K[r]) job.k_end[r] = K[r];
+            if (job.k_end[r] < job.k_begin[r]) job.k_end[r] = job.k_begin[r];
+            any |= job.k_end[r] > job.k_begin[r];
+        }
+
+        if (any) {
+            job.iq = iq;
+            job.iq_start = iq_start;
+            thread_pool_run(engine->pool, welch_block_task, &job);
+        }
+
+        /* Carry over everything from the earliest segment not yet processed */
+        size_t keep_from = iq_end;
+        for (int r = 0; r < count; r++) {
+            size_t next = job.k_end[r] * job.entries[r]->step;
+            if (job.k_end[r] < K[r] && next < keep_from) keep_from = next;
+        }
+        size_t keep = iq_end - keep_from;
+        memmove(iq, iq + (keep_from - iq_start), keep * sizeof(dsp_complex_t));
+        iq_start = keep_from;
+        iq_len = keep;
+    }
+
+    for (int r = 0; r < count; r++) {
+        welch_entry_reduce(job.entries[r], resolutions[r].P_welch_out);
+        welch_entry_finalize(job.entries[r], K[r], engine->fs,
+                             resolutions[r].f_out, resolutions[r].P_welch_out);
+    }
+    perf_stats_record(PERF_STAGE_CONVERT, convert_ns);
+    perf_stats_record(PERF_STAGE_WELCH, perf_now_ns() - pass_start - convert_ns);
+    trace_end("welch", "welch_pass");
+    return WELCH_SUCCESS;
+}
+
+int welch_engine_psd_context(WelchEngine* engine, CS8_IQ_Context* ctx,
+                             int segment_length, double* f_out, dsp_real_t* P_welch_out) {
+    WelchResolution resolution = {
+        .segment_length = segment_length,
+        .f_out = f_out,
+        .P_welch_out = P_welch_out
+    };
+    return welch_engine_psd_multi(engine, ctx, &resolution, 1);
+}
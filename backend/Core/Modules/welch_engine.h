@@ -0,0 +1,209 @@
+/**
+ * @file welch_engine.h
+ * @brief Persistent Welch PSD engine with cached FFTW plans, buffers and windows.
+ *
+ * welch_psd_complex() plans, allocates and builds its window on every call.
+ * A WelchEngine does that work once per segment length: plans are created
+ * with FFTW_MEASURE or FFTW_PATIENT, aligned buffers and the Hamming window
+ * (with its U normalization) are cached next to them, and FFTW wisdom can be
+ * persisted to disk so later startups skip the measurement entirely.
+ *
+ * With num_threads > 1 the segments of a pass are split into contiguous
+ * ranges across a persistent worker pool. Each worker owns its FFT buffers
+ * and PSD accumulator; the partial sums are reduced in worker order, so the
+ * output is bit-identical from run to run for a given thread count.
+ *
+ * Typical use:
+ * @code
+ * WelchEngineConfig cfg = { .fs = 20e6, .overlap = 0.0,
+ *                           .planning = WELCH_PLAN_MEASURE,
+ *                           .wisdom_path = "fftw_double.wisdom" };
+ * WelchEngine* engine = welch_engine_create(&cfg);
+ * welch_engine_prepare(engine, 32768);   // plan once, at startup
+ * ...
+ * welch_engine_psd_cs8(engine, raw, n_samples, 32768, f, psd);  // every cycle
+ * ...
+ * welch_engine_destroy(engine);
+ * @endcode
+ */
+
+#ifndef WELCH_ENGINE_H
+#define WELCH_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "CS8toIQ.h"
+#include "dsp_precision.h"
+
+/** @brief Maximum number of distinct segment lengths cached by one engine. */
+#define WELCH_ENGINE_MAX_PLANS 8
+
+/** @brief Samples converted per block by streamed passes (raised to the largest prepared segment). */
+#define WELCH_ENGINE_BLOCK_SAMPLES (1 << 17)
+
+/** @brief Samples per batched FFT call; segments up to half this long are transformed in batches. */
+#define WELCH_ENGINE_BATCH_SAMPLES (1 << 15)
+
+/** @brief num_threads value selecting one worker per online CPU. */
+#define WELCH_THREADS_AUTO (-1)
+
+/**
+ * @brief Error codes returned by the Welch engine
+ */
+typedef enum {
+    WELCH_SUCCESS        =  0, /**< Success */
+    WELCH_ERROR_PARAM    = -1, /**< Invalid argument */
+    WELCH_ERROR_MEMORY   = -2, /**< Buffer allocation failed */
+    WELCH_ERROR_PLAN     = -3, /**< FFTW could not create a plan, or the cache is full */
+    WELCH_ERROR_INPUT    = -4, /**< Input shorter than one segment, or read failure */
+    WELCH_ERROR_WISDOM   = -5  /**< Wisdom file could not be written */
+} WelchErrorCode;
+
+/**
+ * @brief FFTW planning effort used when a segment length is first prepared
+ */
+typedef enum {
+    WELCH_PLAN_ESTIMATE = 0, /**< Heuristic plan, no measurement (old behaviour) */
+    WELCH_PLAN_MEASURE  = 1, /**< Time a few algorithms (default) */
+    WELCH_PLAN_PATIENT  = 2  /**< Exhaustive search; use with a wisdom file */
+} WelchPlanning;
+
+/**
+ * @brief Engine configuration, copied at creation time
+ */
+typedef struct {
+    double        fs;          /**< Sampling rate in Hz */
+    double        overlap;     /**< Fractional overlap between segments (0 ≤ overlap < 1) */
+    WelchPlanning planning;    /**< Planning effort for new segment lengths */
+    const char*   wisdom_path; /**< Wisdom file to import/export, or NULL to disable */
+    int           num_threads; /**< Workers for segment processing: 0/1 serial, N > 1, or WELCH_THREADS_AUTO */
+} WelchEngineConfig;
+
+/**
+ * @brief One output of a multi-resolution pass
+ */
+typedef struct {
+    int         segment_length; /**< FFT size */
+    double*     f_out;          /**< Frequency bins, -fs/2 .. fs/2 (length segment_length) */
+    dsp_real_t* P_welch_out;    /**< PSD values (length segment_length) */
+} WelchResolution;
+
+/** @brief Opaque engine handle */
+typedef struct WelchEngine WelchEngine;
+
+/**
+ * @brief Create an engine and import FFTW wisdom if a wisdom file exists.
+ *
+ * @param config Engine configuration
+ * @return New engine, or NULL on invalid configuration or allocation failure
+ */
+WelchEngine* welch_engine_create(const WelchEngineConfig* config);
+
+/**
+ * @brief Release all plans, buffers and windows owned by the engine.
+ *
+ * @param engine Engine to destroy (NULL is ignored)
+ */
+void welch_engine_destroy(WelchEngine* engine);
+
+/**
+ * @brief Plan and allocate everything needed for one segment length.
+ *
+ * Planning happens only the first time a length is seen; later calls are a
+ * cache lookup. When new plans were measured and a wisdom path is set, the
+ * wisdom file is rewritten. Call this at startup so the processing loop
+ * never plans.
+ *
+ * @param engine Engine handle
+ * @param segment_length FFT size
+ * @return WELCH_SUCCESS or a negative WelchErrorCode
+ */
+int welch_engine_prepare(WelchEngine* engine, int segment_length);
+
+/**
+ * @brief Welch PSD of interleaved CS8 samples using the cached plan.
+ *
+ * Segments are converted from the raw bytes directly into the aligned FFT
+ * input buffer. The segment length is prepared on first use if needed.
+ *
+ * @param engine Engine handle
+ * @param raw_data Interleaved I/Q bytes (2 * N_signal bytes)
+ * @param N_signal Number of I/Q samples
+ * @param segment_length FFT size
+ * @param f_out Frequency bins, -fs/2 .. fs/2 (length segment_length)
+ * @param P_welch_out PSD values (length segment_length)
+ * @return WELCH_SUCCESS or a negative WelchErrorCode
+ */
+int welch_engine_psd_cs8(WelchEngine* engine, const int8_t* raw_data, size_t N_signal,
+                         int segment_length, double* f_out, dsp_real_t* P_welch_out);
+
+/**
+ * @brief Welch PSDs at several segment lengths in a single pass over a capture.
+ *
+ * The capture is read once in blocks of WELCH_ENGINE_BLOCK_SAMPLES. Each
+ * block is converted to complex samples once, every resolution processes the
+ * segments that became complete (in parallel across the worker pool), and
+ * only the tail still needed by the longest pending segment is carried over.
+ * Memory-mapped captures are read in place, file-backed ones through a
+ * cached block buffer. The context is rewound first.
+ *
+ * Results are identical to separate welch_engine_psd_context() calls.
+ *
+ * @param engine Engine handle
+ * @param ctx Initialized CS8 context
+ * @param resolutions Outputs to compute; segment lengths must be distinct
+ * @param count Number of resolutions (1 .. WELCH_ENGINE_MAX_PLANS)
+ * @return WELCH_SUCCESS or a negative WelchErrorCode
+ */
+int welch_engine_psd_multi(WelchEngine* engine, CS8_IQ_Context* ctx,
+                           WelchResolution* resolutions, int count);
+
+/**
+ * @brief Welch PSD of an opened CS8 capture using the cached plan.
+ *
+ * Single-resolution form of welch_engine_psd_multi().
+ *
+ * @param engine Engine handle
+ * @param ctx Initialized CS8 context
+ * @param segment_length FFT size
+ * @param f_out Frequency bins, -fs/2 .. fs/2 (length segment_length)
+ * @param P_welch_out PSD values (length segment_length)
+ * @return WELCH_SUCCESS or a negative WelchErrorCode
+ */
+int welch_engine_psd_context(WelchEngine* engine, CS8_IQ_Context* ctx,
+                             int segment_length, double* f_out, dsp_real_t* P_welch_out);
+
+/**
+ * @brief Number of workers used for segment processing.
+ *
+ * @param engine Engine handle
+ * @return Worker count (1 when running serially)
+ */
+int welch_engine_thread_count(const WelchEngine* engine);
+
+/**
+ * @brief Sampling rate the frequency axes are computed for.
+ *
+ * @param engine Engine handle
+ * @return WelchEngineConfig::fs in Hz
+ */
+double welch_engine_sample_rate(const WelchEngine* engine);
+
+/**
+ * @brief Write the accumulated FFTW wisdom to the configured file.
+ *
+ * @param engine Engine handle
+ * @return WELCH_SUCCESS (also when no wisdom path is set) or WELCH_ERROR_WISDOM
+ */
+int welch_engine_save_wisdom(WelchEngine* engine);
+
+/**
+ * @brief Human-readable message for a WelchErrorCode.
+ *
+ * @param error_code Code returned by an engine function
+ * @return Constant description string
+ */
+const char* welch_engine_error_string(int error_code);
+
+#endif // WELCH_ENGINE_H
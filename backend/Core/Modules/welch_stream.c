@@ -0,0 +1,237 @@
+/**
+ * @file welch_stream.c
+ * @brief Incremental Welch PSD accumulator with linear or exponential averaging.
+ *
+ * Pushed bytes are transformed straight from the caller's buffer whenever a
+ * whole segment is available there; only segments straddling two pushes go
+ * through the carry buffer. Periodograms are kept unscaled (|X|²) and the
+ * 1 / (fs * U) factor is applied when a snapshot is taken. Averages are held
+ * in double so long linear runs do not lose precision in the single build.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+#include <fftw3.h>
+
+#include "welch.h"
+#include "welch_stream.h"
+
+struct WelchStream {
+    double          fs;
+    int             segment_length;
+    size_t          segment_bytes;  /**< 2 * segment_length */
+    size_t          step_bytes;     /**< 2 * hop between segments */
+    WelchAveraging  averaging;
+    double          alpha;          /**< Exponential smoothing factor per segment */
+    double          scale;          /**< 1 / (fs * U) */
+
+    /* Push side, owned by the pushing thread */
+    dsp_real_t*     window;
+    dsp_complex_t*  in;
+    dsp_complex_t*  out;
+    double*         power;          /**< |X|² of the last segment */
+    int8_t*         carry;          /**< Partial segment between pushes */
+    size_t          carry_len;
+    DSP_FFTW(plan)  plan;
+
+    /* Shared with readers, guarded by lock */
+    pthread_mutex_t lock;
+    double*         avg;            /**< Running sum (linear) or average (exponential) */
+    uint64_t        segments;
+    bool            drop_carry;     /**< Set by reset, honoured by the next push */
+};
+
+void welch_stream_destroy(WelchStream* stream) {
+    if (!stream) return;
+
+    if (stream->plan) DSP_FFTW(destroy_plan)(stream->plan);
+    DSP_FFTW(free)(stream->window);
+    DSP_FFTW(free)(stream->in);
+    DSP_FFTW(free)(stream->out);
+    free(stream->power);
+    free(stream->carry);
+    free(stream->avg);
+    pthread_mutex_destroy(&stream->lock);
+    free(stream);
+}
+
+WelchStream* welch_stream_init(const WelchStreamConfig* config) {
+    if (!config || config->fs <= 0.0 || config->segment_length <= 1 ||
+        config->overlap < 0.0 || config->overlap >= 1.0 ||
+        (config->averaging == WELCH_AVG_EXPONENTIAL && config->time_constant <= 0.0)) {
+        return NULL;
+    }
+
+    WelchStream* stream = (WelchStream*)calloc(1, sizeof(WelchStream));
+    if (!stream) {
+        return NULL;
+    }
+    pthread_mutex_init(&stream->lock, NULL);
+
+    int n = config->segment_length;
+    int step = (int)(n * (1.0 - config->overlap));
+    if (step < 1) step = 1;
+
+    stream->fs = config->fs;
+    stream->segment_length = n;
+    stream->segment_bytes = 2 * (size_t)n;
+    stream->step_bytes = 2 * (size_t)step;
+    stream->averaging = config->averaging;
+    if (config->averaging == WELCH_AVG_EXPONENTIAL) {
+        /* One segment advances time by step / fs */
+        stream->alpha = 1.0 - exp(-(step / config->fs) / config->time_constant);
+    }
+
+    stream->window = DSP_FFTW(alloc_real)(n);
+    stream->in     = DSP_FFTW(alloc_complex)(n);
+    stream->out    = DSP_FFTW(alloc_complex)(n);
+    stream->power  = (double*)malloc(n * sizeof(double));
+    stream->carry  = (int8_t*)malloc(stream->segment_bytes);
+    stream->avg    = (double*)calloc(n, sizeof(double));
+    if (!stream->window || !stream->in || !stream->out || !stream->power ||
+        !stream->carry || !stream->avg) {
+        welch_stream_destroy(stream);
+        return NULL;
+    }
+
+    double U = 0.0;
+    for (int i = 0; i < n; i++) {
+        double w = 0.54 - 0.46 * cos((2.0 * PI * i) / (n - 1));
+        stream->window[i] = (dsp_real_t)w;
+        U += w * w;
+    }
+    U /= n;
+    stream->scale = 1.0 / (config->fs * U);
+
+    unsigned flags = FFTW_ESTIMATE;
+    if (config->planning == WELCH_PLAN_MEASURE) flags = FFTW_MEASURE;
+    if (config->planning == WELCH_PLAN_PATIENT) flags = FFTW_PATIENT;
+    stream->plan = DSP_FFTW(plan_dft_1d)(n, stream->in, stream->out, FFTW_FORWARD, flags);
+    if (!stream->plan) {
+        welch_stream_destroy(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+/* Transform one complete segment and fold it into the average. */
+static void welch_stream_segment(WelchStream* stream, const int8_t* raw) {
+    int n = stream->segment_length;
+
+    cs8_to_dsp_convert(raw, stream->segment_bytes, stream->in, n);
+    for (int i = 0; i < n; i++) {
+        stream->in[i] *= stream->window[i];
+    }
+    DSP_FFTW(execute)(stream->plan);
+
+    const dsp_real_t* X = (const dsp_real_t*)stream->out;
+    for (int i = 0; i < n; i++) {
+        stream->power[i] = (double)X[2 * i] * X[2 * i] + (double)X[2 * i + 1] * X[2 * i + 1];
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    if (stream->averaging == WELCH_AVG_EXPONENTIAL && stream->segments > 0) {
+        double a = stream->alpha;
+        for (int i = 0; i < n; i++) {
+            stream->avg[i] += a * (stream->power[i] - stream->avg[i]);
+        }
+    } else if (stream->averaging == WELCH_AVG_EXPONENTIAL) {
+        memcpy(stream->avg, stream->power, n * sizeof(double));
+    } else {
+        for (int i = 0; i < n; i++) {
+            stream->avg[i] += stream->power[i];
+        }
+    }
+    stream->segments++;
+    pthread_mutex_unlock(&stream->lock);
+}
+
+int welch_stream_push_samples(WelchStream* stream, const int8_t* raw, size_t n_bytes) {
+    if (!stream || (!raw && n_bytes > 0)) {
+        return WELCH_ERROR_PARAM;
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    if (stream->drop_carry) {
+        stream->carry_len = 0;
+        stream->drop_carry = false;
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    size_t seg = stream->segment_bytes;
+    size_t step = stream->step_bytes;
+
+    while (n_bytes > 0) {
+        if (stream->carry_len == 0 && n_bytes >= seg) {
+            /* Whole segment available in the caller's buffer */
+            welch_stream_segment(stream, raw);
+            raw += step;
+            n_bytes -= step;
+            continue;
+        }
+
+        size_t take = seg - stream->carry_len;
+        if (take > n_bytes) take = n_bytes;
+        memcpy(stream->carry + stream->carry_len, raw, take);
+        stream->carry_len += take;
+        raw += take;
+        n_bytes -= take;
+
+        if (stream->carry_len == seg) {
+            welch_stream_segment(stream, stream->carry);
+            /* Keep the overlapping tail as the start of the next segment */
+            memmove(stream->carry, stream->carry + step, seg - step);
+            stream->carry_len = seg - step;
+        }
+    }
+
+    return WELCH_SUCCESS;
+}
+
+int welch_stream_snapshot(WelchStream* stream, double* f_out, dsp_real_t* P_welch_out,
+                          uint64_t* segments) {
+    if (!stream || !P_welch_out) {
+        return WELCH_ERROR_PARAM;
+    }
+
+    int n = stream->segment_length;
+
+    pthread_mutex_lock(&stream->lock);
+    uint64_t count = stream->segments;
+    double norm = stream->scale;
+    if (stream->averaging == WELCH_AVG_LINEAR && count > 0) {
+        norm /= (double)count;
+    }
+    for (int i = 0; i < n; i++) {
+        P_welch_out[i] = (dsp_real_t)(stream->avg[i] * norm);
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    if (f_out) {
+        double df = stream->fs / n;
+        for (int i = 0; i < n; i++) {
+            f_out[i] = -stream->fs / 2 + i * df;
+        }
+    }
+    if (segments) {
+        *segments = count;
+    }
+
+    return count > 0 ? WELCH_SUCCESS : WELCH_ERROR_INPUT;
+}
+
+void welch_stream_reset(WelchStream* stream) {
+    if (!stream) return;
+
+    pthread_mutex_lock(&stream->lock);
+    memset(stream->avg, 0, stream->segment_length * sizeof(double));
+    stream->segments = 0;
+    stream->drop_carry = true;
+    pthread_mutex_unlock(&stream->lock);
+}
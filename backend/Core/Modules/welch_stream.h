@@ -0,0 +1,111 @@
+/**
+ * @file welch_stream.h
+ * @brief Incremental Welch PSD accumulator fed with CS8 bytes as they arrive.
+ *
+ * A WelchStream consumes interleaved CS8 buffers of any length (typically the
+ * hackrf_transfer buffers delivered to rx_callback), keeps the incomplete
+ * segment between pushes and folds every finished periodogram into a running
+ * average. The average is either linear (all segments since the last reset
+ * weigh the same) or exponential with a time constant in seconds, in which
+ * case older segments fade out with exp(-t / tau).
+ *
+ * One thread pushes while any number of threads take snapshots: the FFT runs
+ * outside the lock and only the accumulator update and the snapshot copy are
+ * serialized, so readers never stall the receive path for more than one
+ * vector add.
+ *
+ * @code
+ * WelchStreamConfig cfg = { .fs = 20e6, .segment_length = 4096,
+ *                           .averaging = WELCH_AVG_EXPONENTIAL,
+ *                           .time_constant = 0.5 };
+ * WelchStream* stream = welch_stream_init(&cfg);
+ * ...
+ * welch_stream_push_samples(stream, transfer->buffer, transfer->valid_length);  // rx thread
+ * ...
+ * welch_stream_snapshot(stream, f, psd, &segments);  // any thread, any time
+ * @endcode
+ */
+
+#ifndef WELCH_STREAM_H
+#define WELCH_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp_precision.h"
+#include "welch_engine.h"
+
+/**
+ * @brief How finished periodograms are combined
+ */
+typedef enum {
+    WELCH_AVG_LINEAR      = 0, /**< Arithmetic mean of all segments since the last reset */
+    WELCH_AVG_EXPONENTIAL = 1  /**< Exponential moving average with time_constant */
+} WelchAveraging;
+
+/**
+ * @brief Stream configuration, copied at initialization
+ */
+typedef struct {
+    double         fs;             /**< Sampling rate in Hz */
+    int            segment_length; /**< FFT size */
+    double         overlap;        /**< Fractional overlap between segments (0 ≤ overlap < 1) */
+    WelchAveraging averaging;      /**< Averaging mode */
+    double         time_constant;  /**< Exponential averaging time constant in seconds */
+    WelchPlanning  planning;       /**< FFTW planning effort for the segment plan */
+} WelchStreamConfig;
+
+/** @brief Opaque stream handle */
+typedef struct WelchStream WelchStream;
+
+/**
+ * @brief Create a stream: plan the FFT, build the window, allocate buffers.
+ *
+ * @param config Stream configuration
+ * @return New stream, or NULL on invalid configuration or allocation failure
+ */
+WelchStream* welch_stream_init(const WelchStreamConfig* config);
+
+/**
+ * @brief Release the stream (NULL is ignored).
+ *
+ * @param stream Stream handle
+ */
+void welch_stream_destroy(WelchStream* stream);
+
+/**
+ * @brief Feed interleaved CS8 bytes.
+ *
+ * Every segment completed by the new data is transformed and averaged; the
+ * remainder is kept for the next call. Only one thread may push at a time.
+ *
+ * @param stream Stream handle
+ * @param raw Interleaved I/Q bytes
+ * @param n_bytes Number of bytes (an odd trailing byte is kept for the next push)
+ * @return WELCH_SUCCESS or WELCH_ERROR_PARAM
+ */
+int welch_stream_push_samples(WelchStream* stream, const int8_t* raw, size_t n_bytes);
+
+/**
+ * @brief Copy the current average PSD.
+ *
+ * @param stream Stream handle
+ * @param f_out Frequency bins, -fs/2 .. fs/2 (length segment_length), or NULL
+ * @param P_welch_out PSD values (length segment_length)
+ * @param segments Number of segments in the average since the last reset, or NULL
+ * @return WELCH_SUCCESS, WELCH_ERROR_PARAM, or WELCH_ERROR_INPUT when no segment completed yet
+ */
+int welch_stream_snapshot(WelchStream* stream, double* f_out, dsp_real_t* P_welch_out,
+                          uint64_t* segments);
+
+/**
+ * @brief Discard the average and any partial segment.
+ *
+ * Safe to call from a reader thread while another thread pushes; the partial
+ * segment is dropped at the start of the next push.
+ *
+ * @param stream Stream handle
+ */
+void welch_stream_reset(WelchStream* stream);
+
+#endif // WELCH_STREAM_H
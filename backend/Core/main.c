@@ -10,8 +10,14 @@
  * - Real-time signal acquisition using HackRF
  * - Welch's method for power spectral density estimation
  * - Signal detection with configurable threshold
- * - JSON output for web interface visualization
+ * - JSON or binary frame output for web interface visualization (CORE_SPECTRUM_FORMAT),
+ *   optionally through a shared-memory ring of frames (CORE_SPECTRUM_RING_SLOTS,
+ *   at CORE_SPECTRUM_RING_PATH)
  * - Support for both real-time and test modes
+ * - Streaming real-time mode (STREAM_MODE): the radio runs continuously into
+ *   incremental Welch accumulators and snapshots are published periodically
+ * - Real-time mode without a radio: --backend replay --file <cs8> [--rate N]
+ *   or --backend synthetic (rate 1 = real time, N = N times faster, 0 = unpaced)
  */
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,9 +26,17 @@
 #include <string.h>
 
 #include "Drivers/bacn_RF.h"
+#ifdef HAVE_HACKRF
+#include "Drivers/bacn_sweep.h"
+#endif
 #include "Modules/IQ.h"
 #include "Modules/parameter.h"
+#include "Modules/perf_stats.h"
+#include "Modules/pipeline.h"
 #include "Modules/script_utils.h"
+#include "Modules/sweep.h"
+#include "Modules/trace.h"
+#include "Modules/welch_stream.h"
 
 /* Define frequency ranges for VHF band scanning */
 #define LOWER_FREQ      88000000    /* Lower bound: 88MHz */
@@ -33,6 +47,20 @@
 #define NPERSEG_LARGE   32768       /* High resolution for large-scale analysis */
 #define NPERSEG_SMALL   4096        /* Low resolution for small-scale analysis */
 #define THRESHOLD       -30         /* Signal detection threshold in dB */
+#define SAMPLE_RATE     20000000    /* Acquisition sample rate in Hz */
+#define DSP_THREADS     WELCH_THREADS_AUTO  /* Welch workers: one per CPU */
+#define ZERO_DISK       1           /* Keep live captures in RAM instead of Samples/0 */
+#define PIPELINE_BUFFERS 2          /* Capture N+1 while analysing N (0 = sequential loop) */
+#define PIPELINE_BACKPRESSURE PIPELINE_BLOCK  /* PIPELINE_DROP_OLDEST only drops with >= 3 buffers */
+#define STREAM_MODE     0           /* Continuous capture into incremental Welch accumulators (single tune) */
+#define STREAM_PUBLISH_MS 500       /* Stream mode: milliseconds between published snapshots */
+#define STREAM_TIME_CONSTANT_S 1.0  /* Stream mode: exponential averaging time constant */
+#define SWEEP_MODE      1           /* Retune across LOWER..UPPER and stitch, dropping edges and DC */
+#define SWEEP_WINDOW_SAMPLES (1 << 22)  /* I/Q pairs captured per tuned window */
+#define HW_SWEEP        0           /* Firmware sweep instead of retune-and-capture (GHz-wide spans) */
+#define HW_SWEEP_FFT_LARGE 4096     /* Detection FFT per sweep block (<= SWEEP_MAX_FFT_SIZE) */
+#define HW_SWEEP_FFT_SMALL 1024     /* Display FFT per sweep block */
+#define PERF_STATS_PERIOD_S 10      /* Seconds between stage latency dumps (perf_stats.json) */
 
 /* Testing configuration */
 #define TESTING_SAMPLES 10          /* Number of samples in TestingSamples directory */
@@ -41,17 +69,204 @@
 volatile sig_atomic_t running = 1;   /* Controls main processing loop */
 bool testmode = false;               /* Enables test mode using pre-recorded samples */
 
-int main(void) {
+/* Parse --backend hackrf|replay|synthetic, --file <path>, --rate <x>, --seed <n> */
+static int parse_backend_args(int argc, char** argv, sdr_backend_options_t* options,
+                              const char** trace_path) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (value == NULL) {
+            fprintf(stderr, "[main] Missing value for %s\n", arg);
+            return -1;
+        }
+        if (strcmp(arg, "--backend") == 0) {
+            if (sdr_backend_parse_kind(value, &options->kind) != 0) {
+                fprintf(stderr, "[main] Unknown backend: %s\n", value);
+                return -1;
+            }
+        } else if (strcmp(arg, "--file") == 0) {
+            options->replay_path = value;
+        } else if (strcmp(arg, "--rate") == 0) {
+            options->rate = atof(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            options->seed = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--trace") == 0) {
+            *trace_path = value;
+        } else {
+            fprintf(stderr, "[main] Unknown option: %s\n", arg);
+            return -1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+/* State shared by the sweep pipeline stages */
+typedef struct {
+    Sweep*                 sweep;
+    SignalProcessor*       processor;
+    size_t                 window_bytes;
+    double*                f_large;
+    dsp_real_t*            psd_large;
+    double*                f_small;
+    dsp_real_t*            psd_small;
+} SweepPipeline;
+
+/* Sweep acquisition stage: one full window per LO, back to back in the pool buffer */
+static int acquire_sweep(PipelineBuffer* buffer, void* user) {
+    SweepPipeline* sp = (SweepPipeline*)user;
+    int windows = sweep_window_count(sp->sweep);
+
+    for (int w = 0; w < windows; w++) {
+        size_t length = 0;
+        int result = getSamplesAt(sweep_window_center(sp->sweep, w),
+                                  buffer->data + w * sp->window_bytes, sp->window_bytes, &length);
+        if (result != 0 || length < sp->window_bytes) {
+            return -1;
+        }
+    }
+    buffer->length = windows * sp->window_bytes;
+    return 0;
+}
+
+/* Sweep processing stage: analyse every window, stitch, then detect and publish */
+static int process_sweep(const PipelineBuffer* buffer, void* user) {
+    SweepPipeline* sp = (SweepPipeline*)user;
+    int windows = sweep_window_count(sp->sweep);
+
+    printf("[main] Sweep %llu: %d windows in memory\n",
+           (unsigned long long)buffer->sequence, windows);
+    sweep_begin(sp->sweep);
+    for (int w = 0; w < windows; w++) {
+        int result = sweep_add_window(sp->sweep, w, buffer->data + w * sp->window_bytes,
+                                      sp->window_bytes / 2);
+        if (result != SWEEP_SUCCESS) {
+            fprintf(stderr, "[main] ERROR: %s\n", sweep_error_string(result));
+            return -1;
+        }
+    }
+
+    int result = sweep_result(sp->sweep, 0, sp->f_large, sp->psd_large);
+    if (result == SWEEP_SUCCESS) {
+        result = sweep_result(sp->sweep, 1, sp->f_small, sp->psd_small);
+    }
+    if (result != SWEEP_SUCCESS) {
+        fprintf(stderr, "[main] ERROR: %s\n", sweep_error_string(result));
+        return -1;
+    }
+
+    result = signal_processor_process_psd(sp->processor,
+                                          sp->f_large, sp->psd_large, sweep_bin_count(sp->sweep, 0),
+                                          sp->f_small, sp->psd_small, sweep_bin_count(sp->sweep, 1));
+    if (result != SP_SUCCESS) {
+        fprintf(stderr, "[main] ERROR: %s\n", get_signal_processor_error(result));
+        return -1;
+    }
+    return 0;
+}
+
+/* Pipeline acquisition stage: capture straight into the pool buffer */
+static int acquire_capture(PipelineBuffer* buffer, void* user) {
+    (void)user;
+    int result = getSamplesInto(LOWER_FREQ, UPPER_FREQ, buffer->data, buffer->capacity, &buffer->length);
+    return (result == 0 && buffer->length > 0) ? 0 : -1;
+}
+
+/* Pipeline processing stage: analyse one capture while the next one is acquired */
+static int process_capture(const PipelineBuffer* buffer, void* user) {
+    SignalProcessor* processor = (SignalProcessor*)user;
+    size_t samples = buffer->length / 2;
+
+    printf("[main] Capture %llu: %zu samples in memory\n",
+           (unsigned long long)buffer->sequence, samples);
+    int result = signal_processor_process_cs8(processor, buffer->data, samples);
+    if (result != SP_SUCCESS) {
+        fprintf(stderr, "[main] ERROR: %s\n", get_signal_processor_error(result));
+        return -1;
+    }
+    return 0;
+}
+
+/* Stream mode sink: every received buffer feeds both resolutions (rx thread) */
+static void push_stream_samples(const int8_t* buffer, size_t length, void* user) {
+    WelchStream** streams = (WelchStream**)user;
+    welch_stream_push_samples(streams[0], buffer, length);
+    welch_stream_push_samples(streams[1], buffer, length);
+}
+
+int main(int argc, char** argv) {
+    /* Select the sample source before anything is opened */
+    sdr_backend_options_t backend_options = {
+#ifdef HAVE_HACKRF
+        .kind = SDR_BACKEND_HACKRF,
+#else
+        .kind = SDR_BACKEND_SYNTHETIC,
+#endif
+        .rate = 1.0,
+        .loop = true
+    };
+    const char* trace_path = NULL;
+    if (parse_backend_args(argc, argv, &backend_options, &trace_path) != 0) {
+        fprintf(stderr, "Usage: %s [--backend hackrf|replay|synthetic] [--file cs8] [--rate x] [--seed n]"
+                " [--trace file.json]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Timeline of every thread for chrome://tracing / ui.perfetto.dev, written on exit */
+    trace_thread_name("main");
+    if (trace_path != NULL) {
+        int trace_result = trace_start(trace_path, 0);
+        if (trace_result != TRACE_SUCCESS) {
+            fprintf(stderr, "[main] Tracing disabled: %s\n", trace_error_string(trace_result));
+        }
+    }
+
     /* Initialize environment paths */
     env_path_t paths;
     get_paths(&paths);
 
+    /* The synthetic scene places its stations on the same channel plan */
+    char scene_bands[PATH_MAX + 16];
+    snprintf(scene_bands, sizeof(scene_bands), "%s/VHF1.csv", paths.core_bands_path);
+    backend_options.scene_bands_path = scene_bands;
+    select_sdr_backend(&backend_options);
+
     /* Log path configuration */
     printf("PATH: %s\n\r", paths.root_path);
     printf("PATH: %s\n\r", paths.core_samples_path);
     printf("PATH: %s\n\r", paths.core_json_path);
+    char frame_path[PATH_MAX + 16];
+    snprintf(frame_path, sizeof(frame_path), "%s/spectrum.bin", paths.core_json_path);
+    /* Ring file from CORE_SPECTRUM_RING_PATH (tmpfs by default), as the web server reads it */
+    char ring_path[PATH_MAX + 16];
+    if (paths.core_spectrum_ring_path[0] != '\0') {
+        snprintf(ring_path, sizeof(ring_path), "%s", paths.core_spectrum_ring_path);
+    } else {
+        snprintf(ring_path, sizeof(ring_path), "%s/spectrum.ring", paths.core_json_path);
+    }
     strcat(paths.core_json_path, "/0");
 
+    /* JSON document (default) or binary frame, as the web server expects */
+    SPOutputFormat output_format;
+    if (signal_processor_parse_output_format(paths.core_spectrum_format, &output_format) != SP_SUCCESS) {
+        fprintf(stderr, "[main] Unknown CORE_SPECTRUM_FORMAT '%s', using json\n", paths.core_spectrum_format);
+        output_format = SP_OUTPUT_JSON;
+    }
+
+    /* Frame formats can go through the shared-memory ring instead of spectrum.bin */
+    int ring_slots = paths.core_spectrum_ring_slots;
+    if (ring_slots != 0 && (output_format == SP_OUTPUT_JSON || ring_slots < 2)) {
+        fprintf(stderr, "[main] CORE_SPECTRUM_RING_SLOTS=%d ignored (needs f32 or i16 and at least 2 slots)\n",
+                ring_slots);
+        ring_slots = 0;
+    }
+    if (ring_slots > 0) {
+        printf("[main] Spectrum output: %s (ring of %d frames)\n", ring_path, ring_slots);
+    } else {
+        printf("[main] Spectrum output: %s\n", output_format == SP_OUTPUT_JSON ? paths.core_json_path : frame_path);
+    }
+
     /* Initialize web interface */
     if (start_web(&paths) != 0) {
         fprintf(stderr, "[main] Error initializing Web Service\n");
@@ -68,6 +283,10 @@ int main(void) {
     SignalProcessorConfig config;
     memset(&config, 0, sizeof(config));
     config.output_json_path = paths.core_json_path;
+    config.output_format = output_format;
+    config.output_frame_path = frame_path;
+    config.output_ring_path = ring_slots > 0 ? ring_path : NULL;
+    config.output_ring_slots = ring_slots;
     config.central_freq = CENTRAL_FREQ;
     config.nperseg_large = NPERSEG_LARGE;
     config.nperseg_small = NPERSEG_SMALL;
@@ -77,6 +296,42 @@ int main(void) {
     config.canalization = canalization;
     config.bandwidth = bandwidth;
     config.canalization_length = canalization_length;
+    config.num_threads = DSP_THREADS;
+
+    /* Plan both resolutions once; wisdom makes later startups instant */
+    char wisdom_path[PATH_MAX + 64];
+    snprintf(wisdom_path, sizeof(wisdom_path), "%s/backend/Core/fftw_%s.wisdom",
+             paths.root_path, DSP_PRECISION_NAME);
+    WelchEngineConfig engine_config = {
+        .fs = SAMPLE_RATE,
+        .overlap = 0,
+        .planning = WELCH_PLAN_MEASURE,
+        .wisdom_path = wisdom_path,
+        .num_threads = config.num_threads
+    };
+    WelchEngine* welch_engine = welch_engine_create(&engine_config);
+    if (welch_engine == NULL ||
+        welch_engine_prepare(welch_engine, NPERSEG_LARGE) != WELCH_SUCCESS ||
+        welch_engine_prepare(welch_engine, NPERSEG_SMALL) != WELCH_SUCCESS) {
+        fprintf(stderr, "[main] Error initializing Welch engine\n");
+        exit(EXIT_FAILURE);
+    }
+    config.welch_engine = welch_engine;
+
+    /* Buffers for both resolutions and the median work area, reused every cycle */
+    SignalProcessor* processor = signal_processor_create(&config);
+    if (processor == NULL) {
+        fprintf(stderr, "[main] Error initializing signal processor\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Stage latency histograms (p50/p99/max), dumped next to the wisdom file */
+    char stats_path[PATH_MAX + 64];
+    snprintf(stats_path, sizeof(stats_path), "%s/backend/Core/perf_stats.json", paths.root_path);
+    int stats_result = perf_stats_start(stats_path, PERF_STATS_PERIOD_S);
+    if (stats_result != PERF_STATS_SUCCESS) {
+        fprintf(stderr, "[main] Stage statistics disabled: %s\n", perf_stats_error_string(stats_result));
+    }
 
     char input_file_path[256];
 
@@ -87,10 +342,9 @@ int main(void) {
                 /* Process each test file */
                 snprintf(input_file_path, sizeof(input_file_path), 
                         "%sTestingSamples/%d", paths.core_samples_path, file_num);
-                config.input_file_path = input_file_path;
                 
                 printf("[main] File: %s\n", input_file_path);
-                int result = process_signal_spectrum(&config);
+                int result = signal_processor_process_file(processor, input_file_path);
                 
                 if (result != SP_SUCCESS) {
                     fprintf(stderr, "[main] Error: %d: %s\n", 
@@ -101,22 +355,288 @@ int main(void) {
                 printf("[main] SUCCESS: %d processed\n", file_num);
             }
         }
+#ifdef HAVE_HACKRF
+    } else if (HW_SWEEP && backend_options.kind == SDR_BACKEND_HACKRF) {
+        /* Real-time mode, firmware sweep: the HackRF hops and tags blocks, the driver stitches */
+        rf_sweep_config_t hw_config = {
+            .lo_mhz = LOWER_FREQ / 1000000,
+            .hi_mhz = UPPER_FREQ / 1000000,
+            .fft_sizes = { HW_SWEEP_FFT_LARGE, HW_SWEEP_FFT_SMALL },
+            .resolution_count = 2,
+            .blocks_per_hop = 1
+        };
+        rf_sweep_t* hw_sweep = rf_sweep_open(&hw_config);
+        if (hw_sweep == NULL) {
+            fprintf(stderr, "[main] Error initializing firmware sweep\n");
+            exit(EXIT_FAILURE);
+        }
+        int n_large = rf_sweep_bin_count(hw_sweep, 0);
+        int n_small = rf_sweep_bin_count(hw_sweep, 1);
+        double* f_large = (double*)malloc(n_large * sizeof(double));
+        dsp_real_t* psd_large = (dsp_real_t*)malloc(n_large * sizeof(dsp_real_t));
+        double* f_small = (double*)malloc(n_small * sizeof(double));
+        dsp_real_t* psd_small = (dsp_real_t*)malloc(n_small * sizeof(dsp_real_t));
+        if (!f_large || !psd_large || !f_small || !psd_small || rf_sweep_start(hw_sweep) != 0) {
+            fprintf(stderr, "[main] Error starting firmware sweep\n");
+            exit(EXIT_FAILURE);
+        }
+
+        uint64_t sequence = 0;
+        while (running) {
+            uint64_t wait_start = perf_now_ns();
+            if (rf_sweep_wait(hw_sweep, sequence, &sequence) != 0) {
+                if (!running) break;
+                fprintf(stderr, "[main] ERROR: no sweep completed in one second\n");
+                exit(EXIT_FAILURE);
+            }
+            perf_stats_record(PERF_STAGE_ACQUIRE, perf_now_ns() - wait_start);
+            rf_sweep_result(hw_sweep, 0, f_large, psd_large);
+            rf_sweep_result(hw_sweep, 1, f_small, psd_small);
+
+            printf("[main] Sweep %llu\n", (unsigned long long)sequence);
+            int result = signal_processor_process_psd(processor, f_large, psd_large, n_large,
+                                                      f_small, psd_small, n_small);
+            if (result != SP_SUCCESS) {
+                fprintf(stderr, "[main] ERROR: %s\n", get_signal_processor_error(result));
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        rf_sweep_stats_t stats;
+        rf_sweep_get_stats(hw_sweep, &stats);
+        printf("[main] Firmware sweep: %llu sweeps, %llu blocks, %llu without header\n",
+               (unsigned long long)stats.sweeps, (unsigned long long)stats.blocks,
+               (unsigned long long)stats.bad_blocks);
+        rf_sweep_close(hw_sweep);
+        free(f_large);
+        free(psd_large);
+        free(f_small);
+        free(psd_small);
+#endif
+    } else if (STREAM_MODE) {
+        /* Real-time mode, streaming: the radio never stops, snapshots are published periodically */
+        WelchStreamConfig stream_config = {
+            .fs = SAMPLE_RATE,
+            .overlap = 0,
+            .averaging = WELCH_AVG_EXPONENTIAL,
+            .time_constant = STREAM_TIME_CONSTANT_S,
+            .planning = WELCH_PLAN_MEASURE
+        };
+        stream_config.segment_length = NPERSEG_LARGE;
+        WelchStream* large = welch_stream_init(&stream_config);
+        stream_config.segment_length = NPERSEG_SMALL;
+        WelchStream* small = welch_stream_init(&stream_config);
+        WelchStream* streams[2] = { large, small };
+
+        double* f_large = (double*)malloc(NPERSEG_LARGE * sizeof(double));
+        dsp_real_t* psd_large = (dsp_real_t*)malloc(NPERSEG_LARGE * sizeof(dsp_real_t));
+        double* f_small = (double*)malloc(NPERSEG_SMALL * sizeof(double));
+        dsp_real_t* psd_small = (dsp_real_t*)malloc(NPERSEG_SMALL * sizeof(dsp_real_t));
+        if (!large || !small || !f_large || !psd_large || !f_small || !psd_small) {
+            fprintf(stderr, "[main] Error initializing Welch streams\n");
+            exit(EXIT_FAILURE);
+        }
+
+        set_sample_sink(push_stream_samples, streams);
+        if (startSampleStream(CENTRAL_FREQ) != 0) {
+            fprintf(stderr, "[main] Error starting the sample stream\n");
+            exit(EXIT_FAILURE);
+        }
+
+        uint32_t last_bytes = 0;
+        int idle_ms = 0;
+        while (running) {
+            usleep(STREAM_PUBLISH_MS * 1000);
+            if (!running) break;
+
+            /* Same liveness rule as a capture: fail after one second without samples */
+            uint32_t bytes = getStreamedBytes();
+            idle_ms = (bytes == last_bytes) ? idle_ms + STREAM_PUBLISH_MS : 0;
+            last_bytes = bytes;
+            if (idle_ms >= 1000) {
+                fprintf(stderr, "[main] ERROR: no samples streamed for one second\n");
+                exit(EXIT_FAILURE);
+            }
+
+            uint64_t segments = 0;
+            if (welch_stream_snapshot(large, f_large, psd_large, &segments) != WELCH_SUCCESS ||
+                welch_stream_snapshot(small, f_small, psd_small, NULL) != WELCH_SUCCESS) {
+                continue;   /* No full segment of each resolution yet */
+            }
+            printf("[main] Stream snapshot: %llu segments of %d\n", (unsigned long long)segments, NPERSEG_LARGE);
+            int result = signal_processor_process_welch(processor, f_large, psd_large, f_small, psd_small);
+            if (result != SP_SUCCESS) {
+                fprintf(stderr, "[main] ERROR: %s\n", get_signal_processor_error(result));
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        stopSampleStream();
+        set_sample_sink(NULL, NULL);
+        closeSamples();
+        welch_stream_destroy(large);
+        welch_stream_destroy(small);
+        free(f_large);
+        free(psd_large);
+        free(f_small);
+        free(psd_small);
+    } else if (SWEEP_MODE) {
+        /* Real-time mode, wideband: every buffer holds one complete sweep */
+        SweepConfig sweep_config = {
+            .lo_freq = LOWER_FREQ,
+            .hi_freq = UPPER_FREQ,
+            .sample_rate = SAMPLE_RATE,
+            .segment_lengths = { NPERSEG_LARGE, NPERSEG_SMALL },
+            .resolution_count = 2,
+            .usable_fraction = SWEEP_DEFAULT_USABLE_FRACTION,
+            .dc_exclusion_hz = SWEEP_DEFAULT_DC_EXCLUSION_HZ,
+            .samples_per_window = SWEEP_WINDOW_SAMPLES
+        };
+        SweepPipeline sp = {
+            .sweep = sweep_create(&sweep_config, welch_engine),
+            .processor = processor,
+            .window_bytes = 2 * (size_t)SWEEP_WINDOW_SAMPLES
+        };
+        if (sp.sweep == NULL) {
+            fprintf(stderr, "[main] Error initializing sweep\n");
+            exit(EXIT_FAILURE);
+        }
+        sp.f_large = (double*)malloc(sweep_bin_count(sp.sweep, 0) * sizeof(double));
+        sp.psd_large = (dsp_real_t*)malloc(sweep_bin_count(sp.sweep, 0) * sizeof(dsp_real_t));
+        sp.f_small = (double*)malloc(sweep_bin_count(sp.sweep, 1) * sizeof(double));
+        sp.psd_small = (dsp_real_t*)malloc(sweep_bin_count(sp.sweep, 1) * sizeof(dsp_real_t));
+
+        if (!sp.f_large || !sp.psd_large || !sp.f_small || !sp.psd_small) {
+            fprintf(stderr, "[main] Error allocating sweep buffers\n");
+            exit(EXIT_FAILURE);
+        }
+        size_t sweep_bytes = sweep_window_count(sp.sweep) * sp.window_bytes;
+
+        if (PIPELINE_BUFFERS >= 2) {
+            /* Acquire sweep N+1 while sweep N is analysed */
+            PipelineConfig pipeline_config = {
+                .num_buffers = PIPELINE_BUFFERS,
+                .buffer_bytes = sweep_bytes,
+                .backpressure = PIPELINE_BACKPRESSURE,
+                .acquire = acquire_sweep,
+                .process = process_sweep,
+                .user = &sp
+            };
+            Pipeline* pipeline = pipeline_create(&pipeline_config);
+            if (pipeline == NULL) {
+                fprintf(stderr, "[main] Error allocating sweep buffers\n");
+                exit(EXIT_FAILURE);
+            }
+
+            int result = pipeline_run(pipeline, &running);
+
+            PipelineStats stats;
+            pipeline_get_stats(pipeline, &stats);
+            printf("[main] Sweep pipeline: %llu acquired, %llu processed, %llu dropped\n",
+                   (unsigned long long)stats.acquired, (unsigned long long)stats.processed,
+                   (unsigned long long)stats.dropped);
+            pipeline_destroy(pipeline);
+
+            if (result != PIPELINE_SUCCESS) {
+                fprintf(stderr, "[main] ERROR: %s\n", pipeline_error_string(result));
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            /* Sequential: the same two stages back to back on a single buffer */
+            PipelineBuffer buffer = { .data = (int8_t*)malloc(sweep_bytes), .capacity = sweep_bytes };
+            if (buffer.data == NULL) {
+                fprintf(stderr, "[main] Error allocating sweep buffers\n");
+                exit(EXIT_FAILURE);
+            }
+            while (running) {
+                if (acquire_sweep(&buffer, &sp) != 0) {
+                    if (!running) break;
+                    fprintf(stderr, "[main] ERROR: sweep acquisition failed\n");
+                    exit(EXIT_FAILURE);
+                }
+                if (process_sweep(&buffer, &sp) != 0) {
+                    exit(EXIT_FAILURE);
+                }
+                buffer.sequence++;
+            }
+            free(buffer.data);
+        }
+        closeSamples();
+        sweep_destroy(sp.sweep);
+        free(sp.f_large);
+        free(sp.psd_large);
+        free(sp.f_small);
+        free(sp.psd_small);
+    } else if (ZERO_DISK && PIPELINE_BUFFERS >= 2) {
+        /* Real-time mode, overlapped: acquisition and analysis run concurrently */
+        PipelineConfig pipeline_config = {
+            .num_buffers = PIPELINE_BUFFERS,
+            .buffer_bytes = DEFAULT_SAMPLES_TO_XFER_MAX * 2ull,
+            .backpressure = PIPELINE_BACKPRESSURE,
+            .acquire = acquire_capture,
+            .process = process_capture,
+            .user = processor
+        };
+        Pipeline* pipeline = pipeline_create(&pipeline_config);
+        if (pipeline == NULL) {
+            fprintf(stderr, "[main] Error allocating capture buffers\n");
+            exit(EXIT_FAILURE);
+        }
+
+        int result = pipeline_run(pipeline, &running);
+
+        PipelineStats stats;
+        pipeline_get_stats(pipeline, &stats);
+        printf("[main] Pipeline: %llu acquired, %llu processed, %llu dropped\n",
+               (unsigned long long)stats.acquired, (unsigned long long)stats.processed,
+               (unsigned long long)stats.dropped);
+        pipeline_destroy(pipeline);
+        closeSamples();
+
+        if (result != PIPELINE_SUCCESS) {
+            fprintf(stderr, "[main] ERROR: %s\n", pipeline_error_string(result));
+            exit(EXIT_FAILURE);
+        }
     } else {
         /* Real-time mode: Process live HackRF samples */
         int CS8Samples;
         snprintf(input_file_path, sizeof(input_file_path), 
                 "%s%d", paths.core_samples_path, 0);
-        config.input_file_path = input_file_path;
+
+        if (ZERO_DISK && stream_init(STREAM_RING_SIZE) != 0) {
+            fprintf(stderr, "[main] Error allocating capture ring\n");
+            exit(EXIT_FAILURE);
+        }
+        uint32_t reported_drops = 0;
         
         while (running) {
             /* Acquire samples from HackRF */
             printf("[main] Getting CS8 samples...\n");
             CS8Samples = getSamples(LOWER_FREQ, UPPER_FREQ);
             printf("[main] errno: %d\n", CS8Samples);
+
+            /* Zero-disk: process the capture in place inside the ring */
+            size_t ring_bytes = 0;
+            const int8_t* capture = NULL;
+            if (ZERO_DISK) {
+                ring_bytes = stream_peek(&capture);
+
+                uint32_t drops = get_stream_drops();
+                if (drops != reported_drops) {
+                    fprintf(stderr, "[main] Ring overflow: %u transfers dropped\n", drops - reported_drops);
+                    reported_drops = drops;
+                }
+                printf("[main] Capture: %zu samples in memory\n", ring_bytes / 2);
+            } else {
+                printf("[main] File: %s\n", input_file_path);
+            }
             
             /* Process acquired samples */
-            printf("[main] File: %s\n", input_file_path);
-            int result = process_signal_spectrum(&config);
+            int result = ZERO_DISK ? signal_processor_process_cs8(processor, capture, ring_bytes / 2)
+                                   : signal_processor_process_file(processor, input_file_path);
+            if (ZERO_DISK) {
+                stream_consume(ring_bytes);
+            }
             
             if (result != SP_SUCCESS) {
                 fprintf(stderr, "[main] ERROR: %s\n", 
@@ -124,11 +644,18 @@ int main(void) {
                 exit(EXIT_FAILURE);
             }
             
-            printf("[main] SUCCESS: %s processed\n", input_file_path);
+            printf("[main] SUCCESS: %s processed\n", ZERO_DISK ? "capture" : input_file_path);
         }
+        closeSamples();
+        stream_free();
     }
 
     /* Cleanup and shutdown */
+    perf_stats_stop();
+    trace_stop();
+    signal_processor_destroy(processor);
+    welch_engine_destroy(welch_engine);
+
     printf("[main] Stopping web service...\n");
     if (stop_web() != 0) {
         fprintf(stderr, "[main] Failed to stop the web process.\n");
@@ -6,7 +6,7 @@ const path = require('path');
  * @param {string} dirPath
  *   Absolute path to the folder with JSON files named "0", "1", "2", …
  */
-module.exports = function createJSONReader(dirPath) {
+function createJSONReader(dirPath) {
   let currentIndex = 0;
 
   /**
@@ -44,4 +44,186 @@ module.exports = function createJSONReader(dirPath) {
     // after 10 tries, give up
     callback(lastError);
   };
-};
+}
+
+// Binary spectrum frame written by the core (backend/Core/Modules/spectrum_frame.h)
+const FRAME_MAGIC = 0x52465053; // "SPFR"
+const FRAME_VERSION = 1;
+const FRAME_HEADER_SIZE = 80;
+const FRAME_BYTES_PER_BIN = { 1: 4, 2: 2 }; // encoding -> bytes (float32, int16)
+
+/**
+ * Check that a buffer holds one complete frame of a known version.
+ * @param {Buffer} buffer
+ * @returns {string|null} Reason it is not a valid frame, or null
+ */
+function validateFrame(buffer) {
+  if (buffer.length < FRAME_HEADER_SIZE) return 'short header';
+  if (buffer.readUInt32LE(0) !== FRAME_MAGIC) return 'bad magic';
+  if (buffer.readUInt16LE(4) !== FRAME_VERSION) return `unsupported version ${buffer.readUInt16LE(4)}`;
+
+  const headerSize = buffer.readUInt16LE(6);
+  const bytesPerBin = FRAME_BYTES_PER_BIN[buffer.readUInt16LE(8)];
+  if (!bytesPerBin) return `unknown encoding ${buffer.readUInt16LE(8)}`;
+  const bins = buffer.readUInt32LE(12);
+  if (buffer.length !== headerSize + bins * bytesPerBin) return 'truncated payload';
+  return null;
+}
+
+/**
+ * @param {string} filePath
+ *   Absolute path to the frame file the core replaces every cycle.
+ */
+function createFrameReader(filePath) {
+  /**
+   * Same contract as readJSONWithRetries: up to 10 instantaneous attempts,
+   * then callback(error). On success callback(null, buffer) with the raw
+   * frame, ready to be emitted as a binary socket.io payload. Until the core
+   * writes its first frame the file does not exist: that is callback(null, null),
+   * nothing to emit yet, not an error.
+   */
+  return function readFrameWithRetries(callback) {
+    let lastError = null;
+
+    for (let attempt = 1; attempt <= 10; attempt++) {
+      try {
+        const buffer = fs.readFileSync(filePath);
+        const problem = validateFrame(buffer);
+        if (problem === null) {
+          return callback(null, buffer);
+        }
+        lastError = new Error(`${filePath}: ${problem}`);
+      } catch (err) {
+        if (err.code === 'ENOENT') {
+          return callback(null, null);
+        }
+        lastError = err;
+      }
+    }
+
+    callback(lastError);
+  };
+}
+
+// Shared-memory ring of frames written by the core (backend/Core/Modules/spectrum_ring.h).
+// Node cannot mmap, so slots are read with positioned reads on the same file; the
+// per-slot sequence check is what makes a copy valid, not how the bytes were fetched.
+const RING_MAGIC = 0x47525053; // "SPRG"
+const RING_VERSION = 1;
+const RING_HEADER_SIZE = 64;
+const RING_SLOT_HEADER = 16;
+
+/**
+ * Read `length` bytes at `position` of an open file.
+ * @returns {Buffer}
+ */
+function readAt(fd, length, position) {
+  const buffer = Buffer.alloc(length);
+  const bytesRead = fs.readSync(fd, buffer, 0, length, position);
+  if (bytesRead !== length) throw new Error('short read');
+  return buffer;
+}
+
+/**
+ * Parse and check the ring header.
+ * @returns {{headerSize: number, slotCount: number, slotSize: number, published: bigint}}
+ */
+function readRingHeader(fd) {
+  const header = readAt(fd, RING_HEADER_SIZE, 0);
+  if (header.readUInt32LE(0) !== RING_MAGIC) throw new Error('ring: bad magic');
+  if (header.readUInt16LE(4) !== RING_VERSION) throw new Error(`ring: unsupported version ${header.readUInt16LE(4)}`);
+  const slotCount = header.readUInt32LE(8);
+  if (slotCount < 2) throw new Error('ring: bad slot count');
+  return {
+    headerSize: header.readUInt16LE(6),
+    slotCount,
+    slotSize: header.readUInt32LE(12),
+    published: header.readBigUInt64LE(16)
+  };
+}
+
+/**
+ * Copy frame number `k` out of the ring with the seqlock check.
+ * @returns {Buffer|null} The frame, or null if it is not (or no longer) in the ring
+ *   or was rewritten during the copy
+ */
+function readRingSlot(fd, ring, k) {
+  const slot = ring.headerSize + Number(k % BigInt(ring.slotCount)) * ring.slotSize;
+  const expected = 2n * k + 2n;
+
+  const slotHeader = readAt(fd, RING_SLOT_HEADER, slot);
+  if (slotHeader.readBigUInt64LE(0) !== expected) return null;
+  const length = slotHeader.readUInt32LE(8);
+  if (length > ring.slotSize - RING_SLOT_HEADER) return null;
+
+  const frame = readAt(fd, length, slot + RING_SLOT_HEADER);
+  if (readAt(fd, 8, slot).readBigUInt64LE(0) !== expected) return null;
+  return validateFrame(frame) === null ? frame : null;
+}
+
+/**
+ * Read up to `count` of the most recent frames of the ring, oldest first.
+ * Frames overwritten while reading are left out.
+ *
+ * @param {string} ringPath
+ * @param {number} count
+ * @returns {{published: bigint, frames: Buffer[]}}
+ */
+function readRingFrames(ringPath, count) {
+  const fd = fs.openSync(ringPath, 'r');
+  try {
+    const ring = readRingHeader(fd);
+    const available = ring.published < BigInt(ring.slotCount) ? ring.published : BigInt(ring.slotCount);
+    const wanted = BigInt(Math.max(0, count)) < available ? BigInt(Math.max(0, count)) : available;
+
+    const frames = [];
+    for (let k = ring.published - wanted; k < ring.published; k++) {
+      const frame = readRingSlot(fd, ring, k);
+      if (frame !== null) frames.push(frame);
+    }
+    return { published: ring.published, frames };
+  } finally {
+    fs.closeSync(fd);
+  }
+}
+
+/**
+ * @param {string} ringPath
+ *   Absolute path to the ring file the core publishes into.
+ */
+function createRingReader(ringPath) {
+  /**
+   * Same contract as readFrameWithRetries, for the latest committed frame.
+   * The file is reopened on every call, so a ring the core recreated
+   * (larger frames) is picked up. A ring not created yet, or with no frame
+   * committed, is callback(null, null): nothing to emit yet.
+   */
+  return function readRingWithRetries(callback) {
+    let lastError = null;
+
+    for (let attempt = 1; attempt <= 10; attempt++) {
+      try {
+        const { published, frames } = readRingFrames(ringPath, 1);
+        if (frames.length === 1) {
+          return callback(null, frames[0]);
+        }
+        if (published === 0n) {
+          return callback(null, null);
+        }
+        lastError = new Error(`${ringPath}: latest frame being rewritten`);
+      } catch (err) {
+        if (err.code === 'ENOENT') {
+          return callback(null, null);
+        }
+        lastError = err;
+      }
+    }
+
+    callback(lastError);
+  };
+}
+
+module.exports = createJSONReader;
+module.exports.createFrameReader = createFrameReader;
+module.exports.createRingReader = createRingReader;
+module.exports.readRingFrames = readRingFrames;
@@ -15,9 +15,23 @@ if (!jsonDir) {
 }
 
 const createJSONReader = require('./handleJSON');
+const { createFrameReader, createRingReader } = require('./handleJSON');
+
+// json (default) or the binary frame encodings f32 / i16; the core also falls back to json
+const spectrumFormat = process.env.CORE_SPECTRUM_FORMAT || 'json';
+const useFrames = spectrumFormat === 'f32' || spectrumFormat === 'i16';
 const readJSON = createJSONReader(jsonDir);
+// With CORE_SPECTRUM_RING_SLOTS >= 2 the core publishes frames into a shared-memory ring,
+// at CORE_SPECTRUM_RING_PATH (same fallback as the core when it is not set)
+const ringSlots = parseInt(process.env.CORE_SPECTRUM_RING_SLOTS || '0', 10);
+const useRing = useFrames && ringSlots >= 2;
+const ringPath = process.env.CORE_SPECTRUM_RING_PATH || path.join(jsonDir, 'spectrum.ring');
+const readFrame = useRing
+  ? createRingReader(ringPath)
+  : createFrameReader(path.join(jsonDir, 'spectrum.bin'));
 
 console.log('Using JSON directory:', jsonDir);
+console.log('Spectrum format:', spectrumFormat, useRing ? `(ring of ${ringSlots} frames at ${ringPath})` : '');
 
 const app = express();
 const PORT = process.env.VITE_BUILD_PORT || 3001;
@@ -54,4 +68,16 @@ function emitJSONData() {
   });
 }
 
-setInterval(emitJSONData, 1000);
+// Frames are forwarded as they are: socket.io sends a Buffer as a binary attachment
+function emitSpectrumFrame() {
+  readFrame((err, frame) => {
+    if (err) {
+      console.error('[index] Frame read failed 10x, exiting:', err.message);
+      process.exit(1);
+    }
+    if (frame === null) return; // the core has not published a frame yet
+    io.emit('spectrumFrame', frame);
+  });
+}
+
+setInterval(useFrames ? emitSpectrumFrame : emitJSONData, 1000);
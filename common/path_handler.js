@@ -52,6 +52,39 @@ const CORE_SAMPLES_PATH = path.join(CORE_PATH, 'Samples') + path.sep;
 const CORE_JSON_PATH    = path.join(CORE_PATH, 'JSON');
 const CORE_BANDS_PATH   = path.join(CORE_PATH, 'bands'); 
 
+/**
+ * Reads a key from the .env file this script is about to regenerate.
+ * @param {string} key - Variable name.
+ * @returns {string|null} The current value, or null if the file or key does not exist.
+ */
+function readExistingEnvValue(key) {
+  try {
+    const content = fs.readFileSync(path.join(ROOT_PATH, '.env'), 'utf8');
+    const match = content.match(new RegExp(`^${key}=(.*)$`, 'm'));
+    return match ? match[1].trim() : null;
+  } catch (error) {
+    return null;
+  }
+}
+
+// Spectrum published by the core: json (default), f32 or i16 binary frames.
+// The environment wins over the current .env, so `CORE_SPECTRUM_FORMAT=i16 npm start`
+// switches it and a value edited in .env survives regeneration.
+const CORE_SPECTRUM_FORMAT =
+  process.env.CORE_SPECTRUM_FORMAT || readExistingEnvValue('CORE_SPECTRUM_FORMAT') || 'json';
+
+// Frames kept in the shared-memory ring (f32/i16 only); 0 publishes spectrum.bin instead
+const CORE_SPECTRUM_RING_SLOTS =
+  process.env.CORE_SPECTRUM_RING_SLOTS || readExistingEnvValue('CORE_SPECTRUM_RING_SLOTS') || '0';
+
+// Ring file shared by the core and the web server. It is rewritten several times a
+// second, so it defaults to tmpfs (/dev/shm) to keep dirty pages off the SD card;
+// without /dev/shm it falls back to the JSON directory.
+const CORE_SPECTRUM_RING_PATH =
+  process.env.CORE_SPECTRUM_RING_PATH || readExistingEnvValue('CORE_SPECTRUM_RING_PATH') ||
+  (fs.existsSync('/dev/shm') ? path.join('/dev/shm', 'bacn_spectrum.ring')
+                             : path.join(CORE_JSON_PATH, 'spectrum.ring'));
+
 // Get the local IP address
 const VITE_SERVER_IP = getLocalIpAddress();
 
@@ -70,6 +103,9 @@ const envContentLines = [
   `CORE_SAMPLES_PATH=${CORE_SAMPLES_PATH}`,
   `CORE_JSON_PATH=${CORE_JSON_PATH}`,
   `CORE_BANDS_PATH=${CORE_BANDS_PATH}`,
+  `CORE_SPECTRUM_FORMAT=${CORE_SPECTRUM_FORMAT}`,
+  `CORE_SPECTRUM_RING_SLOTS=${CORE_SPECTRUM_RING_SLOTS}`,
+  `CORE_SPECTRUM_RING_PATH=${CORE_SPECTRUM_RING_PATH}`,
   ``,
   `# Server Configuration`,
   `VITE_SERVER_IP=${VITE_SERVER_IP || '127.0.0.1'}`, // Fallback to localhost if IP not found
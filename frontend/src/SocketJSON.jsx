@@ -1,6 +1,7 @@
 // SocketJSON.jsx
 import { useEffect } from 'react';
 import { useSocket } from './SocketContext';
+import { decodeSpectrumFrame } from './spectrumFrame';
 
 /**
  * 
@@ -10,6 +11,8 @@ import { useSocket } from './SocketContext';
  * provided by SocketContext. When JSON data arrives via the "jsonData"
  * event, it parses and destructures the payload, applies default values,
  * and forwards a well-structured object to the parent via the onSocketData callback.
+ * Binary frames ("spectrumFrame" event, CORE_SPECTRUM_FORMAT f32/i16) are
+ * decoded to the same object, with Pxx and f as typed arrays.
  *
  * @param {{ onSocketData: (data: {
  *   band: string | number,
@@ -17,8 +20,8 @@ import { useSocket } from './SocketContext';
  *   fmax: string | number,
  *   units: string,
  *   measure: string,
- *   Pxx: number[],
- *   f: number[]
+ *   Pxx: number[] | Float32Array,
+ *   f: number[] | Float64Array
  * }) => void }} props - Component props
  * @returns {null} Does not render any DOM elements
  */
@@ -73,12 +76,33 @@ const SocketJSON = ({ onSocketData }) => {
       }
     };
 
-    // Listen for the custom "jsonData" event on the socket
+    /**
+     * Handles a binary spectrum frame from the socket event
+     * @param {ArrayBuffer} payload
+     */
+    const handleSpectrumFrame = (payload) => {
+      let frame;
+      try {
+        frame = decodeSpectrumFrame(payload);
+      } catch (err) {
+        console.error('[Web] Invalid spectrum frame:', err.message);
+        return;
+      }
+
+      const { band, fmin, fmax, units, measure, Pxx, f } = frame;
+      if (typeof onSocketData === 'function') {
+        onSocketData({ band, fmin, fmax, units, measure, Pxx, f });
+      }
+    };
+
+    // Listen for the custom "jsonData" and "spectrumFrame" events on the socket
     socket.on('jsonData', handleJsonData);
+    socket.on('spectrumFrame', handleSpectrumFrame);
 
-    // Cleanup listener when component unmounts or dependencies change
+    // Cleanup listeners when component unmounts or dependencies change
     return () => {
       socket.off('jsonData', handleJsonData);
+      socket.off('spectrumFrame', handleSpectrumFrame);
     };
   }, [socket, onSocketData]);
 
@@ -0,0 +1,109 @@
+// spectrumFrame.js
+
+/**
+ * Decoder for the binary spectrum frame published by the core
+ * (layout in backend/Core/Modules/spectrum_frame.h). All fields are little-endian.
+ */
+
+const FRAME_MAGIC = 0x52465053; // "SPFR"
+const FRAME_VERSION = 1;
+const ENCODING_F32 = 1;
+const ENCODING_I16 = 2;
+const I16_MISSING = -32768;
+
+/**
+ * Reads a NUL-padded 8-byte label from the header.
+ * @param {DataView} view
+ * @param {number} offset
+ * @returns {string}
+ */
+const readLabel = (view, offset) => {
+  let text = '';
+  for (let i = 0; i < 8; i++) {
+    const code = view.getUint8(offset + i);
+    if (code === 0) break;
+    text += String.fromCharCode(code);
+  }
+  return text;
+};
+
+/**
+ * Normalizes a socket.io binary payload (ArrayBuffer, typed array or Buffer) to a DataView.
+ * @param {ArrayBuffer|ArrayBufferView} payload
+ * @returns {DataView}
+ */
+const toDataView = (payload) => {
+  if (payload instanceof ArrayBuffer) return new DataView(payload);
+  if (ArrayBuffer.isView(payload)) {
+    return new DataView(payload.buffer, payload.byteOffset, payload.byteLength);
+  }
+  throw new Error('spectrum frame: unsupported payload type');
+};
+
+/**
+ * Decodes one frame into the same shape SocketJSON builds from the JSON document,
+ * with typed arrays for the vectors.
+ *
+ * @param {ArrayBuffer|ArrayBufferView} payload - Frame as received from the socket
+ * @returns {{
+ *   band: string, fmin: number, fmax: number, units: string, measure: string,
+ *   Pxx: Float32Array, f: Float64Array, sequence: number, timestamp: number
+ * }} Decoded spectrum; timestamp in ms since the Unix epoch
+ * @throws {Error} If the payload is not a complete frame of a supported version
+ */
+export const decodeSpectrumFrame = (payload) => {
+  const view = toDataView(payload);
+  if (view.byteLength < 80 || view.getUint32(0, true) !== FRAME_MAGIC) {
+    throw new Error('spectrum frame: bad magic');
+  }
+  const version = view.getUint16(4, true);
+  if (version !== FRAME_VERSION) {
+    throw new Error(`spectrum frame: unsupported version ${version}`);
+  }
+
+  const headerSize = view.getUint16(6, true);
+  const encoding = view.getUint16(8, true);
+  const bins = view.getUint32(12, true);
+  const bytesPerBin = encoding === ENCODING_F32 ? 4 : encoding === ENCODING_I16 ? 2 : 0;
+  if (bytesPerBin === 0) {
+    throw new Error(`spectrum frame: unknown encoding ${encoding}`);
+  }
+  if (view.byteLength < headerSize + bins * bytesPerBin) {
+    throw new Error('spectrum frame: truncated payload');
+  }
+
+  const fmin = view.getFloat64(32, true);
+  const fmax = view.getFloat64(40, true);
+  const df = view.getFloat64(48, true);
+
+  // Uniform axis: rebuilt from fmin/df, rounded to kHz as in the JSON document
+  const f = new Float64Array(bins);
+  for (let i = 0; i < bins; i++) {
+    f[i] = Math.round((fmin + i * df) * 1000) / 1000;
+  }
+
+  const Pxx = new Float32Array(bins);
+  if (encoding === ENCODING_F32) {
+    for (let i = 0; i < bins; i++) {
+      Pxx[i] = view.getFloat32(headerSize + 4 * i, true);
+    }
+  } else {
+    for (let i = 0; i < bins; i++) {
+      const centi = view.getInt16(headerSize + 2 * i, true);
+      Pxx[i] = centi === I16_MISSING ? NaN : centi / 100;
+    }
+  }
+
+  return {
+    band: readLabel(view, 64),
+    fmin: Math.round(fmin * 1000) / 1000,
+    fmax: Math.round(fmax * 1000) / 1000,
+    units: readLabel(view, 56),
+    measure: readLabel(view, 72),
+    Pxx,
+    f,
+    // u64 fields: exact below 2^53, far beyond any sequence number or date
+    sequence: Number(view.getBigUint64(16, true)),
+    timestamp: Number(view.getBigUint64(24, true)) / 1000
+  };
+};